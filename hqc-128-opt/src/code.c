@@ -48,28 +48,67 @@ void code_encode(uint64_t *em, const uint64_t *m, struct Trace_time* trace_time)
 
 
 
+/**
+ *
+ * @brief Adding the encoding of the message m to the vector v using the concatenated code
+ *
+ * The Reed-Muller code words are XORed into v block by block as they are produced,
+ * so that no intermediate concatenated code word is needed.
+ *
+ * @param[in,out] v Pointer to an array of VEC_N1N2_SIZE_64 words to which the tensor code word is added
+ * @param[in] m Pointer to an array that is the message
+ */
+void code_encode_xor(uint64_t *v, const uint64_t *m, struct Trace_time* trace_time) {
+    uint64_t tmp[VEC_N1_SIZE_64] = {0};
+    clock_t start, end;
+
+    start = clock();
+    reed_solomon_encode(tmp, m);
+    end = clock();
+    trace_time->rs_encode_time += ((uint32_t)(end - start));
+
+    start = clock();
+    reed_muller_encode_xor(v, tmp);
+    end = clock();
+    trace_time->rm_encode_time += ((uint32_t)(end - start));
+
+    #ifdef VERBOSE
+        printf("\n\nReed-Solomon code word: "); vect_print(tmp, VEC_N1_SIZE_BYTES);
+    #endif
+}
+
+
+
 /**
  * @brief Decoding the code word em to a message m using the concatenated code
  *
+ * The Reed-Muller and Reed-Solomon decoders are fused: each group of RM_DECODE_BLOCKS decoded bytes
+ * is added to the Reed-Solomon syndromes while it is still in registers, so that the syndromes
+ * are ready when the last Reed-Muller block is decoded. The syndrome computation is thus
+ * accounted in rm_decode_time.
+ *
  * @param[out] m Pointer to an array that is the message
  * @param[in] em Pointer to an array that is the code word
  */
 void code_decode(uint64_t *m, const uint64_t *em, struct Trace_time* trace_time) {
-    uint64_t tmp[VEC_N1_SIZE_64] = {0};
+    uint8_t tmp[VEC_N1_SIZE_BYTES] = {0};
+    __m256i syndromes8 = _mm256_setzero_si256();
     clock_t start, end;
 
     start = clock();
-    reed_muller_decode(tmp, em);
+    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i += RM_DECODE_BLOCKS) {
+        reed_muller_decode_blocks(tmp, em, i);
+        reed_solomon_syndromes_update(&syndromes8, tmp, i, RM_DECODE_BLOCKS);
+    }
     end = clock();
     trace_time->rm_decode_time += ((uint32_t)(end - start));
 
+    #ifdef VERBOSE
+        printf("\n\nReed-Muller decoding result (the input for the Reed-Solomon decoding algorithm): "); vect_print((uint64_t *) tmp, VEC_N1_SIZE_BYTES);
+    #endif
+
     start = clock();
-    reed_solomon_decode(m, tmp, trace_time);
+    reed_solomon_decode_syndromes(m, tmp, syndromes8, trace_time);
     end = clock();
     trace_time->rs_decode_time += ((uint32_t)(end - start));
-
-
-    #ifdef VERBOSE
-        printf("\n\nReed-Muller decoding result (the input for the Reed-Solomon decoding algorithm): "); vect_print(tmp, VEC_N1_SIZE_BYTES);
-    #endif
 }
@@ -12,6 +12,7 @@
 #include <stdint.h>
 
 void code_encode(uint64_t *codeword, const uint64_t *message, struct Trace_time* trace_time);
+void code_encode_xor(uint64_t *vector, const uint64_t *message, struct Trace_time* trace_time);
 void code_decode(uint64_t *message, const uint64_t *vector, struct Trace_time* trace_time);
 
 #endif
@@ -190,6 +190,44 @@ uint16_t gf_inverse(uint16_t a) {
 
 
 
+/**
+ * Computes the inverses of k elements of GF(2^GF_M) at once.
+ *
+ * Uses simultaneous (Montgomery) inversion: the prefix products of the elements
+ * are inverted with a single call to gf_inverse, then unwound,
+ * for a total of one inversion and 3(k-1) multiplications. <br>
+ * Zero elements are replaced by 1 in the products and their inverse is set to 0,
+ * matching gf_inverse(0) = 0, without branching on the values.
+ *
+ * @param[out] inv Array of k elements receiving the inverses, must not overlap a
+ * @param[in] a Array of k elements of GF(2^GF_M)
+ * @param[in] k Number of elements, at least 1
+ */
+void gf_batch_inverse(uint16_t *inv, const uint16_t *a, size_t k) {
+    uint16_t mask, t;
+
+    // inv[i] = a[0] * ... * a[i], with zeros replaced by 1
+    mask = (uint16_t) (-((int32_t) a[0]) >> 31); // a[0] != 0
+    inv[0] = (mask & a[0]) ^ (~mask & 1);
+    for (size_t i = 1; i < k; ++i) {
+        mask = (uint16_t) (-((int32_t) a[i]) >> 31); // a[i] != 0
+        inv[i] = gf_mul(inv[i - 1], (mask & a[i]) ^ (~mask & 1));
+    }
+
+    // t = (a[0] * ... * a[i])^-1 when processing i
+    t = gf_inverse(inv[k - 1]);
+    for (size_t i = k - 1; i; --i) {
+        mask = (uint16_t) (-((int32_t) a[i]) >> 31); // a[i] != 0
+        inv[i] = mask & gf_mul(t, inv[i - 1]);
+        t = gf_mul(t, (mask & a[i]) ^ (~mask & 1));
+    }
+
+    mask = (uint16_t) (-((int32_t) a[0]) >> 31); // a[0] != 0
+    inv[0] = mask & t;
+}
+
+
+
 /**
  * Returns i modulo 2^GF_M-1.
  * i must be less than 2*(2^GF_M-1).
@@ -60,6 +60,7 @@ uint16_t gf_mul(uint16_t a, uint16_t b);
 __m256i gf_mul_vect(__m256i a, __m256i b);
 uint16_t gf_square(uint16_t a);
 uint16_t gf_inverse(uint16_t a);
+void gf_batch_inverse(uint16_t *inv, const uint16_t *a, size_t k);
 uint16_t gf_mod(uint16_t i);
 
 #endif
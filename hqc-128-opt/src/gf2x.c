@@ -338,10 +338,10 @@ static inline void divide_by_x_plus_one_256(__m256i *out, __m256i *in, int32_t s
  * @param[in] B Pointer to the polynomial B(x)
  */
 void toom_3_mult(__m256i *Out, const __m256i *A256, const __m256i *B256) {
-	static __m256i U0[T_TM3R_3W_256], V0[T_TM3R_3W_256], U1[T_TM3R_3W_256], V1[T_TM3R_3W_256], U2[T_TM3R_3W_256], V2[T_TM3R_3W_256];
-	static __m256i W0[2 * (T_TM3R_3W_256)], W1[2 * (T_TM3R_3W_256)], W2[2 * (T_TM3R_3W_256)], W3[2 * (T_TM3R_3W_256)], W4[2 * (T_TM3R_3W_256)];
-	static __m256i tmp[4 * (T_TM3R_3W_256)];
-	static __m256i ro256[6 * (T_TM3R_3W_256)];
+	static __thread __m256i U0[T_TM3R_3W_256], V0[T_TM3R_3W_256], U1[T_TM3R_3W_256], V1[T_TM3R_3W_256], U2[T_TM3R_3W_256], V2[T_TM3R_3W_256];
+	static __thread __m256i W0[2 * (T_TM3R_3W_256)], W1[2 * (T_TM3R_3W_256)], W2[2 * (T_TM3R_3W_256)], W3[2 * (T_TM3R_3W_256)], W4[2 * (T_TM3R_3W_256)];
+	static __thread __m256i tmp[4 * (T_TM3R_3W_256)];
+	static __thread __m256i ro256[6 * (T_TM3R_3W_256)];
 	const __m256i zero = (__m256i){0ul, 0ul, 0ul, 0ul};
 	
 	uint64_t *A = (uint64_t *) A256;
@@ -36,11 +36,11 @@ void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, struct Trace_time *key
     uint8_t sk_seed[SEED_BYTES] = {0};
     uint8_t sigma[VEC_K_SIZE_BYTES] = {0};
     uint8_t pk_seed[SEED_BYTES] = {0};
-    static __m256i h_256[VEC_N_256_SIZE_64 >> 2];
-    static __m256i y_256[VEC_N_256_SIZE_64 >> 2];   
-    static __m256i x_256[VEC_N_256_SIZE_64 >> 2];
-    static uint64_t s[VEC_N_256_SIZE_64];
-    static __m256i tmp_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i h_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i y_256[VEC_N_256_SIZE_64 >> 2];   
+    static __thread __m256i x_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread uint64_t s[VEC_N_256_SIZE_64];
+    static __thread __m256i tmp_256[VEC_N_256_SIZE_64 >> 2];
     clock_t start, end;
 
     keygen_time->stack += 1;
@@ -126,17 +126,15 @@ void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, struct Trace_time *key
  */
 void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, struct Trace_time* trace_time) {
     seedexpander_state seedexpander;
-    static __m256i h_256[VEC_N_256_SIZE_64 >> 2];
-    static __m256i s_256[VEC_N_256_SIZE_64 >> 2];
-    static __m256i r2_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i h_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i s_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i r2_256[VEC_N_256_SIZE_64 >> 2];
 
-    static __m256i r1_256[VEC_N_256_SIZE_64 >> 2];
-    static __m256i e_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i r1_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i e_256[VEC_N_256_SIZE_64 >> 2];
 
-    static __m256i tmp1_256[VEC_N_256_SIZE_64 >> 2];
-    static __m256i tmp2_256[VEC_N_256_SIZE_64 >> 2];
-    static __m256i tmp3_256[VEC_N_256_SIZE_64 >> 2];
-    static uint64_t tmp4[VEC_N_256_SIZE_64];
+    static __thread __m256i tmp1_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread __m256i tmp3_256[VEC_N_256_SIZE_64 >> 2];
     clock_t start, end;
 
     #ifdef __STDC_LIB_EXT1__
@@ -177,20 +175,17 @@ void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta
     end = clock();
     trace_time->vect_operation_time += ((uint32_t)(end - start));
 
-    // Compute v = m.G by encoding the message
-    code_encode(v, m, trace_time);
-
+    // Compute v = s.r2 + e truncated to PARAM_N1N2 bits
     start = clock();
-    vect_resize((uint64_t *) tmp2_256, PARAM_N, v, PARAM_N1N2);
-
-    // Compute v = m.G + s.r2 + e
     vect_mul(tmp3_256, r2_256, s_256);
-    vect_add(tmp4, (uint64_t *) e_256, (uint64_t *) tmp3_256, VEC_N_256_SIZE_64);
-    vect_add((uint64_t *) tmp3_256, (uint64_t *) tmp2_256, tmp4, VEC_N_256_SIZE_64);
+    vect_add((uint64_t *) tmp3_256, (uint64_t *) e_256, (uint64_t *) tmp3_256, VEC_N_256_SIZE_64);
     vect_resize(v, PARAM_N1N2, (uint64_t *) tmp3_256, PARAM_N);
     end = clock();
     trace_time->vect_operation_time += ((uint32_t)(end - start));
 
+    // Compute v = m.G + s.r2 + e by adding the encoded message to v
+    code_encode_xor(v, m, trace_time);
+
     #ifdef VERBOSE
         printf("\n\nh: "); vect_print((uint64_t *) h_256, VEC_N_SIZE_BYTES);
         printf("\n\ns: "); vect_print((uint64_t *) s_256, VEC_N_SIZE_BYTES);
@@ -216,12 +211,12 @@ void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta
  * @returns 0 
  */
 uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const __m256i *u_256, const uint64_t *v, const uint8_t *sk, struct Trace_time *trace_time) {
-    static __m256i x_256[VEC_N_256_SIZE_64 >> 2] = {0};
-    static __m256i y_256[VEC_N_256_SIZE_64 >> 2] = {0};
+    static __thread __m256i x_256[VEC_N_256_SIZE_64 >> 2] = {0};
+    static __thread __m256i y_256[VEC_N_256_SIZE_64 >> 2] = {0};
     uint8_t pk[PUBLIC_KEY_BYTES] = {0};
-    static uint64_t tmp1[VEC_N_256_SIZE_64] = {0};
-    static uint64_t tmp2[VEC_N_256_SIZE_64] = {0};
-    static __m256i tmp3_256[VEC_N_256_SIZE_64 >> 2];
+    static __thread uint64_t tmp1[VEC_N_256_SIZE_64] = {0};
+    static __thread uint64_t tmp2[VEC_N_256_SIZE_64] = {0};
+    static __thread __m256i tmp3_256[VEC_N_256_SIZE_64 >> 2];
     clock_t start, end;
 
     #ifdef __STDC_LIB_EXT1__
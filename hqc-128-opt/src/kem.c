@@ -58,7 +58,7 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
 
     uint8_t theta[SHAKE256_512_BYTES] = {0};
     uint8_t m[VEC_K_SIZE_BYTES] = {0};
-    static uint64_t u[VEC_N_256_SIZE_64] = {0};
+    static __thread uint64_t u[VEC_N_256_SIZE_64] = {0};
     uint64_t v[VEC_N1N2_256_SIZE_64] = {0};
     uint8_t mc[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES] = {0};
     uint64_t salt[SALT_SIZE_64] = {0};
@@ -158,7 +158,7 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
     hqc_ciphertext_from_string((uint64_t *) u_256, v, salt, ct);
 
     // Retrieving pk from sk
-    memcpy(pk, sk + SEED_BYTES, PUBLIC_KEY_BYTES);
+    memcpy(pk, sk + SEED_BYTES + VEC_K_SIZE_BYTES, PUBLIC_KEY_BYTES);
     end = clock();
     trace_time->parsing_time += ((uint32_t)(end - start));
 
@@ -186,7 +186,7 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
     result |= vect_compare((uint8_t *) u_256, (uint8_t *) u2, VEC_N_SIZE_BYTES);
     result |= vect_compare((uint8_t *) v, (uint8_t *) v2, VEC_N1N2_SIZE_BYTES);
 
-    result = (uint8_t) (-((int16_t) result) >> 15);
+    result -= 1;
     
     for (size_t i = 0; i < VEC_K_SIZE_BYTES; ++i) {
         mc[i] = (m[i] & result) ^ (sigma[i] & ~result);
@@ -218,5 +218,5 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
         printf("\n\n# Checking Ciphertext - End #\n");
     #endif
 
-    return -(~result & 1);
+    return (result & 1) - 1;
 }
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <string.h>
+
+// The check compares the internal kernels of reed_muller.c, so it is built in the same translation unit
+#include "reed_muller.c"
+
+static uint64_t xorshift64(uint64_t *state);
+static void set_count(codeword src[], size_t block, size_t entry, size_t count);
+static int check(codeword src[]);
+
+
+/**
+ * @brief Next output of a xorshift64 generator, enough to spread the error bits
+ */
+static uint64_t xorshift64(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+
+
+/**
+ * @brief Sets entry of block to count by setting its bit in the first count copies and clearing it in the others
+ */
+static void set_count(codeword src[], size_t block, size_t entry, size_t count) {
+	for (size_t copy = 0; copy < MULTIPLICITY; copy++) {
+		uint64_t bit = 1ULL << (entry % 64);
+		codeword *word = &src[block * MULTIPLICITY + copy];
+		word->u64[entry / 64] = (copy < count) ? (word->u64[entry / 64] | bit) : (word->u64[entry / 64] & ~bit);
+	}
+}
+
+
+
+/**
+ * @brief Runs the int16 and the int8 transforms on the same codewords
+ *
+ * @param[in] src Array of BLOCKS * MULTIPLICITY codewords
+ * @returns 0 if both transforms are equal, -1 otherwise
+ */
+static int check(codeword src[]) {
+	expandedCodewords expanded, transform, transform8;
+	expandedCodewords8 expanded8;
+
+	expand_and_sum(&expanded, src);
+	hadamard(&expanded, &transform);
+	expand_and_sum8(&expanded8, src);
+	hadamard8(&expanded8, &transform8);
+
+	return memcmp(&transform, &transform8, sizeof(expandedCodewords)) ? -1 : 0;
+}
+
+
+
+/**
+ * Validation of the int8 Hadamard transform of reed_muller.c against the int16 one.
+ *
+ * Both paths, from the copies to the transform, are run on:
+ * - every constant input, each entry of every block equal to 0 to MULTIPLICITY,
+ * - every impulse, a single entry of a block equal to 1 to MULTIPLICITY,
+ * - every Walsh pattern and its complement, MULTIPLICITY on the entries where the pattern is +1 (resp. -1),
+ *   which reach the largest intermediate value of every output,
+ * - the codewords of every pair of messages of the BLOCKS blocks, with 0 to MULTIPLICITY * 128 error bits per block.
+ * Without saturation both transforms are the same linear map, and the bound of HADAMARD_INT8 rules saturation out.
+ */
+int main() {
+
+	printf("\n");
+	printf("*********************\n");
+	printf("**** HQC-%d-%d ****\n", PARAM_SECURITY, PARAM_DFR_EXP);
+	printf("*********************\n");
+	printf("\n");
+
+#ifndef HADAMARD_INT8
+	printf("HADAMARD_INT8 is not defined for MULTIPLICITY %d, the int16 transform is used and there is nothing to check\n", MULTIPLICITY);
+	return 0;
+#else
+	codeword src[BLOCKS * MULTIPLICITY];
+	uint64_t state = 0x9e3779b97f4a7c15ULL;
+	size_t cases = 0;
+	size_t failures = 0;
+
+	// Constant inputs
+	for (size_t count = 0; count <= MULTIPLICITY; count++) {
+		for (size_t block = 0; block < BLOCKS; block++) {
+			for (size_t entry = 0; entry < 128; entry++) {
+				set_count(src, block, entry, count);
+			}
+		}
+		failures += (check(src) != 0);
+		cases++;
+	}
+
+	// Impulses, at mirrored entries in the odd blocks
+	for (size_t count = 1; count <= MULTIPLICITY; count++) {
+		for (size_t entry = 0; entry < 128; entry++) {
+			memset(src, 0, sizeof(src));
+			for (size_t block = 0; block < BLOCKS; block++) {
+				set_count(src, block, (block & 1) ? 127 - entry : entry, count);
+			}
+			failures += (check(src) != 0);
+			cases++;
+		}
+	}
+
+	// Walsh patterns and their complements
+	for (size_t row = 0; row < 128; row++) {
+		for (size_t complement = 0; complement < 2; complement++) {
+			for (size_t block = 0; block < BLOCKS; block++) {
+				for (size_t entry = 0; entry < 128; entry++) {
+					size_t parity = __builtin_parity((unsigned int) (row & entry));
+					set_count(src, block, entry, (parity == complement) ? MULTIPLICITY : 0);
+				}
+			}
+			failures += (check(src) != 0);
+			cases++;
+		}
+	}
+
+	// Every pair of messages, the error weight going through 0 to MULTIPLICITY * 128 bits per block
+	for (size_t pair = 0; pair < 65536; pair++) {
+		__m256i word = encode((uint8_t) pair, (uint8_t) (pair >> 8));
+		size_t weight = pair % (MULTIPLICITY * 128 + 1);
+
+		for (size_t block = 0; block < BLOCKS; block++) {
+			for (size_t copy = 0; copy < MULTIPLICITY; copy++) {
+				memcpy(&src[block * MULTIPLICITY + copy], (uint8_t *) &word + 16 * (block & 1), sizeof(codeword));
+			}
+			// weight distinct error positions among the MULTIPLICITY * 128 bits of the block
+			uint8_t flipped[MULTIPLICITY * 128] = {0};
+			for (size_t error = 0; error < weight;) {
+				size_t position = xorshift64(&state) % (MULTIPLICITY * 128);
+				if (!flipped[position]) {
+					flipped[position] = 1;
+					src[block * MULTIPLICITY + position / 128].u64[(position % 128) / 64] ^= 1ULL << (position % 64);
+					error++;
+				}
+			}
+		}
+		failures += (check(src) != 0);
+		cases++;
+	}
+
+	printf("hadamard8 against hadamard on %zu inputs of %d blocks: %s\n", cases, BLOCKS, failures ? "FAIL" : "OK");
+	if (failures) {
+		printf("%zu inputs differ\n", failures);
+		return 1;
+	}
+	return 0;
+#endif
+}
@@ -12,36 +12,56 @@
 // number of repeated code words
 #define MULTIPLICITY                   CEIL_DIVIDE(PARAM_N2, 128)
 
+// number of bits of the vertical counters summing the MULTIPLICITY copies
+#define COUNTER_BITS                   ((MULTIPLICITY) < 2 ? 1 : (MULTIPLICITY) < 4 ? 2 : (MULTIPLICITY) < 8 ? 3 : 4)
+
+// number of RM(1,7) blocks decoded together
+#define BLOCKS                         RM_DECODE_BLOCKS
+
+#if VEC_N1_SIZE_BYTES % BLOCKS != 0
+#error "VEC_N1_SIZE_BYTES must be a multiple of BLOCKS"
+#endif
+
+// the first 5 passes of the Hadamard transform fit in int8 lanes
+// when the entries, at most MULTIPLICITY << 5 in absolute value, do
+#if (MULTIPLICITY << 5) <= 127
+#define HADAMARD_INT8
+#endif
+
 // codeword is 128 bits, seen multiple ways
 typedef union {
     __mmask16 mask[8];
     uint16_t u16[8];
     uint32_t u32[4];
+    uint64_t u64[2];
 } codeword;
 
+// BLOCKS expanded codewords of 16*128 bits, interleaved by 256-bit rows:
+// entry 16 * row + i of block b is mm[row][b] lane i
 typedef union {
-    __m256i mm;
-    uint16_t u16[16];
-} vector;
+    __m256i mm[8][BLOCKS];
+    int16_t i16[8][BLOCKS][16];
+} expandedCodewords;
 
-// Expanded codeword is 16*128 bits, seen multiple ways
+// Same with 8-bit entries: entry 32 * row + i of block b is mm[row][b] lane i
 typedef union {
-    __m256i mm[8];
-    int16_t i16[128];
-} expandedCodeword;
+    __m256i mm[4][BLOCKS];
+    int8_t i8[4][BLOCKS][32];
+} expandedCodewords8;
 
-// copy bit 0 into all bits of a 64 bit value
-#define BIT0MASK(x) (int64_t)(-((x) & 1))
-
-void encode(codeword *word, int32_t message);
-void expand_and_sum(expandedCodeword *dst, codeword src[]);
-void hadamard(expandedCodeword *src, expandedCodeword *dst);
-int32_t find_peaks(expandedCodeword *transform);
+static inline __m256i encode(uint8_t message0, uint8_t message1);
+static inline void count_copies(codeword counters[BLOCKS][COUNTER_BITS], codeword src[]);
+void expand_and_sum(expandedCodewords *dst, codeword src[]);
+void expand_and_sum8(expandedCodewords8 *dst, codeword src[]);
+void hadamard(expandedCodewords *src, expandedCodewords *dst);
+void hadamard8(expandedCodewords8 *src, expandedCodewords *dst);
+void find_peaks(uint8_t *message, expandedCodewords *transform);
+static inline void bitmap128(uint64_t *bitmap, const __m256i *masks);
 
 
 
 /**
- * @brief Encode a single byte into a single codeword using RM(1,7)
+ * @brief Encode two bytes into two codewords using RM(1,7)
  *
  * Encoding matrix of this code:
  * bit pattern (note that bits are numbered big endian)
@@ -54,54 +74,131 @@ int32_t find_peaks(expandedCodeword *transform);
  * 6   00000000 00000000 ffffffff ffffffff
  * 7   ffffffff ffffffff ffffffff ffffffff
  *
- * @param[out] word An RM(1,7) codeword
- * @param[in] message A message to encode
+ * Each 128-bit lane of the result is the XOR of the rows selected by the bits of its byte,
+ * computed for both lanes at once with byte masks.
+ *
+ * @returns the codeword of message0 in the low 128-bit lane and the codeword of message1 in the high one
+ * @param[in] message0 A message to encode
+ * @param[in] message1 A message to encode
  */
-inline void encode(codeword *word, int32_t message) {
-    int32_t first_word;
-    first_word = BIT0MASK(message >> 7);
-    first_word ^= BIT0MASK(message >> 0) & 0xaaaaaaaa;
-    first_word ^= BIT0MASK(message >> 1) & 0xcccccccc;
-    first_word ^= BIT0MASK(message >> 2) & 0xf0f0f0f0;
-    first_word ^= BIT0MASK(message >> 3) & 0xff00ff00;
-    first_word ^= BIT0MASK(message >> 4) & 0xffff0000;
-    word->u32[0] = first_word;
-    first_word ^= BIT0MASK(message >> 5);
-    word->u32[1] = first_word;
-    first_word ^= BIT0MASK(message >> 6);
-    word->u32[3] = first_word;
-    first_word ^= BIT0MASK(message >> 5);
-    word->u32[2] = first_word;
-    return;
+static inline __m256i encode(uint8_t message0, uint8_t message1) {
+    // the rows of the encoding matrix, in both 128-bit lanes
+    const __m256i rows[8] = {
+        (__m256i) {0xaaaaaaaaaaaaaaaaULL, 0xaaaaaaaaaaaaaaaaULL, 0xaaaaaaaaaaaaaaaaULL, 0xaaaaaaaaaaaaaaaaULL},
+        (__m256i) {0xccccccccccccccccULL, 0xccccccccccccccccULL, 0xccccccccccccccccULL, 0xccccccccccccccccULL},
+        (__m256i) {0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL},
+        (__m256i) {0xff00ff00ff00ff00ULL, 0xff00ff00ff00ff00ULL, 0xff00ff00ff00ff00ULL, 0xff00ff00ff00ff00ULL},
+        (__m256i) {0xffff0000ffff0000ULL, 0xffff0000ffff0000ULL, 0xffff0000ffff0000ULL, 0xffff0000ffff0000ULL},
+        (__m256i) {0xffffffff00000000ULL, 0xffffffff00000000ULL, 0xffffffff00000000ULL, 0xffffffff00000000ULL},
+        (__m256i) {0x0000000000000000ULL, 0xffffffffffffffffULL, 0x0000000000000000ULL, 0xffffffffffffffffULL},
+        (__m256i) {0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL}
+    };
+    // message0 in every byte of the low lane, message1 in every byte of the high lane
+    __m256i message = _mm256_setr_epi64x(0x0101010101010101ULL * message0, 0x0101010101010101ULL * message0,
+                                         0x0101010101010101ULL * message1, 0x0101010101010101ULL * message1);
+    __m256i word = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < 8; i++) {
+        __m256i bit = _mm256_set1_epi8(1 << i);
+        word ^= _mm256_cmpeq_epi8(message & bit, bit) & rows[i];
+    }
+    return word;
 }
 
 
 
 /**
- * @brief Add multiple codewords into expanded codeword
+ * @brief Bitsliced sum of the MULTIPLICITY copies of BLOCKS codewords
  *
+ * Bit k of the number of copies having a given bit set is stored at the same position in counters[block][k].
+ * Each copy goes through a ripple-carry adder on 64-bit words.
+ *
+ * @param[out] counters Array receiving the vertical counters of each block
+ * @param[in] src Array of BLOCKS * MULTIPLICITY codewords
+ */
+static inline void count_copies(codeword counters[BLOCKS][COUNTER_BITS], codeword src[]) {
+    for (size_t block = 0; block < BLOCKS; block++) {
+        codeword *copies = &src[block * MULTIPLICITY];
+        memset(counters[block], 0, COUNTER_BITS * sizeof(codeword));
+        for (size_t copy = 0; copy < MULTIPLICITY; copy++) {
+            for (size_t word = 0; word < 2; word++) {
+                uint64_t carry = copies[copy].u64[word];
+                for (size_t k = 0; k < COUNTER_BITS; k++) {
+                    uint64_t next_carry = counters[block][k].u64[word] & carry;
+                    counters[block][k].u64[word] ^= carry;
+                    carry = next_carry;
+                }
+            }
+        }
+    }
+}
+
+
+
+/**
+ * @brief Add multiple codewords into expanded codewords
+ *
+ * The MULTIPLICITY copies are first added bitsliced by count_copies().
+ * The counters are unpacked to 16-bit lanes only once, by broadcasting each 16-bit part
+ * of counters[k] and comparing it to the lane masks.
  * Note: this does not write the codewords as -1 or +1 as the green machine does
  * instead, just 0 and 1 is used.
  * The resulting hadamard transform has:
  * all values are halved
  * the first entry is 64 too high
  *
- * @param[out] dst Structure that contain the expanded codeword
- * @param[in] src Structure that contain the codeword
+ * @param[out] dst Structure that contain the BLOCKS expanded codewords
+ * @param[in] src Array of BLOCKS * MULTIPLICITY codewords
  */
-inline void expand_and_sum(expandedCodeword *dst, codeword src[]) {
-    // start converting the first copy
+inline void expand_and_sum(expandedCodewords *dst, codeword src[]) {
+    // lane i of bits selects bit i of a 16-bit part of a codeword
+    const __m256i bits = _mm256_setr_epi16(0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+                                           0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, (int16_t) 0x8000);
+    codeword counters[BLOCKS][COUNTER_BITS];
+
+    count_copies(counters, src);
+
     for (size_t part = 0; part < 8; part++) {
-        for (size_t i = 0; i < 16; ++i) {
-            dst->i16[(part << 4) + i] = src->u16[part] >> i & 1;
+        for (size_t block = 0; block < BLOCKS; block++) {
+            // sum = sum_k 2^k * bit k, a set bit gives a -1 mask which is subtracted
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t k = COUNTER_BITS; k-- > 0;) {
+                __m256i word = _mm256_set1_epi16(counters[block][k].u16[part]);
+                sum = _mm256_sub_epi16(_mm256_add_epi16(sum, sum), _mm256_cmpeq_epi16(word & bits, bits));
+            }
+            dst->mm[part][block] = sum;
         }
     }
-    // sum the rest of the copies
-    for (size_t copy = 1; copy < MULTIPLICITY; copy++) {
-        for (size_t part = 0 ; part < 8 ; part++) {
-            for (size_t i = 0; i < 16; ++i) {
-                dst->i16[(part << 4) + i] += src[copy].u16[part] >> i & 1;
+}
+
+
+
+/**
+ * @brief Add multiple codewords into expanded codewords with 8-bit entries
+ *
+ * Same sums as expand_and_sum(), unpacked to 8-bit lanes: each 32-bit part of counters[k] is broadcast,
+ * its byte j is spread over lanes 8 * j to 8 * j + 7, and compared to the lane masks.
+ *
+ * @param[out] dst Structure that contain the BLOCKS expanded codewords
+ * @param[in] src Array of BLOCKS * MULTIPLICITY codewords
+ */
+inline void expand_and_sum8(expandedCodewords8 *dst, codeword src[]) {
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    // lane i of bits selects bit i % 8 of a byte
+    const __m256i bits = _mm256_set1_epi64x(0x8040201008040201);
+    codeword counters[BLOCKS][COUNTER_BITS];
+
+    count_copies(counters, src);
+
+    for (size_t part = 0; part < 4; part++) {
+        for (size_t block = 0; block < BLOCKS; block++) {
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t k = COUNTER_BITS; k-- > 0;) {
+                __m256i word = _mm256_shuffle_epi8(_mm256_set1_epi32(counters[block][k].u32[part]), spread);
+                sum = _mm256_sub_epi8(_mm256_add_epi8(sum, sum), _mm256_cmpeq_epi8(word & bits, bits));
             }
+            dst->mm[part][block] = sum;
         }
     }
 }
@@ -111,30 +208,102 @@ inline void expand_and_sum(expandedCodeword *dst, codeword src[]) {
 /**
  * @brief Hadamard transform
  *
- * Perform hadamard transform of src and store result in dst
- * src is overwritten: it is also used as intermediate buffer
+ * Perform hadamard transform of the BLOCKS codewords of src and store result in dst.
+ * The butterflies of the BLOCKS codewords are independent and issued together.
  *
- * @param[out] src Structure that contain the expanded codeword
- * @param[out] dst Structure that contain the expanded codeword
+ * @param[in] src Structure that contain the expanded codewords
+ * @param[out] dst Structure that contain the expanded codewords
  */
-inline void hadamard(expandedCodeword *src, expandedCodeword *dst) {
-    // the passes move data:
-    // src -> dst -> src -> dst -> src -> dst -> src -> dst
-    // using p1 and p2 alternately
-    expandedCodeword *p1 = src;
-    expandedCodeword *p2 = dst;
+inline void hadamard(expandedCodewords *src, expandedCodewords *dst) {
+    __m256i p1[8][BLOCKS], p2[8][BLOCKS];
+    memcpy(p1, src->mm, sizeof(p1));
     for (size_t pass = 0; pass < 7; pass++) {
         // warning: hadd works "within lanes" as Intel call it
         // so you have to swap the middle 64 bit blocks of the result
         for (size_t part = 0; part < 4; part++) {
-            p2->mm[part] = _mm256_permute4x64_epi64(_mm256_hadd_epi16(p1->mm[2 * part], p1->mm[2 * part + 1]), 0xd8);
-            p2->mm[part + 4] = _mm256_permute4x64_epi64(_mm256_hsub_epi16(p1->mm[2 * part], p1->mm[2 * part + 1]), 0xd8);
+            for (size_t block = 0; block < BLOCKS; block++) {
+                p2[part][block] = _mm256_permute4x64_epi64(_mm256_hadd_epi16(p1[2 * part][block], p1[2 * part + 1][block]), 0xd8);
+                p2[part + 4][block] = _mm256_permute4x64_epi64(_mm256_hsub_epi16(p1[2 * part][block], p1[2 * part + 1][block]), 0xd8);
+            }
+        }
+        memcpy(p1, p2, sizeof(p1));
+    }
+    memcpy(dst->mm, p1, sizeof(p1));
+}
+
+
+
+/**
+ * @brief Hadamard transform with 8-bit lanes for the first passes
+ *
+ * Same result as hadamard(). The first 5 passes run on 32 int8 lanes per register, so each register
+ * holds twice as many entries. The entries are then widened to int16 for the last 2 passes.
+ * After pass p, the entries are at most MULTIPLICITY << p in absolute value,
+ * so HADAMARD_INT8 guarantees that the 8-bit passes never saturate.
+ * An 8-bit pass splits each pair of rows into even and odd entries
+ * (pshufb within 128-bit lanes, then 64-bit and 128-bit permutes) and adds and subtracts them.
+ *
+ * @param[in] src Structure that contain the expanded codewords with 8-bit entries
+ * @param[out] dst Structure that contain the expanded codewords
+ */
+inline void hadamard8(expandedCodewords8 *src, expandedCodewords *dst) {
+    // gathers the even entries of each 128-bit lane in its low 64 bits and the odd ones in its high 64 bits
+    const __m256i deinterleave = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                                                  0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    __m256i p1[4][BLOCKS], p2[4][BLOCKS], q1[8][BLOCKS], q2[8][BLOCKS];
+
+    memcpy(p1, src->mm, sizeof(p1));
+    for (size_t pass = 0; pass < 5; pass++) {
+        for (size_t part = 0; part < 2; part++) {
+            for (size_t block = 0; block < BLOCKS; block++) {
+                __m256i a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(p1[2 * part][block], deinterleave), 0xd8);
+                __m256i b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(p1[2 * part + 1][block], deinterleave), 0xd8);
+                __m256i even = _mm256_permute2x128_si256(a, b, 0x20);
+                __m256i odd = _mm256_permute2x128_si256(a, b, 0x31);
+                p2[part][block] = _mm256_adds_epi8(even, odd);
+                p2[part + 2][block] = _mm256_subs_epi8(even, odd);
+            }
+        }
+        memcpy(p1, p2, sizeof(p1));
+    }
+
+    // widen row r to int16 rows 2r and 2r + 1
+    for (size_t part = 0; part < 4; part++) {
+        for (size_t block = 0; block < BLOCKS; block++) {
+            q1[2 * part][block] = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(p1[part][block]));
+            q1[2 * part + 1][block] = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(p1[part][block], 1));
+        }
+    }
+
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (size_t part = 0; part < 4; part++) {
+            for (size_t block = 0; block < BLOCKS; block++) {
+                q2[part][block] = _mm256_permute4x64_epi64(_mm256_hadd_epi16(q1[2 * part][block], q1[2 * part + 1][block]), 0xd8);
+                q2[part + 4][block] = _mm256_permute4x64_epi64(_mm256_hsub_epi16(q1[2 * part][block], q1[2 * part + 1][block]), 0xd8);
+            }
         }
-        // swap p1, p2 for next round
-        expandedCodeword *p3 = p1;
-        p1 = p2;
-        p2 = p3;
+        memcpy(q1, q2, sizeof(q1));
+    }
+    memcpy(dst->mm, q1, sizeof(q1));
+}
+
+
+
+/**
+ * @brief Packs 128 16-bit comparison masks into a 128-bit bitmap
+ *
+ * @param[out] bitmap Array of size 2 receiving bit i set if entry i of masks is 0xffff
+ * @param[in] masks Array of 8 registers of 16-bit masks
+ */
+static inline void bitmap128(uint64_t *bitmap, const __m256i *masks) {
+    uint64_t bits[4];
+    for (size_t i = 0; i < 4; i++) {
+        // packs interleaves the 128-bit lanes of its inputs, permute4x64 restores the order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(masks[2 * i], masks[2 * i + 1]), 0xd8);
+        bits[i] = (uint32_t) _mm256_movemask_epi8(packed);
     }
+    bitmap[0] = bits[0] | bits[1] << 32;
+    bitmap[1] = bits[2] | bits[3] << 32;
 }
 
 
@@ -160,94 +329,91 @@ inline void hadamard(expandedCodeword *src, expandedCodeword *dst) {
  * and that the entries vary from -64M to 64M.
  * -64M or 64M stands for a perfect codeword.
  *
- * @param[in] transform Structure that contain the expanded codeword
+ * For each block, the maximum absolute value is reduced in registers, the entries equal to it
+ * and the positive entries are packed into 128-bit bitmaps, and the first peak is found with a bit scan.
+ * If there are two identical peaks, the one with the lowest position is taken.
+ *
+ * @param[out] message Array of size BLOCKS receiving the decoded bytes
+ * @param[in] transform Structure that contain the expanded codewords
  */
-inline int32_t find_peaks(expandedCodeword *transform) {
-    __m256i bitmap, abs_rows[8], bound, active_row, max_abs_rows;
-    vector peak_mask;
-    // compute absolute value of transform
-    for (size_t i = 0; i < 8; i++) {
-        abs_rows[i] = _mm256_abs_epi16(transform->mm[i]);
+inline void find_peaks(uint8_t *message, expandedCodewords *transform) {
+    __m256i rows[BLOCKS][8], abs_rows[BLOCKS][8], max_abs[BLOCKS];
+    __m128i max_abs128;
+    uint64_t peaks[2], positives[2];
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (size_t block = 0; block < BLOCKS; block++) {
+        for (size_t i = 0; i < 8; i++) {
+            rows[block][i] = transform->mm[i][block];
+            abs_rows[block][i] = _mm256_abs_epi16(rows[block][i]);
+        }
+        max_abs[block] = abs_rows[block][0];
     }
-    // compute a vector of 16 elements which contains the maximum somewhere
-    max_abs_rows = abs_rows[0];
+
     for (size_t i = 1; i < 8; i++) {
-        max_abs_rows = _mm256_max_epi16(max_abs_rows, abs_rows[i]);
+        for (size_t block = 0; block < BLOCKS; block++) {
+            max_abs[block] = _mm256_max_epi16(max_abs[block], abs_rows[block][i]);
+        }
     }
 
-    // do binary search for the highest value that is lower than the maximum
-    int32_t lower = 1;
-    // this gives 64, 128 or 256 for MULTIPLICITY = 2, 4, 6
-    int32_t width = 1 << (5 + MULTIPLICITY / 2);
-
-    while (width > 1) {
-        width >>= 1;
-        // compare with lower + width; put result in bitmap
-        // make vector from value of new bound
-        bound = _mm256_broadcastw_epi16(_mm_cvtsi32_si128(lower + width));
-        bitmap = _mm256_cmpgt_epi16(max_abs_rows, bound);
-        // step up if there are any matches
-        int32_t step_mask = _mm256_testz_si256(bitmap, bitmap) - 1;
-        lower += step_mask & width;
-    }
-    // lower+width contains the maximum value of the vector
-    // construct vector filled with bound-1
-    bound = _mm256_broadcastw_epi16(_mm_cvtsi32_si128(lower + width - 1));
-
-    // find in which of the 8 groups a maximum occurs to compute bits 4, 5, 6 of message
-    size_t message = 0x70;
-    for (int32_t i = 7; i >= 0; i--) {
-        bitmap = _mm256_cmpgt_epi16(abs_rows[i], bound);
-        int message_mask = (-(int16_t)(_mm256_testz_si256(bitmap, bitmap) == 0)) >> 15;
-        message ^= message_mask & (message ^ (unsigned)i << 4);
-    }
-    // we decided which row of the matrix contains the lowest match
-    // select proper row
-    int8_t index = message >> 4;
-    __m256i res;
-    __m256i tmp = (__m256i) {0ULL, 0ULL, 0ULL, 0ULL};
-
-    for (int8_t i = 0; i < 8; i++) {
-        int8_t abs_value = (int8_t)(index - i);
-        int8_t mask1 = abs_value >> 7;
-        abs_value ^= mask1;
-        abs_value -= mask1;
-        int8_t mask2 = ((uint8_t) - abs_value >> 7);
-        int64_t mask3 = (-1ULL) + mask2;
-        __m256i vect_mask = (__m256i) {mask3, mask3, mask3, mask3};
-        res = _mm256_and_si256(abs_rows[i], vect_mask);
-        tmp = _mm256_or_si256(tmp, res);
+    for (size_t block = 0; block < BLOCKS; block++) {
+        // absolute values are nonnegative, so the maximum is the complement of the unsigned minimum of the complements
+        max_abs128 = _mm_max_epi16(_mm256_castsi256_si128(max_abs[block]), _mm256_extracti128_si256(max_abs[block], 1));
+        max_abs128 = _mm_minpos_epu16(_mm_xor_si128(max_abs128, _mm_set1_epi32(-1)));
+        max_abs[block] = _mm256_set1_epi16((int16_t) ~_mm_extract_epi16(max_abs128, 0));
+
+        for (size_t i = 0; i < 8; i++) {
+            abs_rows[block][i] = _mm256_cmpeq_epi16(abs_rows[block][i], max_abs[block]);
+            rows[block][i] = _mm256_cmpgt_epi16(rows[block][i], zero);
+        }
+        bitmap128(peaks, abs_rows[block]);
+        bitmap128(positives, rows[block]);
+
+        // the maximum is reached, so one of the two words is nonzero
+        uint64_t in_high = -(uint64_t) (peaks[0] == 0);
+        uint64_t peak_bits = (peaks[0] & ~in_high) | (peaks[1] & in_high);
+        uint64_t positive_bits = (positives[0] & ~in_high) | (positives[1] & in_high);
+        uint32_t peak_pos = _tzcnt_u64(peak_bits);
+
+        // set bit 7 if sign of biggest value is positive
+        peak_pos |= (uint32_t) ((positive_bits >> peak_pos) & 1) << 7;
+        peak_pos += (uint32_t) (in_high & 64);
+        message[block] = peak_pos;
     }
+}
 
-    active_row = tmp;
 
-    // get the column number of the vector element
-    peak_mask.mm = _mm256_cmpgt_epi16(active_row, bound);
-    for (size_t i = 0; i < 16; ++i) {
-        peak_mask.u16[i] &= 1 << i;
-    }
 
-    for (int32_t i = 0; i < 3; i++) {
-        peak_mask.mm = _mm256_hadd_epi16(peak_mask.mm, peak_mask.mm);
-    }
-    // add low 4 bits of message
-    message |= _bit_scan_forward(peak_mask.u16[0] + peak_mask.u16[8]);
-
-    // set bit 7 if sign of biggest value is positive
-    tmp = (__m256i) {0ULL,0ULL, 0ULL, 0ULL};
-    for (uint32_t i = 0; i < 8; i++){
-        int64_t message_mask = (-(int64_t)(i == message/16))>>63;
-        __m256i vect_mask = (__m256i) {message_mask, message_mask, message_mask, message_mask};
-        tmp = _mm256_or_si256(tmp, _mm256_and_si256(vect_mask, transform->mm[i]));
-    }
-    uint16_t result = 0;
-    for (uint32_t i = 0; i < 16; i++) {
-        uint16_t *ptr = (uint16_t *) &tmp;
-        int32_t message_mask = (-(int32_t)(i == message % 16))>> (sizeof(int32_t) * 8 - 1);
-        result |= message_mask & ptr[i];
+/**
+ * @brief Encodes the received word, or adds its encoding to cdw
+ *
+ * The message consists of N1 bytes each byte is encoded into PARAM_N2 bits,
+ * or MULTIPLICITY repeats of 128 bits. <br>
+ * Bytes are encoded two at a time, codewords A and B in the two lanes of a register,
+ * and the 2 * MULTIPLICITY copies are written with MULTIPLICITY 256-bit stores
+ * of [A, A], [A, B] or [B, B] (for MULTIPLICITY = 3: [A, A], [A, B], [B, B]).
+ * VEC_N1_SIZE_BYTES is even since it is a multiple of BLOCKS.
+ *
+ * @param[in,out] cdw Array of size VEC_N1N2_SIZE_64 receiving the encoded message
+ * @param[in] msg Array of size VEC_N1_SIZE_64 storing the message
+ * @param[in] accumulate If nonzero, the encoded message is XORed into cdw instead of overwriting it
+ */
+static inline void encode_copies(uint64_t *cdw, const uint64_t *msg, int accumulate) {
+    uint8_t *message_array = (uint8_t *) msg;
+    __m256i *codeArray = (__m256i *) cdw;
+    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i += 2) {
+        __m256i words = encode(message_array[i], message_array[i + 1]);
+        __m256i words_aa = _mm256_permute2x128_si256(words, words, 0x00);
+        __m256i words_bb = _mm256_permute2x128_si256(words, words, 0x11);
+        // fill entries i * MULTIPLICITY to (i+2) * MULTIPLICITY
+        for (size_t k = 0; k < MULTIPLICITY; k++) {
+            __m256i copies = (2 * k + 1 < MULTIPLICITY) ? words_aa : (2 * k >= MULTIPLICITY) ? words_bb : words;
+            if (accumulate) {
+                copies ^= _mm256_loadu_si256(&codeArray[i / 2 * MULTIPLICITY + k]);
+            }
+            _mm256_storeu_si256(&codeArray[i / 2 * MULTIPLICITY + k], copies);
+        }
     }
-    message |= (0x8000 & ~result) >> 8;
-    return message;
 }
 
 
@@ -255,26 +421,26 @@ inline int32_t find_peaks(expandedCodeword *transform) {
 /**
  * @brief Encodes the received word
  *
- * The message consists of N1 bytes each byte is encoded into PARAM_N2 bits,
- * or MULTIPLICITY repeats of 128 bits
- *
  * @param[out] cdw Array of size VEC_N1N2_SIZE_64 receiving the encoded message
  * @param[in] msg Array of size VEC_N1_SIZE_64 storing the message
  */
 void reed_muller_encode(uint64_t *cdw, const uint64_t *msg) {
-    uint8_t *message_array = (uint8_t *) msg;
-    codeword *codeArray = (codeword *) cdw;
-    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i++) {
-        // fill entries i * MULTIPLICITY to (i+1) * MULTIPLICITY
-        int32_t pos = i * MULTIPLICITY;
-        // encode first word
-        encode(&codeArray[pos], message_array[i]);
-        // copy to other identical codewords
-        for (size_t copy = 1; copy < MULTIPLICITY; copy++) {
-            memcpy(&codeArray[pos + copy], &codeArray[pos], sizeof(codeword));
-        }
-    }
-    return;
+    encode_copies(cdw, msg, 0);
+}
+
+
+
+/**
+ * @brief Adds the encoding of the message to the received word
+ *
+ * Same codeword as reed_muller_encode(), XORed into cdw instead of overwriting it,
+ * so that the encryption can add m.G directly to s.r2 + e without an intermediate codeword.
+ *
+ * @param[in,out] cdw Array of size VEC_N1N2_SIZE_64 to which the encoded message is added
+ * @param[in] msg Array of size VEC_N1_SIZE_64 storing the message
+ */
+void reed_muller_encode_xor(uint64_t *cdw, const uint64_t *msg) {
+    encode_copies(cdw, msg, 1);
 }
 
 
@@ -290,17 +456,42 @@ void reed_muller_encode(uint64_t *cdw, const uint64_t *msg) {
  */
 void reed_muller_decode(uint64_t *msg, const uint64_t *cdw) {
     uint8_t *message_array = (uint8_t *) msg;
+    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i += BLOCKS) {
+        reed_muller_decode_blocks(message_array, cdw, i);
+    }
+}
+
+
+
+/**
+ * @brief Decodes BLOCKS consecutive blocks of the received word
+ *
+ * The BLOCKS blocks are decoded together, their rows interleaved so that the independent
+ * butterflies and peak searches of the blocks are issued side by side.
+ *
+ * @param[out] msg Array of size VEC_N1_SIZE_BYTES receiving the decoded bytes first to first + BLOCKS - 1
+ * @param[in] cdw Array of size VEC_N1N2_SIZE_64 storing the received word
+ * @param[in] first Index of the first block to decode, a multiple of BLOCKS
+ */
+void reed_muller_decode_blocks(uint8_t *msg, const uint64_t *cdw, size_t first) {
     codeword *codeArray = (codeword *) cdw;
-    expandedCodeword expanded;
-    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i++) {
-        // collect the codewords
-        expand_and_sum(&expanded, &codeArray[i * MULTIPLICITY]);
-        // apply hadamard transform
-        expandedCodeword transform;
-        hadamard(&expanded, &transform);
-        // fix the first entry to get the half Hadamard transform
-        transform.i16[0] -= 64 * MULTIPLICITY;
-        // finish the decoding
-        message_array[i] = find_peaks(&transform);
+    expandedCodewords transform;
+#ifdef HADAMARD_INT8
+    expandedCodewords8 expanded;
+    // collect the codewords of BLOCKS consecutive blocks and apply hadamard transform
+    expand_and_sum8(&expanded, &codeArray[first * MULTIPLICITY]);
+    hadamard8(&expanded, &transform);
+#else
+    expandedCodewords expanded;
+    // collect the codewords of BLOCKS consecutive blocks
+    expand_and_sum(&expanded, &codeArray[first * MULTIPLICITY]);
+    // apply hadamard transform
+    hadamard(&expanded, &transform);
+#endif
+    // fix the first entries to get the half Hadamard transforms
+    for (size_t block = 0; block < BLOCKS; block++) {
+        transform.i16[0][block][0] -= 64 * MULTIPLICITY;
     }
+    // finish the decoding
+    find_peaks(&msg[first], &transform);
 }
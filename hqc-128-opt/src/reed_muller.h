@@ -10,7 +10,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+// number of RM(1,7) blocks decoded together by reed_muller_decode_blocks()
+#define RM_DECODE_BLOCKS                   2
+
 void reed_muller_encode(uint64_t* cdw, const uint64_t* msg);
+void reed_muller_encode_xor(uint64_t* cdw, const uint64_t* msg);
 void reed_muller_decode(uint64_t* msg, const uint64_t* cdw);
+void reed_muller_decode_blocks(uint8_t* msg, const uint64_t* cdw, size_t first);
 
 #endif
@@ -18,7 +18,6 @@
 #endif
 
 static uint16_t mod(uint16_t i, uint16_t modulus);
-static void compute_syndromes(__m256i *syndromes, uint8_t *cdw);
 static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes);
 static void compute_roots(uint8_t *error, uint16_t *sigma);
 static void compute_z_poly(uint16_t *z, const uint16_t *sigma, uint16_t degree, const uint16_t *syndromes);
@@ -26,99 +25,57 @@ static void compute_error_values(uint16_t *error_values, const uint16_t *z, cons
 static void correct_errors(uint8_t *cdw, const uint16_t *error_values);
 
 
-static const __m256i alpha_ij256_1[45] = {
-    {0x0010000800040002,0x001d008000400020,0x00cd00e80074003a,0x004c002600130087},
-    {0x001d004000100004,0x004c001300cd0074,0x008f00ea00b4002d,0x009d006000180006},
-    {0x00cd003a00400008,0x008f0075002d0026,0x002500270060000c,0x004600c100b50035},
-    {0x004c00cd001d0010,0x009d0018008f00b4,0x004600ee006a0025,0x005f00b9005d0014},
-    {0x00b4002600740020,0x006a009c00600003,0x00b900a0000500c1,0x00fd000f005e00be},
-    {0x008f002d00cd0040,0x004600b500250060,0x0065006100b90050,0x00d900df006b0078},
-    {0x0018007500130080,0x005d008c00b5009c,0x006b003c005e00a1,0x0081001a004300a3},
-    {0x009d008f004c001d,0x005f005d0046006a,0x00d900fe00fd0065,0x0085003b0081000d},
-    {0x0025000c002d003a,0x006500a1005000c1,0x00d0008600df00e7,0x00a800a9006600ed},
-    {0x006a006000b40074,0x00fd005e00b90005,0x003b0067001100df,0x00e600550084002e},
-    {0x00ee002700ea00e8,0x00fe003c006100a0,0x00b8007600670086,0x00e3009100390054},
-    {0x00460025008f00cd,0x00d9006b006500b9,0x00a800b8003b00d0,0x0082009600fc00e4},
-    {0x0014003500060087,0x000d00a3007800be,0x00e40054002e00ed,0x00510064006200e5},
-    {0x005d00b500180013,0x00810043006b005e,0x00fc003900840066,0x0012005900c80062},
-    {0x00b900c100600026,0x003b001a00df000f,0x00960091005500a9,0x002c002400590064},
-    {0x005f0046009d004c,0x0085008100d900fd,0x008200e300e600a8,0x0002002c00120051},
-    {0x0099000a004e0098,0x004f0093004400d6,0x00dd00dc00d70092,0x00980001000b0045},
-    {0x006500500025002d,0x00a8006600d000df,0x00c30007009600bf,0x0027002600ad00fb},
-    {0x001e00ba0094005a,0x0049006d003e00e2,0x003d00a200ae00b3,0x008c006000e80083},
-    {0x00fd00b9006a00b4,0x00e60084003b0011,0x002c00ac001c0096,0x00be00c100030020},
-    {0x006b00a100b50075,0x00fc00290066001a,0x00ad00f500590057,0x00e700b90035002d},
-    {0x00fe006100ee00ea,0x00e3003900b80067,0x003a00b000ac0007,0x00af000f002800c0},
-    {0x005b002f009f00c9,0x009500d10021007c,0x0075004700f400a6,0x001f00df00c200ee},
-    {0x00d900650046008f,0x008200fc00a8003b,0x0027003a002c00c3,0x0017001a00e700ba},
-    {0x0011000f00050003,0x001c00ff00550033,0x00c100b4006c0024,0x004d003b00e2005e},
-    {0x000d007800140006,0x0051006200e4002e,0x00ba00c0002000fb,0x00d100a900bd00bb},
-    {0x00d000e70050000c,0x00c3005700bf00a9,0x002f00b50026007d,0x00db005500c500d9},
-    {0x0081006b005d0018,0x001200c800fc0084,0x00e70028000300ad,0x00190091009e00bd},
-    {0x00f8007f00690030,0x00f700e000f1004d,0x00b6005f009c0040,0x00a2009600aa00ec},
-    {0x003b00df00b90060,0x002c005900960055,0x001a000f00c10026,0x00240064009100a9},
-    {0x009700b600de00c0,0x001b009b006e0072,0x00ed00b100a0008f,0x00580059004b0052},
-    {0x008500d9005f009d,0x00020012008200e6,0x001700af00be0027,0x00040024001900d1},
-    {0x00b8008600610027,0x003a00f500070091,0x001500d0000f00b5,0x002d002c00a600f1},
-    {0x004f00440099004e,0x0098000b00dd00d7,0x0092009300d6000a,0x004e0001004500dc},
-    {0x0084001a005e009c,0x000300e9005900ff,0x0091002e00e200b9,0x0005002600eb001c},
-    {0x00a800d000650025,0x002700ad00c30096,0x00db0015001a002f,0x00610060003600f2},
-    {0x005200ce0089004a,0x00d40010008a0037,0x00570049007c0078,0x00d300c1001d0048},
-    {0x0049003e001e0094,0x008c00e8003d00ae,0x003800630033007f,0x004300b900ea0016},
-    {0x00e400ed00780035,0x00ba002d00fb0064,0x00f200f100a900d9,0x003e000f002500ad},
-    {0x00e6003b00fd006a,0x00be0003002c001c,0x00240037004d001a,0x002e00df00050074},
-    {0x00c600c500d300d4,0x00ca009d00cf00a7,0x008b00c80072003e,0x009a001a005f00c9},
-    {0x00fc0066006b00b5,0x00e7003500ad0059,0x003600a6009100c5,0x00bf003b00780025},
-    {0x007b001700b10077,0x00e1009f000800ef,0x0040002b00ff00b8,0x00ab00a9005b008c},
-    {0x00e300b800fe00ee,0x00af0028003a00ac,0x002d007a00370015,0x00320055003400de},
-    {0x009600a900df00c1,0x001a00b900260024,0x0060002c00640055,0x00590091003b000f}
-};
-static const __m256i alpha_ij256_2[45] = {
-    {0x00b4005a002d0098,0x008f00c900ea0075,0x0018000c00060003,0x0000000000600030},
-    {0x006a00940025004e,0x0046009f00ee00b5,0x005d005000140005,0x0000000000b90069},
-    {0x00b900ba0050000a,0x0065002f006100a1,0x006b00e70078000f,0x0000000000df007f},
-    {0x00fd001e00650099,0x00d9005b00fe006b,0x008100d0000d0011,0x00000000003b00f8},
-    {0x001100e200df00d6,0x003b007c0067001a,0x008400a9002e0033,0x000000000055004d},
-    {0x003b003e00d00044,0x00a8002100b80066,0x00fc00bf00e40055,0x00000000009600f1},
-    {0x0084006d00660093,0x00fc00d100390029,0x00c80057006200ff,0x00000000005900e0},
-    {0x00e6004900a8004f,0x0082009500e300fc,0x001200c30051001c,0x00000000002c00f7},
-    {0x009600b300bf0092,0x00c300a600070057,0x00ad007d00fb0024,0x0000000000260040},
-    {0x001c00ae009600d7,0x002c00f400ac0059,0x000300260020006c,0x0000000000c1009c},
-    {0x00ac00a2000700dc,0x003a004700b000f5,0x002800b500c000b4,0x00000000000f005f},
-    {0x002c003d00c300dd,0x00270075003a00ad,0x00e7002f00ba00c1,0x00000000001a00b6},
-    {0x0020008300fb0045,0x00ba00ee00c0002d,0x00bd00d900bb005e,0x0000000000a900ec},
-    {0x000300e800ad000b,0x00e700c200280035,0x009e00c500bd00e2,0x00000000009100aa},
-    {0x00c1006000260001,0x001a00df000f00b9,0x0091005500a9003b,0x0000000000640096},
-    {0x00be008c00270098,0x0017001f00af00e7,0x001900db00d1004d,0x00000000002400a2},
-    {0x00d60099000a004e,0x0092004f00930044,0x004500dd00dc00d7,0x000000000001000b},
-    {0x001a007f002f000a,0x00db0073001500c5,0x003600f500f20064,0x00000000006000cd},
-    {0x00330034007f0099,0x00380062006300a8,0x00ea0008001600ac,0x0000000000b900d4},
-    {0x004d0033001a00d6,0x002400a700370091,0x00050060007400e9,0x0000000000df005e},
-    {0x009100a800c50044,0x0036003d00a6006e,0x007800ba00250026,0x00000000003b0086},
-    {0x0037006300150093,0x002d00d8007a00a6,0x0034006b00de006a,0x0000000000550085},
-    {0x00a700620073004f,0x00b5005a00d8003d,0x00da00ce00fe00be,0x00000000009600d5},
-    {0x0024003800db0092,0x006100b5002d0036,0x00bf0021003e00df,0x000000000059006e},
-    {0x00e900ac006400d7,0x00df00be006a0026,0x00ae00910084007c,0x00000000002c00ef},
-    {0x0074001600f200dc,0x003e00fe00de0025,0x002b0082003f0084,0x00000000002600fa},
-    {0x0060000800f500dd,0x002100ce006b00ba,0x00cf005600820091,0x0000000000c1002d},
-    {0x000500ea00360045,0x00bf00da00340078,0x005a00cf002b00ae,0x00000000000f0023},
-    {0x005e00d400cd000b,0x006e00d500850086,0x0023002d00fa00ef,0x00000000001a001e},
-    {0x00df00b900600001,0x005900960055003b,0x000f00c10026002c,0x0000000000a9001a},
-    {0x006700f000460098,0x00fb00e0007b0015,0x0088006500d40074,0x00000000009100da},
-    {0x002e00430061004e,0x00080048003200bf,0x005c008600c2009c,0x0000000000640063},
-    {0x005500ed006b000a,0x000c003600c300c4,0x0073006600b600b9,0x0000000000240082},
-    {0x00d7004f00440099,0x000a0098000b00dd,0x00dc0092009300d6,0x0000000000010045},
-    {0x00ae0072003b00d6,0x000f006a00200024,0x00ef0096004d0067,0x000000000060006c},
-    {0x005900f100210044,0x008600a1000c00cf,0x007d00a600b300a9,0x0000000000b9008f},
-    {0x00f4001900e40093,0x00c500b1008c00cd,0x004c00fb008d00e6,0x0000000000df0028},
-    {0x006c007900f1004f,0x002900bd00bc0027,0x00ee004000090037,0x00000000003b00d3},
-    {0x002600f500820092,0x00b300b800b60050,0x0065002700360059,0x00000000005500ce},
-    {0x009c006c005900d7,0x00640072007c000f,0x001100b900b400eb,0x0000000000960084},
-    {0x00a00013003d00dc,0x005600ab009e00d9,0x0085007f009f0020,0x00000000005900e5},
-    {0x000f002700cf00dd,0x007d0038007300ed,0x00e4003e00650060,0x00000000002c0007},
-    {0x00e20014003a0045,0x00cd001200310021,0x00950015004300a0,0x0000000000260090},
-    {0x007c00bc000c000b,0x0025008300e00073,0x007900fc009700fd,0x0000000000c10002},
-    {0x00a900df00c10001,0x00b9002600240096,0x002c00640055001a,0x00000000000f0060}
+/**
+ * Columns 1 to PARAM_N1 - 1 of the syndrome matrix alpha^(i*j), 1 <= i <= 2 * PARAM_DELTA, split into nibbles.
+ * alpha_nibbles[j - 1][0] (resp. [1]) holds the low (resp. high) nibble of each of the 2 * PARAM_DELTA
+ * coefficients of column j, one byte per row, padded with zeros. They are used as PSHUFB indices.
+ */
+static const __m256i alpha_nibbles[PARAM_N1 - 1][2] = {
+    {{0x0d00000000080402,0x0c0603070d08040a,0x0f090a05040a0d08,0x00000000080c0603}, {0x0108040201000000,0x040201080c0e0703,0x080c0e070b050209,0x0000060301000000}},
+    {{0x0c030d040d000004,0x0d0008060f0a040d,0x060f0e050a04050e,0x000009090d000405}, {0x04010c0701040100,0x09060100080e0b02,0x04090e0b06090204,0x00000b0605050100}},
+    {{0x0f050d060d0a0008,0x060105050507000c,0x050f0101090a000a,0x00000f0f0b07080f}, {0x080702020c030400,0x040c0b0302020600,0x0602060a0b0b0500,0x00000d07060e0700}},
+    {{0x0d080f040c0d0d00,0x0f090d04060e0a05,0x090b0e0b0d0e0509,0x00000b0801000d01}, {0x0901080b040c0101,0x050b0501040e0602,0x0d050f060f010609,0x0000030f080d0001}},
+    {{0x0a0c000304060400,0x0d0f0e0e09000501,0x0b0c070a01020f06,0x0000050d04090e03}, {0x060906000b020702,0x0f00050b0b0a000c,0x03070601010e0d0d,0x00000504080a0203}},
+    {{0x060505000f0d0d00,0x090f0b0805010900,0x080108060b0e0004,0x000006010c0f0405}, {0x040b020608020c04,0x0d0d060706060b05,0x0a020b0603030d04,0x0000090f0f0b0e05}},
+    {{0x0d0c050c08050300,0x010a03030b0c0e01,0x0c010909040d0603,0x000009000807020f}, {0x05080b0901070108,0x0801040a0603050a,0x0f0d030208060609,0x0000050e0c05060f}},
+    {{0x0f0d060a0d0f0c0d,0x050b010d090e0d05,0x0205030c0609080f,0x00000c070203010c}, {0x0505040609080401,0x080308000d0f0f06,0x08090e0f0e040a04,0x0000020f010c0501}},
+    {{0x05010001050c0d0a,0x0809060d00060f07,0x0306070706030f02,0x000006000d0d0b04}, {0x060a050c02000203,0x0a0a060e0d080d0e,0x0c0a0005090b0b09,0x000002040a070f02}},
+    {{0x0d0e09050a000404,0x0605040e0b07010f,0x0c040c090c0e0607,0x0000010c0306000c}, {0x0f050b0006060b07,0x0e0508020306010d,0x020f0a05010a090d,0x00000c0900020206}},
+    {{0x0e0c01000e070a08,0x0301090408060706,0x0a0700050c02070c,0x00000f0f08050004}, {0x0f03060a0e020e0e,0x0e0903050b070608,0x03040b0f0a0a000d,0x00000005020b0c0b}},
+    {{0x090b050906050f0d,0x02060c0408080b00,0x07050a0d0c0d030d,0x00000a06070f0a01}, {0x0d06060b0402080c,0x08090f0e0a0b030d,0x0207030a02030c0d,0x0000010b0e020b0c}},
+    {{0x0d03080e04050607,0x0104020504040e0d,0x0a0e000d00030b05,0x0000090c0d090b0e}, {0x000a070b01030008,0x0506060e0e05020e,0x0b0e0c0202080f04,0x00000a0e0b0d0b05}},
+    {{0x01030b0e0d050803,0x020908020c090406,0x0702080503080d0b,0x0000010a0e050d02}, {0x08040605050b0101,0x01050c060f030806,0x0e0c0203000e0a00,0x0000090a090c0b0e}},
+    {{0x0b0a0f0f09010006,0x0c04090406010509,0x0a0f0f0901000601,0x000004060105090b}, {0x03010d000b0c0602,0x020205060909050a,0x010d000b0c060200,0x0000060909050a03}},
+    {{0x0501090d0f060d0c,0x020c020102030608,0x070f0f070e0c0708,0x00000402090b010d}, {0x08080d0f05040904,0x00020105080e0e0a,0x01010a0e0b080209,0x0000020a010d0d04}},
+    {{0x0f030406090a0e08,0x08010b050d0c0702,0x020f030406090a0e,0x0000010b050d0c07}, {0x0409040d09000409,0x090000040d0d0d09,0x090409040d090004,0x00000000040d0d0d}},
+    {{0x0806000f0500050d,0x07060d0b0307060f,0x0b0305050a0f0f0a,0x0000000d06050204}, {0x0a060d0d06050202,0x02020a0f0c00090b,0x0d07010c01070200,0x0000060c030f0f06}},
+    {{0x090d0e020e0a040a,0x0c0008030d020e03,0x0802030803040f09,0x000009040a08060c}, {0x0406030e010b0905,0x08060e08030a0a0b,0x0306060a03030709,0x00000b0d0e00010a}},
+    {{0x06040b010d090a04,0x0e0103000c0c0c06,0x040707010d030a06,0x00000f0e05000409}, {0x0e0803010f0b060b,0x0b0c0002020a0109,0x020a03090403010d,0x00000d050006070e}},
+    {{0x0c09060a0b010505,0x0709050d0d050907,0x060d060e01080504,0x00000b06080a0506}, {0x0f020601060a0b07,0x0e0b03020a0f0505,0x03030a06090a0c04,0x00000308070b0202}},
+    {{0x030908070e010e0a,0x0f0f08000a000c07,0x0d080a0607030503,0x00000505040b0e0a}, {0x0e030b060f060e0e,0x0a00020c030b0a00,0x020d070a03060109,0x0000050803060d06}},
+    {{0x0501010c0b0f0f09,0x0f0f020e05070406,0x050a080d0702030f,0x000006050a0e0e0e}, {0x090d02070502090c,0x010d0c0e07040f0a,0x0b050d030a060704,0x0000090d0d0c0f0b}},
+    {{0x020c080b0905060f,0x070a070a070a0c03,0x01050d0604080b02,0x0000090e0f010e0f}, {0x080f0a030d060408,0x01010e0b0203020c,0x060b020302030d09,0x000005060b02030d}},
+    {{0x0c0f0503010f0503,0x0d0b020e01040c04,0x0f0e0a06090c0407,0x00000c0f0e01040c}, {0x010f050301000000,0x04030e050c0b0602,0x0d0b06020e0a060d,0x0000020e0a090807}},
+    {{0x0102040e0d080406,0x01090d0b0a00000b,0x0e0e0e050406020c,0x0000060a0b020f04}, {0x05060e0200070100,0x0d0a0b0b0b0c020f,0x030f0d0207010f0d,0x0000020f02080308}},
+    {{0x03070f090007000c,0x0b0505090f05060d,0x010e0b0a0008050d,0x0000010d0f060201}, {0x0c050b0a0d0e0500,0x0d050c0d020b0207,0x020c060b06000f0d,0x00000c020c050809}},
+    {{0x02080c04010b0d08,0x09010e0d0708030d,0x0f0a0408050a0605,0x00000f030a0f0b0e}, {0x010c0f0808060501,0x0109090b0e02000a,0x0b0d0307000e0304,0x00000002050c020a}},
+    {{0x0700010d080f0900,0x02060a0c060f0c00,0x0e0505060e040d0b,0x00000a0e030d0a0f}, {0x0f0e0f040f070603,0x0a090a0e0b050904,0x060d0808050d0c00,0x0000010102020f0e}},
+    {{0x0c0906050b0f0900,0x040401090a0f0106,0x0906050b0f090001,0x0000090a0f01060c}, {0x02050905030d0b06,0x0206090a01000c02,0x050905030d0b0600,0x00000a01000c0202}},
+    {{0x0b0b0e0207060e00,0x08090b020d01000f,0x0b000b0507000608,0x0000010a08050404}, {0x01090607090b0d0c,0x050504050e0b0a08,0x0f0e0701060f0409,0x0000090d08060d07}},
+    {{0x0202020605090f0d,0x04040901070f0e07,0x0808020f0e03010e,0x000004030c06020c}, {0x0001080e080d0509,0x0002010d010a0b02,0x0004030b02040604,0x0000060605080c09}},
+    {{0x0a05070108060107,0x0d0c060105000f05,0x0c060304050d0b0a,0x0000040203060609}, {0x030f00090b080602,0x02020a0f010d000b,0x00030c0c050e0600,0x0000020807060b0b}},
+    {{0x080b0d070f04090e,0x0e01050c0203060a,0x0a080b0d070f0409,0x000001050c020306}, {0x09000d0d04040904,0x0400040d09090d00,0x0009000d0d040409,0x000000040d09090d}},
+    {{0x0309090f040a0e0c,0x05060b0c010e0209,0x0f0a00040e020b06,0x0000000c0f060d07}, {0x000e050f08010509,0x00020e0109020e0b,0x000602020a07030d,0x000006060e090406}},
+    {{0x070d030608000505,0x010006020b050a0f,0x06010c0f09010104,0x0000090f0d060309}, {0x020a0c090a0d0602,0x0606030f0d010102,0x080a000c050f0204,0x00000b08070a0b0a}},
+    {{0x04000a07020e090a,0x03010d0807090c08,0x05010c0d04090403,0x00000f080c0b0d06}, {0x0d010803050c0804,0x0d0c010405040707,0x0c0b080c0f010e09,0x00000d02040f080e}},
+    {{0x0c080d0e090e0e04,0x03090a060803030f,0x090d0c070c09010f,0x00000b030e000907}, {0x080e030a04030109,0x040b0e0103060307,0x020b0b0206070f04,0x0000030d0e040003}},
+    {{0x0a0d0b04040d0805,0x0e0f050d02010909,0x0308060006050202,0x0000050e05070609}, {0x0b020f060e0e0703,0x0300020a0f0f0a0d,0x0b0b0b05020f0809,0x0000050c06020305}},
+    {{0x0e030c0c060b0d0a,0x0e0f050404070d0a,0x04020c0f0c0c0907,0x000006040109040b}, {0x0b0002010e030f06,0x020d000702030401,0x060707000906050d,0x00000908010b0b0e}},
+    {{0x0a0d0f0706050304,0x0a0a0f090b08020e,0x060b0e0900030d0c,0x00000905050f0f00}, {0x0c090c0a0c0c0d0d,0x0901050c080c0703,0x050a090d0a01030d,0x0000050e08070902}},
+    {{0x07050d090c060b05,0x0f0b080506060105,0x0d08030d0f070f0d,0x00000c07040e0500}, {0x0e030a050f06060b,0x0b030702030a090c,0x0703070e00020c0d,0x000002000e030606}},
+    {{0x010f080f0b070107,0x0b090b0c000b0f08,0x0d02010102040a05,0x0000060005050300}, {0x0e09000e07010b07,0x0a0a050804020f0b,0x0c0103020e010304,0x000002090901040a}},
+    {{0x0f080a0c03080e0e,0x0205040e0d0a0705,0x050300030c0c0c0b,0x00000102090c070d}, {0x0a02030a0e0b0f0e,0x0305030d02070301,0x02080e07070b0000,0x00000c00070f090f}},
+    {{0x0a09060406090f01,0x09010b0f000c0405,0x09060406090f0101,0x00000f000c04050a}, {0x010b0202090a0d0c,0x0509030006020605,0x0b0202090a0d0c00,0x0000000602060501}}
 };
 
 
@@ -232,34 +189,63 @@ void reed_solomon_encode(uint64_t *cdw, const uint64_t *msg) {
 
 
 /**
- * @brief Computes 2 * PARAM_DELTA syndromes
+ * @brief Adds the contribution of received symbols first to first + count - 1 to the 2 * PARAM_DELTA syndromes
+ *
+ * The syndromes are the product of the syndrome matrix alpha^(i*j) by the received vector,
+ * so they can be accumulated column by column as the symbols become available.
+ * For each column j, the products cdw[j] * c, 0 <= c < 16 and cdw[j] * (c << 4), 0 <= c < 16
+ * are built in two registers from the multiples cdw[j] * X^b, then looked up with PSHUFB
+ * at the public nibbles of column j given by alpha_nibbles. No memory access depends on the received vector.
+ * GF2P8AFFINEQB could multiply by the constants of the matrix as 8x8 bit matrices, whatever the
+ * field polynomial, but it needs GFNI; the PSHUFB lookups only need AVX2.
  *
- * @param[out] syndromes Array of size 2 * PARAM_DELTA receiving the computed syndromes
+ * @param[in,out] syndromes8 The 2 * PARAM_DELTA syndromes in 8-bit lanes, zero before the first call
  * @param[in] cdw Array of size PARAM_N1 storing the received vector
+ * @param[in] first Index of the first symbol to add
+ * @param[in] count Number of symbols to add
  */
-void compute_syndromes(__m256i *syndromes256, uint8_t *cdw) {
-    uint16_t *syndromes = (uint16_t *) syndromes256;
-    syndromes256[0] = _mm256_set1_epi16(cdw[0]);
-
-    for (size_t i = 0; i < PARAM_N1 - 1; ++i) {
-        syndromes256[0] ^= gf_mul_vect(_mm256_set1_epi16(cdw[i + 1]), alpha_ij256_1[i]);
+void reed_solomon_syndromes_update(__m256i *syndromes8, const uint8_t *cdw, size_t first, size_t count) {
+    const __m256i nibbles = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                             0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i gf_poly = _mm256_set1_epi8(PARAM_GF_POLY & 0xff);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i nibble_bits[4];
+    __m256i acc_lo = zero;
+    __m256i acc_hi = zero;
+    __m256i x, table_lo, table_hi;
+
+    // nibble_bits[b] byte c is 0xff if bit b of c is set
+    for (size_t b = 0; b < 4; ++b) {
+        nibble_bits[b] = _mm256_cmpeq_epi8(nibbles & _mm256_set1_epi8(1 << b), _mm256_set1_epi8(1 << b));
     }
 
-    __m256i last_syndromes256 = _mm256_set1_epi16(cdw[0]);
+    for (size_t j = first; j < first + count; ++j) {
+        // The first column of the syndrome matrix is all ones
+        if (j == 0) {
+            acc_lo ^= _mm256_set1_epi8(cdw[0]);
+            continue;
+        }
 
-    for (size_t i = 0; i < PARAM_N1 - 1; ++i) {
-        last_syndromes256 ^= gf_mul_vect(_mm256_set1_epi16(cdw[i + 1]), alpha_ij256_2[i]);
-    }
+        x = _mm256_set1_epi8(cdw[j]);
 
-    __m128i *s128 = (__m128i *) &last_syndromes256;
-    _mm_store_si128((__m128i *) (syndromes + 16), *s128);
+        // table_lo[c] = cdw[j] * c, table_hi[c] = cdw[j] * (c << 4)
+        table_lo = zero;
+        for (size_t b = 0; b < 4; ++b) {
+            table_lo ^= nibble_bits[b] & x;
+            x = _mm256_add_epi8(x, x) ^ (_mm256_cmpgt_epi8(zero, x) & gf_poly);
+        }
+
+        table_hi = zero;
+        for (size_t b = 0; b < 4; ++b) {
+            table_hi ^= nibble_bits[b] & x;
+            x = _mm256_add_epi8(x, x) ^ (_mm256_cmpgt_epi8(zero, x) & gf_poly);
+        }
 
-    uint64_t *s8 = (uint64_t *) (syndromes + 24);
-    s8[0] = _mm_extract_epi64(s128[1], 0);
+        acc_lo ^= _mm256_shuffle_epi8(table_lo, alpha_nibbles[j - 1][0]);
+        acc_hi ^= _mm256_shuffle_epi8(table_hi, alpha_nibbles[j - 1][1]);
+    }
 
-    uint32_t *s12 = (uint32_t *) (syndromes + 28);
-    uint32_t *s32 = ((uint32_t *) &last_syndromes256) + 6;
-    s12[0] = *s32;
+    *syndromes8 ^= acc_lo ^ acc_hi;
 }
 
 
@@ -269,23 +255,25 @@ void compute_syndromes(__m256i *syndromes256, uint8_t *cdw) {
  *
  * This is a constant time implementation of Berlekamp's simplified algorithm (see @cite lin1983error (Chapter 6 - BCH Codes). <br>
  * We use the letter p for rho which is initialized at -1. <br>
- * The array X_sigma_p represents the polynomial X^(mu-rho)*sigma_p(X). <br>
+ * The register X_sigma_p represents the polynomial X^(mu-rho)*sigma_p(X). <br>
  * Instead of maintaining a list of sigmas, we update in place both sigma and X_sigma_p. <br>
  * sigma_copy serves as a temporary save of sigma in case X_sigma_p needs to be updated. <br>
  * We can properly correct only if the degree of sigma does not exceed PARAM_DELTA.
- * This means only the first PARAM_DELTA + 1 coefficients of sigma are of value
- * and we only need to save its first PARAM_DELTA - 1 coefficients.
+ * This means only the first PARAM_DELTA + 1 coefficients of sigma are of value,
+ * so that sigma, sigma_copy and X_sigma_p each fit in a single 256-bit register. <br>
+ * Each iteration updates the whole polynomial sigma with one gf_mul_vect by the broadcast discrepancy dd.
+ * The next discrepancy is the dot product of sigma with a window of the syndromes in reverse order,
+ * loaded from a zero-padded copy so that the coefficients above mu + 1 vanish.
  *
  * @returns the degree of the ELP sigma
- * @param[out] sigma Array of size (at least) PARAM_DELTA receiving the ELP
+ * @param[out] sigma Array of size (at least) 2^PARAM_FFT receiving the ELP
  * @param[in] syndromes Array of size (at least) 2*PARAM_DELTA storing the syndromes
  */
 static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
     uint16_t deg_sigma = 0;
     uint16_t deg_sigma_p = 0;
     uint16_t deg_sigma_copy = 0;
-    uint16_t sigma_copy[PARAM_DELTA + 1] = {0};
-    uint16_t X_sigma_p[PARAM_DELTA + 1] = {0, 1};
+    uint16_t syndromes_rev[2 * PARAM_DELTA + 16] = {0};
     uint16_t pp = (uint16_t) -1; // 2*rho
     uint16_t d_p = 1;
     uint16_t d = syndromes[0];
@@ -295,19 +283,24 @@ static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
     uint16_t dd;
     uint16_t mu;
 
-    uint16_t i;
+    __m256i sigma256 = _mm256_setr_epi16(1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i X_sigma_p256 = _mm256_setr_epi16(0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i sigma_copy256, mask256, prod256, shifted256;
+    __m128i d128;
+
+    // syndromes_rev[2 * PARAM_DELTA - 1 - i] = syndromes[i], followed by zeros
+    for (size_t i = 0; i < 2 * PARAM_DELTA; ++i) {
+        syndromes_rev[2 * PARAM_DELTA - 1 - i] = syndromes[i];
+    }
 
-    sigma[0] = 1;
     for (mu = 0; (mu < (2 * PARAM_DELTA)); ++mu) {
         // Save sigma in case we need it to update X_sigma_p
-        memcpy(sigma_copy, sigma, 2 * (PARAM_DELTA));
+        sigma_copy256 = sigma256;
         deg_sigma_copy = deg_sigma;
 
+        // X_sigma_p has degree at most mu + 1 and no constant term
         dd = gf_mul(d, gf_inverse(d_p));
-
-        for (i = 1; (i <= mu + 1) && (i <= PARAM_DELTA); ++i) {
-            sigma[i] ^= gf_mul(dd, X_sigma_p[i]);
-        }
+        sigma256 ^= gf_mul_vect(_mm256_set1_epi16(dd), X_sigma_p256);
 
         deg_X = mu - pp;
         deg_X_sigma_p = deg_X + deg_sigma_p;
@@ -328,18 +321,25 @@ static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
 
         pp ^= mask12 & (mu ^ pp);
         d_p ^= mask12 & (d ^ d_p);
-        for (i = PARAM_DELTA; i; --i) {
-            X_sigma_p[i] = (mask12 & sigma_copy[i - 1]) ^ (~mask12 & X_sigma_p[i - 1]);
-        }
+
+        // X_sigma_p = X * (mask12 ? sigma_copy : X_sigma_p), truncated to PARAM_DELTA + 1 coefficients
+        mask256 = _mm256_set1_epi16(mask12);
+        shifted256 = _mm256_blendv_epi8(X_sigma_p256, sigma_copy256, mask256);
+        X_sigma_p256 = _mm256_alignr_epi8(shifted256, _mm256_permute2x128_si256(shifted256, shifted256, 0x08), 14);
 
         deg_sigma_p ^= mask12 & (deg_sigma_copy ^ deg_sigma_p);
-        d = syndromes[mu + 1];
 
-        for (i = 1; (i <= mu + 1) && (i <= PARAM_DELTA); ++i) {
-            d ^= gf_mul(sigma[i], syndromes[mu + 1 - i]);
-        }
+        // d = sum_{i=0}^{mu+1} sigma[i] * syndromes[mu + 1 - i], using sigma[0] = 1
+        prod256 = gf_mul_vect(sigma256, _mm256_loadu_si256((const __m256i *) (syndromes_rev + 2 * PARAM_DELTA - 2 - mu)));
+        d128 = _mm256_castsi256_si128(prod256) ^ _mm256_extracti128_si256(prod256, 1);
+        d128 ^= _mm_srli_si128(d128, 8);
+        d128 ^= _mm_srli_si128(d128, 4);
+        d128 ^= _mm_srli_si128(d128, 2);
+        d = (uint16_t) _mm_extract_epi16(d128, 0);
     }
 
+    _mm256_storeu_si256((__m256i *) sigma, sigma256);
+
     return deg_sigma;
 }
 
@@ -401,70 +401,80 @@ static void compute_z_poly(uint16_t *z, const uint16_t *sigma, uint16_t degree,
 /**
  * @brief Computes the error values
  *
- * See @cite lin1983error (Chapter 6 - BCH Codes) for more details.
+ * See @cite lin1983error (Chapter 6 - BCH Codes) for more details. <br>
+ * The PARAM_DELTA slots of beta_{j_i} and e_{j_i} live in the 16-bit lanes of a 256-bit register.
+ * Selecting the slot of each error position is a lane comparison with the broadcast counter,
+ * and the numerators and denominators of all the e_{j_i} are computed together with gf_mul_vect. <br>
+ * The inverses of the beta_{j_i} and of the denominators are each computed
+ * with a single simultaneous inversion (see gf_batch_inverse).
  *
- * @param[out] error_values Array of PARAM_DELTA elements receiving the error values
+ * @param[out] error_values Array of PARAM_N1 elements receiving the error values
  * @param[in] z Array of PARAM_DELTA + 1 elements storing the polynomial z(x)
- * @param[in] z_degree Integer that is the degree of polynomial z(x)
- * @param[in] error_compact Array of PARAM_DELTA + PARAM_N1 storing compact representation of the error
+ * @param[in] error Array of PARAM_N1 elements, error[i] != 0 if i is an error position
  */
 static void compute_error_values(uint16_t *error_values, const uint16_t *z, const uint8_t *error) {
-    uint16_t beta_j[PARAM_DELTA] = {0};
-    uint16_t e_j[PARAM_DELTA] = {0};
+    uint16_t beta_j[16] = {0};
+    uint16_t inverse[16] = {0};
+    uint16_t denominator[16] = {0};
+    uint16_t denominator_inverse[16] = {0};
 
     uint16_t delta_counter;
-    uint16_t delta_real_value;
-    uint16_t found;
     uint16_t mask1;
-    uint16_t mask2;
-    uint16_t tmp1;
-    uint16_t tmp2;
-    uint16_t inverse;
-    uint16_t inverse_power_j;
+
+    // Slot indexes, the extra lane never matches a counter value
+    const __m256i slots = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, -1);
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i beta256, inverse256, power256, numerator256, denominator256, factor256, e256, slot256;
+    __m128i e128;
 
     // Compute the beta_{j_i} page 31 of the documentation
+    beta256 = _mm256_setzero_si256();
     delta_counter = 0;
     for (size_t i = 0; i < PARAM_N1; i++) {
-        found = 0;
         mask1 = (uint16_t) (-((int32_t)error[i]) >> 31); // error[i] != 0
-        for (size_t j = 0; j < PARAM_DELTA; j++) {
-            mask2 = ~((uint16_t) (-((int32_t) j ^ delta_counter) >> 31)); // j == delta_counter
-            beta_j[j] += mask1 & mask2 & gf_exp[i];
-            found += mask1 & mask2 & 1;
-        }
-        delta_counter += found;
+        slot256 = _mm256_cmpeq_epi16(slots, _mm256_set1_epi16(delta_counter)) & _mm256_set1_epi16(mask1);
+        beta256 ^= slot256 & _mm256_set1_epi16(gf_exp[i]);
+        delta_counter += mask1 & 1 & ((uint16_t) (delta_counter - PARAM_DELTA) >> 15); // delta_counter < PARAM_DELTA
     }
-    delta_real_value = delta_counter;
 
     // Compute the e_{j_i} page 31 of the documentation
-    for (size_t i = 0; i < PARAM_DELTA; ++i) {
-        tmp1 = 1;
-        tmp2 = 1;
-        inverse = gf_inverse(beta_j[i]);
-        inverse_power_j = 1;
-
-        for (size_t j = 1; j <= PARAM_DELTA; ++j) {
-            inverse_power_j = gf_mul(inverse_power_j, inverse);
-            tmp1 ^= gf_mul(inverse_power_j, z[j]);
-        }
-        for (size_t k = 1; k < PARAM_DELTA; ++k) {
-            tmp2 = gf_mul(tmp2, (1 ^ gf_mul(inverse, beta_j[(i + k) % PARAM_DELTA])));
-        }
-        mask1 = (uint16_t) (((int16_t) i - delta_real_value) >> 15); // i < delta_real_value
-        e_j[i] = mask1 & gf_mul(tmp1, gf_inverse(tmp2));
+    _mm256_storeu_si256((__m256i *) beta_j, beta256);
+    gf_batch_inverse(inverse, beta_j, PARAM_DELTA);
+    inverse256 = _mm256_loadu_si256((const __m256i *) inverse);
+
+    numerator256 = one;
+    power256 = inverse256;
+    for (size_t j = 1; j <= PARAM_DELTA; ++j) {
+        numerator256 ^= gf_mul_vect(power256, _mm256_set1_epi16(z[j]));
+        power256 = gf_mul_vect(power256, inverse256);
+    }
+
+    denominator256 = one;
+    for (size_t k = 0; k < PARAM_DELTA; ++k) {
+        // Slot k contributes to every denominator but its own
+        factor256 = one ^ gf_mul_vect(inverse256, _mm256_set1_epi16(beta_j[k]));
+        factor256 = _mm256_blendv_epi8(factor256, one, _mm256_cmpeq_epi16(slots, _mm256_set1_epi16((int16_t) k)));
+        denominator256 = gf_mul_vect(denominator256, factor256);
     }
 
+    _mm256_storeu_si256((__m256i *) denominator, denominator256);
+    gf_batch_inverse(denominator_inverse, denominator, PARAM_DELTA);
+
+    // Keep the slots below the number of errors found
+    e256 = gf_mul_vect(numerator256, _mm256_loadu_si256((const __m256i *) denominator_inverse));
+    e256 &= _mm256_cmpgt_epi16(_mm256_set1_epi16(delta_counter), slots);
+
     // Place the delta e_{j_i} values at the right coordinates of the output vector
     delta_counter = 0;
     for (size_t i = 0; i < PARAM_N1; ++i) {
-        found = 0;
         mask1 = (uint16_t) (-((int32_t)error[i]) >> 31); // error[i] != 0
-        for (size_t j = 0; j < PARAM_DELTA; j++) {
-            mask2 = ~((uint16_t) (-((int32_t) j ^ delta_counter) >> 31)); // j == delta_counter
-            error_values[i] += mask1 & mask2 & e_j[j];
-            found += mask1 & mask2 & 1;
-        }
-        delta_counter += found;
+        slot256 = _mm256_cmpeq_epi16(slots, _mm256_set1_epi16(delta_counter)) & _mm256_set1_epi16(mask1) & e256;
+        e128 = _mm256_castsi256_si128(slot256) ^ _mm256_extracti128_si256(slot256, 1);
+        e128 ^= _mm_srli_si128(e128, 8);
+        e128 ^= _mm_srli_si128(e128, 4);
+        e128 ^= _mm_srli_si128(e128, 2);
+        error_values[i] = (uint16_t) _mm_extract_epi16(e128, 0);
+        delta_counter += mask1 & 1 & ((uint16_t) (delta_counter - PARAM_DELTA) >> 15); // delta_counter < PARAM_DELTA
     }
 }
 
@@ -504,13 +514,7 @@ static void correct_errors(uint8_t *cdw, const uint16_t *error_values) {
  */
 void reed_solomon_decode(uint64_t* msg, uint64_t* cdw, struct Trace_time* trace_time) {
     uint8_t cdw_bytes[PARAM_N1] = {0};
-    __m256i syndromes256[SYND_SIZE_256];
-    uint16_t *syndromes = (uint16_t *) syndromes256;
-    uint16_t sigma[1 << PARAM_FFT] = {0};
-    uint8_t error[1 << PARAM_M] = {0};
-    uint16_t z[PARAM_N1] = {0};
-    uint16_t error_values[PARAM_N1] = {0};
-    uint16_t deg;
+    __m256i syndromes8 = _mm256_setzero_si256();
     clock_t start, end;
 
     // Copy the vector in an array of bytes
@@ -518,10 +522,38 @@ void reed_solomon_decode(uint64_t* msg, uint64_t* cdw, struct Trace_time* trace_
 
     // Calculate the 2*PARAM_DELTA syndromes
     start = clock();
-    compute_syndromes(syndromes256, cdw_bytes);
+    reed_solomon_syndromes_update(&syndromes8, cdw_bytes, 0, PARAM_N1);
     end = clock();
     trace_time->compute_syndromes_time += ((uint32_t)(end - start));
 
+    reed_solomon_decode_syndromes(msg, cdw_bytes, syndromes8, trace_time);
+}
+
+
+
+/**
+ * @brief Decodes the received word from its syndromes
+ *
+ * Steps two to six of reed_solomon_decode(), for callers that accumulated the syndromes
+ * with reed_solomon_syndromes_update() while producing the received word.
+ *
+ * @param[out] msg Array of size VEC_K_SIZE_64 receiving the decoded message
+ * @param[in,out] cdw_bytes Array of size PARAM_N1 storing the received word, corrected in place
+ * @param[in] syndromes8 The 2 * PARAM_DELTA syndromes of cdw_bytes in 8-bit lanes
+ */
+void reed_solomon_decode_syndromes(uint64_t* msg, uint8_t* cdw_bytes, __m256i syndromes8, struct Trace_time* trace_time) {
+    uint16_t syndromes[16 * SYND_SIZE_256];
+    uint16_t sigma[1 << PARAM_FFT] = {0};
+    uint8_t error[1 << PARAM_M] = {0};
+    uint16_t z[PARAM_N1] = {0};
+    uint16_t error_values[PARAM_N1] = {0};
+    uint16_t deg;
+    clock_t start, end;
+
+    // Widen the syndromes to 16-bit lanes, lanes 2 * PARAM_DELTA and above are never read
+    _mm256_storeu_si256((__m256i *) syndromes, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(syndromes8)));
+    _mm256_storeu_si256((__m256i *) (syndromes + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(syndromes8, 1)));
+
     // Compute the error locator polynomial sigma
     // Sigma's degree is at most PARAM_DELTA but the FFT requires the extra room
     start = clock();
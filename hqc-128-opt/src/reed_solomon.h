@@ -10,10 +10,13 @@
 #include "profiling.h"
 #include <stddef.h>
 #include <stdint.h>
+#include <immintrin.h>
 
 
 void reed_solomon_encode(uint64_t *cdw, const uint64_t *msg);
 void reed_solomon_decode(uint64_t *msg, uint64_t *cdw, struct Trace_time* trace_time);
+void reed_solomon_syndromes_update(__m256i *syndromes8, const uint8_t *cdw, size_t first, size_t count);
+void reed_solomon_decode_syndromes(uint64_t *msg, uint8_t *cdw, __m256i syndromes8, struct Trace_time* trace_time);
 
 void compute_generator_poly(uint16_t *poly);
 
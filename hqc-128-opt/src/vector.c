@@ -13,43 +13,312 @@
 
 #define SHBIT32 46
 
+// scatter_support() sorts the support padded to SORT_SIZE keys,
+// then merges it with the VEC_N_SIZE_64 word markers padded to MERGE_SIZE - SORT_SIZE keys
+#define SORT_SIZE 128
+#define MERGE_SIZE 512
+#define SCAN_SIZE (CEIL_DIVIDE(VEC_N_SIZE_64 + PARAM_OMEGA_R, 4) * 4)
+
+// key of a position: (word << 7) | bit, key of the marker of a word: (word << 7) | 64
+#define MARKER_BIT 64
+// bigger than every key, not a marker and in no word of the vector
+#define SENTINEL_KEY (INT32_MAX ^ MARKER_BIT)
+
+#if PARAM_OMEGA_R > SORT_SIZE || SORT_SIZE + VEC_N_SIZE_64 > MERGE_SIZE || SCAN_SIZE > MERGE_SIZE
+#error "SORT_SIZE and MERGE_SIZE are too small for the parameters"
+#endif
+
 static uint64_t v_val[PARAM_OMEGA_R] = {3982610457, 3982835871, 3983061310, 3983286775, 3983512265, 3983737781, 3983963323, 3984188890, 3984414482, 3984640100, 3984865744, 3985091413, 3985317108, 3985542828, 3985768574, 3985994345, 3986220142, 3986445965, 3986671813, 3986897687, 3987123586, 3987349511, 3987575461, 3987801438, 3988027439, 3988253467, 3988479520, 3988705599, 3988931703, 3989157833, 3989383988, 3989610169, 3989836376, 3990062609, 3990288867, 3990515151, 3990741460, 3990967795, 3991194156, 3991420543, 3991646955, 3991873393, 3992099856, 3992326346, 3992552861, 3992779401, 3993005968, 3993232560, 3993459178, 3993685821, 3993912490, 3994139185, 3994365906, 3994592653, 3994819425, 3995046223, 3995273047, 3995499896, 3995726771, 3995953672, 3996180599, 3996407552, 3996634530, 3996861534, 3997088564, 3997315620, 3997542701, 3997769808, 3997996942, 3998224101, 3998451285, 3998678496, 3998905732, 3999132994, 3999360282};
 
 static inline uint16_t barrett_reduce(uint32_t a, uint16_t i);
 
-static inline uint32_t compare_u32(const uint32_t v1, const uint32_t v2);
+static inline uint32_t contains_u32(const uint32_t *support, size_t first, size_t last, uint32_t value);
+static inline void minmax_epi32(__m256i *a, __m256i *b);
+static inline __m256i reverse_epi32(__m256i x);
+static inline __m256i bitonic_merge8(__m256i x);
+static inline __m256i bitonic_sort8(__m256i x);
+static void bitonic_merge(__m256i *x, size_t n);
+static void bitonic_sort(__m256i *x, size_t n);
+static void scatter_support(__m256i *v256, const uint32_t *support, uint16_t weight);
 
 /**
  * @brief Constant-time Barret reduction
  *
+ * The estimated quotient is either the quotient or one less (for a few multiples of PARAM_N - i
+ * close to 2^32), so PARAM_N - i is subtracted once more when the remainder is not reduced.
+ *
  * @param[in] a An integer to be reduced 
  * @param[in] i An array index
  * @return an integer equal to a % (PARAM_N - i)
  */
 static inline uint16_t barrett_reduce(uint32_t a, uint16_t i) {
-    uint32_t t;
+    uint32_t d = PARAM_N - i;
+    uint32_t t, r, mask;
 
     t = ((v_val[i] * a + v_val[i]) >> SHBIT32);
-    t *= (PARAM_N - i);
-    return (uint16_t)(a - t);
+    r = a - t * d - d;
+    mask = -(r >> 31);
+    return (uint16_t)(r + (d & mask));
+}
+
+
+
+/**
+ * @brief Constant-time search of a value in a range of the support
+ *
+ * Compares value with 8 entries per instruction. The range is read by blocks of 8 entries
+ * so support must hold 7 entries past last that never equal value.
+ * The number of loads only depends on first and last.
+ *
+ * @returns 1 if one of support[first], ..., support[last - 1] is equal to value and 0 otherwise
+ * @param[in] support Array of positions padded with 7 sentinels
+ * @param[in] first Index of the first entry of the range
+ * @param[in] last Index past the last entry of the range
+ * @param[in] value The value to search
+ */
+static inline uint32_t contains_u32(const uint32_t *support, size_t first, size_t last, uint32_t value) {
+    __m256i value256 = _mm256_set1_epi32(value);
+    __m256i found256 = _mm256_setzero_si256();
+
+    for (size_t j = first; j < last; j += 8) {
+        found256 |= _mm256_cmpeq_epi32(_mm256_loadu_si256((__m256i *) &support[j]), value256);
+    }
+
+    return 1 ^ _mm256_testz_si256(found256, found256);
+}
+
+
+/**
+ * @brief Sorts the 32-bit lanes of two registers
+ *
+ * @param[in,out] a Register receiving the lane-wise minimum
+ * @param[in,out] b Register receiving the lane-wise maximum
+ */
+static inline void minmax_epi32(__m256i *a, __m256i *b) {
+    __m256i min = _mm256_min_epi32(*a, *b);
+    *b = _mm256_max_epi32(*a, *b);
+    *a = min;
+}
+
+
+
+/**
+ * @brief Reverses the order of the 32-bit lanes of a register
+ *
+ * @returns the register whose lane i is lane 7 - i of x
+ * @param[in] x A register
+ */
+static inline __m256i reverse_epi32(__m256i x) {
+    return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+
+
+/**
+ * @brief Sorts a bitonic register
+ *
+ * Half-cleaners of distance 4, 2 and 1 between the 32-bit lanes.
+ *
+ * @returns the 8 lanes of x in increasing order
+ * @param[in] x A register whose lanes form a bitonic sequence
+ */
+static inline __m256i bitonic_merge8(__m256i x) {
+    __m256i y;
+
+    y = _mm256_permute2x128_si256(x, x, 0x01);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xF0);
+    y = _mm256_shuffle_epi32(x, 0x4E);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+    return x;
 }
 
 
 
 /**
- * @brief Constant-time comparison of two integers v1 and v2
+ * @brief Sorts a register
  *
- * Returns 1 if v1 is equal to v2 and 0 otherwise
- * https://gist.github.com/sneves/10845247
+ * Bitonic sorting network where the first stage of each merge compares lane i with its mirror,
+ * so that all the following half-cleaners sort in increasing order.
  *
- * @param[in] v1 
- * @param[in] v2 
+ * @returns the 8 lanes of x in increasing order
+ * @param[in] x A register
  */
-static inline uint32_t compare_u32(const uint32_t v1, const uint32_t v2) {
-    return 1 ^ (((v1 - v2)|(v2 - v1)) >> 31);
+static inline __m256i bitonic_sort8(__m256i x) {
+    __m256i y;
+
+    // blocks of 2: i and i ^ 1
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+
+    // blocks of 4: i and i ^ 3, then distance 1
+    y = _mm256_shuffle_epi32(x, 0x1B);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+
+    // blocks of 8: i and i ^ 7, then distances 2 and 1
+    y = reverse_epi32(x);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xF0);
+    y = _mm256_shuffle_epi32(x, 0x4E);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+    return x;
 }
 
 
+
+/**
+ * @brief Sorts a bitonic sequence of n registers
+ *
+ * @param[in,out] x Array of n registers whose 8 * n lanes form a bitonic sequence
+ * @param[in] n Number of registers, a power of 2
+ */
+static void bitonic_merge(__m256i *x, size_t n) {
+    for (size_t j = n >> 1; j > 0; j >>= 1) {
+        for (size_t i = 0; i < n; i += 2 * j) {
+            for (size_t t = 0; t < j; t++) {
+                minmax_epi32(&x[i + t], &x[i + t + j]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        x[i] = bitonic_merge8(x[i]);
+    }
+}
+
+
+
+/**
+ * @brief Sorts n registers
+ *
+ * Same network as bitonic_sort8(), on registers: each merge of two sorted blocks
+ * compares lane i with its mirror then sorts both bitonic halves.
+ *
+ * @param[in,out] x Array of n registers whose 8 * n lanes are sorted in increasing order
+ * @param[in] n Number of registers, a power of 2
+ */
+static void bitonic_sort(__m256i *x, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = bitonic_sort8(x[i]);
+    }
+
+    for (size_t k = 2; k <= n; k <<= 1) {
+        for (size_t i = 0; i < n; i += k) {
+            for (size_t t = 0; t < k / 2; t++) {
+                __m256i mirror = reverse_epi32(x[i + k - 1 - t]);
+                minmax_epi32(&x[i + t], &mirror);
+                x[i + k - 1 - t] = reverse_epi32(mirror);
+            }
+            bitonic_merge(&x[i], k / 2);
+            bitonic_merge(&x[i + k / 2], k / 2);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Adds to v256 the vector of support
+ *
+ * Constant-time scatter whose cost grows with (VEC_N_SIZE_64 + weight) log(VEC_N_SIZE_64 + weight)
+ * instead of VEC_N_SIZE_64 * weight, without any secret-dependent address:
+ *  - the positions are sorted as keys (word << 7) | bit,
+ *  - they are merged with one marker (word << 7) | 64 per word, so that each marker follows the positions of its word,
+ *  - a segmented OR scan gives to each marker the word made of the positions before it,
+ *  - the markers are compacted in place: the marker of word i, with c positions before it,
+ *    moves down by c in one pass per bit of c (no two markers collide since c does not decrease with i).
+ *
+ * @param[in,out] v256 Vector of VEC_N_256_SIZE_64 words to which the positions are added
+ * @param[in] support Array of weight distinct positions below PARAM_N
+ * @param[in] weight Integer that is the Hamming weight
+ */
+static void scatter_support(__m256i *v256, const uint32_t *support, uint16_t weight) {
+    __m256i keys256[MERGE_SIZE / 8];
+    int32_t keys[MERGE_SIZE] __attribute__((aligned(32)));
+    uint64_t words[SCAN_SIZE + SORT_SIZE] __attribute__((aligned(32)));
+    uint64_t shifts[SCAN_SIZE + SORT_SIZE] __attribute__((aligned(32)));
+    __m256i word_index = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i carry = _mm256_setzero_si256();
+    __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i marker_bit = _mm256_set1_epi64x(MARKER_BIT);
+
+    for (size_t i = 0; i < SORT_SIZE; i++) {
+        keys[i] = (i < weight) ? (int32_t) (support[i] + (support[i] & ~0x3fU)) : SENTINEL_KEY;
+    }
+    for (size_t i = 0; i < SORT_SIZE / 8; i++) {
+        keys256[i] = _mm256_load_si256((__m256i *) &keys[8 * i]);
+    }
+    bitonic_sort(keys256, SORT_SIZE / 8);
+
+    // markers in decreasing order after the sorted positions form a bitonic sequence
+    for (size_t i = MERGE_SIZE / 8; i-- > SORT_SIZE / 8;) {
+        __m256i marker = _mm256_or_si256(_mm256_slli_epi32(word_index, 7), _mm256_set1_epi32(MARKER_BIT));
+        __m256i in_vector = _mm256_cmpgt_epi32(_mm256_set1_epi32(VEC_N_SIZE_64), word_index);
+        keys256[i] = _mm256_blendv_epi8(_mm256_set1_epi32(SENTINEL_KEY), marker, in_vector);
+        word_index = _mm256_add_epi32(word_index, _mm256_set1_epi32(8));
+    }
+    bitonic_merge(keys256, MERGE_SIZE / 8);
+
+    for (size_t i = 0; i < MERGE_SIZE / 8; i++) {
+        _mm256_store_si256((__m256i *) &keys[8 * i], keys256[i]);
+    }
+
+    // segmented OR scan, 4 keys at a time: a marker ends a segment
+    for (size_t k = 0; k < SCAN_SIZE; k += 4) {
+        __m256i key = _mm256_cvtepi32_epi64(_mm_load_si128((__m128i *) &keys[k]));
+        __m256i marker = _mm256_cmpeq_epi64(key & marker_bit, marker_bit);
+        __m256i word = _mm256_andnot_si256(marker, _mm256_sllv_epi64(_mm256_set1_epi64x(1), key & _mm256_set1_epi64x(0x3f)));
+        // markers among the previous 1 then 2 keys of the register
+        __m256i cut = _mm256_blend_epi32(_mm256_permute4x64_epi64(marker, 0x90), _mm256_setzero_si256(), 0x03);
+
+        word |= _mm256_andnot_si256(cut, _mm256_blend_epi32(_mm256_permute4x64_epi64(word, 0x90), _mm256_setzero_si256(), 0x03));
+        cut |= _mm256_blend_epi32(_mm256_permute4x64_epi64(cut, 0x90), _mm256_setzero_si256(), 0x03);
+        word |= _mm256_andnot_si256(cut, _mm256_permute2x128_si256(word, word, 0x08));
+        cut |= _mm256_permute2x128_si256(cut, cut, 0x08);
+        word |= _mm256_andnot_si256(cut, carry);
+
+        _mm256_store_si256((__m256i *) &words[k], word);
+        _mm256_store_si256((__m256i *) &shifts[k], marker & _mm256_sub_epi64(index, _mm256_srli_epi64(key, 7)));
+        carry = _mm256_permute4x64_epi64(_mm256_andnot_si256(marker, word), 0xFF);
+        index = _mm256_add_epi64(index, _mm256_set1_epi64x(4));
+    }
+
+    // the compaction reads up to weight keys past SCAN_SIZE
+    for (size_t k = SCAN_SIZE; k < SCAN_SIZE + SORT_SIZE; k++) {
+        words[k] = 0;
+        shifts[k] = 0;
+    }
+
+    // compaction, k receives k + b when the remaining shift of k + b has the bit b
+    for (uint64_t b = 1; b <= weight; b <<= 1) {
+        const __m256i b256 = _mm256_set1_epi64x(b);
+        for (size_t k = 0; k < SCAN_SIZE; k += 4) {
+            __m256i shift_in = _mm256_loadu_si256((__m256i *) &shifts[k + b]);
+            __m256i shift_own = _mm256_load_si256((__m256i *) &shifts[k]);
+            __m256i word_in = _mm256_loadu_si256((__m256i *) &words[k + b]);
+            __m256i word_own = _mm256_load_si256((__m256i *) &words[k]);
+            __m256i move_in = _mm256_cmpeq_epi64(shift_in & b256, b256);
+            __m256i move_out = _mm256_cmpeq_epi64(shift_own & b256, b256);
+
+            _mm256_store_si256((__m256i *) &words[k], (move_in & word_in) | _mm256_andnot_si256(move_in, word_own));
+            _mm256_store_si256((__m256i *) &shifts[k], (move_in & (shift_in ^ b256)) | _mm256_andnot_si256(move_in | move_out, shift_own));
+        }
+    }
+
+    for (size_t i = VEC_N_SIZE_64; i < 4 * LOOP_SIZE; i++) {
+        words[i] = 0;
+    }
+    for (size_t i = 0; i < LOOP_SIZE; i++) {
+        _mm256_storeu_si256(&v256[i], v256[i] ^ _mm256_load_si256((__m256i *) &words[4 * i]));
+    }
+}
+
+
+
 /**
  * @brief Generates a vector of a given Hamming weight
  *
@@ -61,10 +330,7 @@ static inline uint32_t compare_u32(const uint32_t v1, const uint32_t v2) {
  */
 void vect_set_random_fixed_weight(seedexpander_state *ctx, __m256i *v256, uint16_t weight) {
     uint32_t rand_u32[PARAM_OMEGA_R] = {0};
-    uint32_t tmp[PARAM_OMEGA_R] = {0};
-    __m256i bit256[PARAM_OMEGA_R];
-    __m256i bloc256[PARAM_OMEGA_R];
-    static __m256i posCmp256 = (__m256i){0UL,1UL,2UL,3UL};
+    uint32_t tmp[PARAM_OMEGA_R + 7] = {0};
 
     seedexpander(ctx, (uint8_t *)&rand_u32, 4 * weight);
 
@@ -72,40 +338,18 @@ void vect_set_random_fixed_weight(seedexpander_state *ctx, __m256i *v256, uint16
         tmp[i] = i + barrett_reduce(rand_u32[i], i);
     }
 
-    for (int32_t i = (weight - 1); i -- > 0;) {
-        uint32_t found = 0;
-
-        for (size_t j = i + 1; j < weight; ++j) {
-            found |= compare_u32(tmp[j], tmp[i]);
-        }
+    // positions are below PARAM_N, so these sentinels never match in contains_u32()
+    for (size_t i = weight; i < weight + 7U; ++i) {
+        tmp[i] = UINT32_MAX;
+    }
 
+    for (int32_t i = (weight - 1); i -- > 0;) {
+        uint32_t found = contains_u32(tmp, i + 1, weight, tmp[i]);
         uint32_t mask = -found;
         tmp[i] = (mask & i) ^ (~mask & tmp[i]);
     }
 
-    for (uint32_t i = 0 ; i < weight ; i++) {
-        // we store the bloc number and bit position of each vb[i]
-        uint64_t bloc = tmp[i] >> 6;
-        bloc256[i] = _mm256_set1_epi64x(bloc >> 2);
-        uint64_t pos = (bloc & 0x3UL);
-        __m256i pos256 = _mm256_set1_epi64x(pos);
-        __m256i mask256 = _mm256_cmpeq_epi64(pos256,posCmp256);
-        uint64_t bit64 = 1ULL << (tmp[i] & 0x3f);
-        __m256i bl256 = _mm256_set1_epi64x(bit64);
-        bit256[i] = bl256&mask256;
-    }
-
-    for (uint32_t i = 0 ; i < LOOP_SIZE ; i++) {
-        __m256i aux = _mm256_setzero_si256();
-        __m256i i256 = _mm256_set1_epi64x(i);
-
-        for (uint32_t j = 0 ; j < weight ; j++) {
-            __m256i mask256 = _mm256_cmpeq_epi64(bloc256[j],i256);
-            aux ^= bit256[j] & mask256;
-        }
-
-        _mm256_storeu_si256(&v256[i], _mm256_xor_si256(v256[i],aux));
-    }
+    scatter_support(v256, tmp, weight);
 
     #undef LOOP_SIZE
 }
@@ -17,6 +17,7 @@
 // Without this constraint, CRYPTO_SECRETKEYBYTES would be defined as 32
 
 int crypto_kem_keypair(unsigned char* pk, unsigned char* sk, Trace_time* keygen_time);
+int crypto_kem_keypair(unsigned char* pk, unsigned char* sk);
 int crypto_kem_enc(unsigned char* ct, unsigned char* ss, const unsigned char* pk, Trace_time* encap_time);
 int crypto_kem_enc(unsigned char* ct, unsigned char* ss, const unsigned char* pk);
 int crypto_kem_dec(unsigned char* ss, const unsigned char* ct, const unsigned char* sk, Trace_time* decap_time);
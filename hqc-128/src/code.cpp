@@ -6,6 +6,7 @@
 #include "code.h"
 #include "reed_muller.h"
 #include "reed_solomon.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include <stdint.h>
 #include <string.h>
@@ -26,35 +27,81 @@
  * @param[out] em Pointer to an array that is the tensor code word
  * @param[in] m Pointer to an array that is the message
  */
+template <class P>
 void code_encode(uint64_t *em, const uint64_t *m, Trace_time* common_time) {
-    uint64_t tmp[VEC_N1_SIZE_64] = {0};
+    uint64_t tmp[P::vec_n1_size_64] = {0};
     clock_t start, end;
 
-    start = clock();
-    reed_solomon_encode(tmp, m);
-    end = clock();
+    start = trace_start(common_time, TRACE_RS_ENCODE);
+    reed_solomon_encode<P>(tmp, m);
+    end = trace_stop(common_time, TRACE_RS_ENCODE);
     common_time->rs_encode_time += ((uint32_t)(end - start));
 
-    start = clock();
-    reed_muller_encode(em, tmp);
-    end = clock();
+    start = trace_start(common_time, TRACE_RM_ENCODE);
+    reed_muller_encode<P>(em, tmp);
+    end = trace_stop(common_time, TRACE_RM_ENCODE);
     common_time->rm_encode_time += ((uint32_t)(end - start));
 
     #ifdef VERBOSE
-        printf("\n\nReed-Solomon code word: "); vect_print(tmp, VEC_N1_SIZE_BYTES);
-        printf("\n\nConcatenated code word: "); vect_print(em, VEC_N1N2_SIZE_BYTES);
+        printf("\n\nReed-Solomon code word: "); vect_print<P>(tmp, P::vec_n1_size_bytes);
+        printf("\n\nConcatenated code word: "); vect_print<P>(em, P::vec_n1n2_size_bytes);
     #endif
 }
 
+template <class P>
 void code_encode(uint64_t *em, const uint64_t *m) {
-    uint64_t tmp[VEC_N1_SIZE_64] = {0};
+    uint64_t tmp[P::vec_n1_size_64] = {0};
 
-    reed_solomon_encode(tmp, m);
-    reed_muller_encode(em, tmp);
+    reed_solomon_encode<P>(tmp, m);
+    reed_muller_encode<P>(em, tmp);
 
     #ifdef VERBOSE
-        printf("\n\nReed-Solomon code word: "); vect_print(tmp, VEC_N1_SIZE_BYTES);
-        printf("\n\nConcatenated code word: "); vect_print(em, VEC_N1N2_SIZE_BYTES);
+        printf("\n\nReed-Solomon code word: "); vect_print<P>(tmp, P::vec_n1_size_bytes);
+        printf("\n\nConcatenated code word: "); vect_print<P>(em, P::vec_n1n2_size_bytes);
+    #endif
+}
+
+
+
+/**
+ *
+ * @brief Adding the encoding of the message m to the vector v using the concatenated code
+ *
+ * The Reed-Muller code words are XORed into v block by block as they are produced,
+ * so that no intermediate concatenated code word is needed.
+ *
+ * @param[in,out] v Pointer to an array of P::vec_n1n2_size_64 words to which the tensor code word is added
+ * @param[in] m Pointer to an array that is the message
+ */
+template <class P>
+void code_encode_xor(uint64_t *v, const uint64_t *m, Trace_time* common_time) {
+    uint64_t tmp[P::vec_n1_size_64] = {0};
+    clock_t start, end;
+
+    start = trace_start(common_time, TRACE_RS_ENCODE);
+    reed_solomon_encode<P>(tmp, m);
+    end = trace_stop(common_time, TRACE_RS_ENCODE);
+    common_time->rs_encode_time += ((uint32_t)(end - start));
+
+    start = trace_start(common_time, TRACE_RM_ENCODE);
+    reed_muller_encode_xor<P>(v, tmp);
+    end = trace_stop(common_time, TRACE_RM_ENCODE);
+    common_time->rm_encode_time += ((uint32_t)(end - start));
+
+    #ifdef VERBOSE
+        printf("\n\nReed-Solomon code word: "); vect_print<P>(tmp, P::vec_n1_size_bytes);
+    #endif
+}
+
+template <class P>
+void code_encode_xor(uint64_t *v, const uint64_t *m) {
+    uint64_t tmp[P::vec_n1_size_64] = {0};
+
+    reed_solomon_encode<P>(tmp, m);
+    reed_muller_encode_xor<P>(v, tmp);
+
+    #ifdef VERBOSE
+        printf("\n\nReed-Solomon code word: "); vect_print<P>(tmp, P::vec_n1_size_bytes);
     #endif
 }
 
@@ -66,34 +113,48 @@ void code_encode(uint64_t *em, const uint64_t *m) {
  * @param[out] m Pointer to an array that is the message
  * @param[in] em Pointer to an array that is the code word
  */
+template <class P>
 void code_decode(uint64_t *m, const uint64_t *em, Trace_time* common_time) {
-    uint64_t tmp[VEC_N1_SIZE_64] = {0};
+    uint64_t tmp[P::vec_n1_size_64] = {0};
     clock_t start, end;
     
-    start = clock();
-    reed_muller_decode(tmp, em);
-    end = clock();
+    start = trace_start(common_time, TRACE_RM_DECODE);
+    reed_muller_decode<P>(tmp, em);
+    end = trace_stop(common_time, TRACE_RM_DECODE);
     common_time->rm_decode_time += ((uint32_t)(end - start));
 
-    start = clock();
-    reed_solomon_decode(m, tmp, common_time);
-    end = clock();
+    start = trace_start(common_time, TRACE_RS_DECODE);
+    reed_solomon_decode<P>(m, tmp, common_time);
+    end = trace_stop(common_time, TRACE_RS_DECODE);
     common_time->rs_decode_time += ((uint32_t)(end - start));
 
 
     #ifdef VERBOSE
-        printf("\n\nReed-Muller decoding result (the input for the Reed-Solomon decoding algorithm): "); vect_print(tmp, VEC_N1_SIZE_BYTES);
+        printf("\n\nReed-Muller decoding result (the input for the Reed-Solomon decoding algorithm): "); vect_print<P>(tmp, P::vec_n1_size_bytes);
     #endif
 }
 
+template <class P>
 void code_decode(uint64_t *m, const uint64_t *em) {
-    uint64_t tmp[VEC_N1_SIZE_64] = {0};
+    uint64_t tmp[P::vec_n1_size_64] = {0};
     
-    reed_muller_decode(tmp, em);
-    reed_solomon_decode(m, tmp);
+    reed_muller_decode<P>(tmp, em);
+    reed_solomon_decode<P>(m, tmp);
 
 
     #ifdef VERBOSE
-        printf("\n\nReed-Muller decoding result (the input for the Reed-Solomon decoding algorithm): "); vect_print(tmp, VEC_N1_SIZE_BYTES);
+        printf("\n\nReed-Muller decoding result (the input for the Reed-Solomon decoding algorithm): "); vect_print<P>(tmp, P::vec_n1_size_bytes);
     #endif
 }
+
+
+
+#define INSTANTIATE_CODE(P) \
+    template void code_encode<P>(uint64_t *, const uint64_t *, Trace_time *); \
+    template void code_encode<P>(uint64_t *, const uint64_t *); \
+    template void code_encode_xor<P>(uint64_t *, const uint64_t *, Trace_time *); \
+    template void code_encode_xor<P>(uint64_t *, const uint64_t *); \
+    template void code_decode<P>(uint64_t *, const uint64_t *, Trace_time *); \
+    template void code_decode<P>(uint64_t *, const uint64_t *);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_CODE)
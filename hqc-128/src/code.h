@@ -6,13 +6,16 @@
  * @brief Header file of code.cpp
  */
 
+#include "parameter_set.h"
 #include "parameters.h"
 #include <stddef.h>
 #include <stdint.h>
 
-void code_encode(uint64_t *codeword, const uint64_t *message, Trace_time* common_time);
-void code_encode(uint64_t *codeword, const uint64_t *message);
-void code_decode(uint64_t *message, const uint64_t *vector, Trace_time* common_time);
-void code_decode(uint64_t *message, const uint64_t *vector);
+template <class P> void code_encode(uint64_t *codeword, const uint64_t *message, Trace_time* common_time);
+template <class P> void code_encode(uint64_t *codeword, const uint64_t *message);
+template <class P> void code_encode_xor(uint64_t *vector, const uint64_t *message, Trace_time* common_time);
+template <class P> void code_encode_xor(uint64_t *vector, const uint64_t *message);
+template <class P> void code_decode(uint64_t *message, const uint64_t *vector, Trace_time* common_time);
+template <class P> void code_decode(uint64_t *message, const uint64_t *vector);
 
 #endif
@@ -0,0 +1,24 @@
+/**
+ * @file cpu_features.cpp
+ * @brief Runtime selection between the portable and the vectorized kernels
+ */
+
+#include "cpu_features.h"
+
+
+/**
+ * @brief Checks whether the vectorized kernels can run on this CPU
+ *
+ * The CPUID query is done once and cached.
+ * Compiling with -D HQC_PORTABLE forces the portable kernels, for instance to compare both paths.
+ *
+ * @returns true if the CPU supports both AVX2 and PCLMULQDQ
+ */
+bool cpu_supports_avx2(void) {
+#ifdef HQC_PORTABLE
+    return false;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul");
+    return supported;
+#endif
+}
@@ -0,0 +1,18 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * @file cpu_features.h
+ * @brief Header file of cpu_features.cpp
+ */
+
+/**
+ * Enables the AVX2 and PCLMULQDQ instruction sets for a single function.
+ * The rest of the library is compiled for the default target, so every
+ * function carrying this attribute must only be reached after cpu_supports_avx2().
+ */
+#define HQC_TARGET_AVX2 __attribute__((target("avx2,pclmul")))
+
+bool cpu_supports_avx2(void);
+
+#endif
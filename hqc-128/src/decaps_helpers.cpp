@@ -0,0 +1,215 @@
+/**
+ * @file decaps_helpers.cpp
+ * @brief Implementation of the helper threads of decaps_helpers.h
+ */
+
+#include "decaps_helpers.h"
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define SPINS_BEFORE_YIELD (1 << 12)
+#define SPINS_BEFORE_PARK (1 << 12)
+
+struct alignas(64) Decaps_helpers::Mailbox {
+    std::atomic<uint32_t> posted{0};
+    std::atomic<uint32_t> finished{0};
+    std::atomic<bool> parked{false};
+    void (*task)(void *) = nullptr;
+    void *context = nullptr;
+    std::mutex park_lock;
+    std::condition_variable wake;
+    Decaps_helpers *owner = nullptr;
+    unsigned int self = 0;
+    pthread_t thread;
+};
+
+static inline void spin_pause(uint32_t *spins);
+
+
+/**
+ * @brief Backs off while polling an atomic, first with a pause then by yielding the CPU
+ *
+ * @param[in,out] spins Number of polls done so far
+ */
+static inline void spin_pause(uint32_t *spins) {
+    if (*spins < SPINS_BEFORE_YIELD) {
+        (*spins)++;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+
+
+/**
+ * @brief Starts the helper threads
+ *
+ * Each helper is created with its CPU affinity already set, so it never runs elsewhere.
+ * Pinning is best effort: when the CPU cannot be selected the helper is started unpinned.
+ * If a thread cannot be created at all, the helpers from this one on are left out and
+ * their tasks run inline.
+ *
+ * @param[in] helpers Number of helper threads
+ * @param[in] first_cpu CPU of the first helper, the next ones take the following CPUs; -1 disables pinning
+ */
+Decaps_helpers::Decaps_helpers(unsigned int helpers, int first_cpu) : count(0), mailboxes(new Mailbox[helpers]) {
+    unsigned int cpus = std::thread::hardware_concurrency();
+
+    for (unsigned int i = 0; i < helpers; i++) {
+        Mailbox& mailbox = mailboxes[i];
+        mailbox.owner = this;
+        mailbox.self = i;
+
+        int status = -1;
+        if (first_cpu >= 0 && cpus != 0) {
+            pthread_attr_t attributes;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET((first_cpu + i) % cpus, &set);
+            pthread_attr_init(&attributes);
+            if (pthread_attr_setaffinity_np(&attributes, sizeof(set), &set) == 0) {
+                status = pthread_create(&mailbox.thread, &attributes, &Decaps_helpers::start, &mailbox);
+            }
+            pthread_attr_destroy(&attributes);
+        }
+        if (status != 0) {
+            status = pthread_create(&mailbox.thread, nullptr, &Decaps_helpers::start, &mailbox);
+        }
+        if (status != 0) {
+            break;
+        }
+        count++;
+    }
+}
+
+
+
+/**
+ * @brief Stops the helper threads by posting them an empty task
+ */
+Decaps_helpers::~Decaps_helpers() {
+    for (unsigned int i = 0; i < count; i++) {
+        post(i, nullptr, nullptr);
+        pthread_join(mailboxes[i].thread, nullptr);
+    }
+}
+
+
+
+/**
+ * @brief Hands a task to a helper, or runs it right away if the helper does not exist
+ *
+ * The previous task of the helper must have been waited for. A parked helper is woken up;
+ * the sequence number and the parked flag are sequentially consistent, so either the
+ * helper sees the task before parking or the caller sees it parked.
+ *
+ * @param[in] helper Index of the helper
+ * @param[in] task Function to run
+ * @param[in] context Argument of the function
+ */
+void Decaps_helpers::post(unsigned int helper, void (*task)(void *), void *context) {
+    if (helper >= count) {
+        task(context);
+        return;
+    }
+
+    Mailbox& mailbox = mailboxes[helper];
+    mailbox.task = task;
+    mailbox.context = context;
+    mailbox.posted.store(mailbox.posted.load(std::memory_order_relaxed) + 1);
+
+    if (mailbox.parked.load()) {
+        { std::lock_guard<std::mutex> guard(mailbox.park_lock); }
+        mailbox.wake.notify_one();
+    }
+}
+
+
+
+/**
+ * @brief Waits until a helper has finished its last task
+ *
+ * @param[in] helper Index of the helper
+ */
+void Decaps_helpers::wait(unsigned int helper) {
+    if (helper >= count) {
+        return;
+    }
+
+    Mailbox& mailbox = mailboxes[helper];
+    uint32_t target = mailbox.posted.load(std::memory_order_relaxed);
+    uint32_t spins = 0;
+    while (mailbox.finished.load(std::memory_order_acquire) != target) {
+        spin_pause(&spins);
+    }
+}
+
+
+
+/**
+ * @returns Number of helper threads
+ */
+unsigned int Decaps_helpers::helper_count() const {
+    return count;
+}
+
+
+
+/**
+ * @brief Entry point of a helper thread
+ *
+ * @param[in] mailbox Mailbox of the helper
+ * @returns nullptr
+ */
+void *Decaps_helpers::start(void *mailbox) {
+    Mailbox *box = (Mailbox *) mailbox;
+    box->owner->run(box->self);
+    return nullptr;
+}
+
+
+
+/**
+ * @brief Main loop of a helper: runs each posted task and acknowledges it
+ *
+ * The helper polls its mailbox for SPINS_BEFORE_PARK rounds, then parks until the next post.
+ *
+ * @param[in] self Index of the helper
+ */
+void Decaps_helpers::run(unsigned int self) {
+    Mailbox& mailbox = mailboxes[self];
+    uint32_t seen = 0;
+
+    while (true) {
+        uint32_t spins = 0;
+        while (mailbox.posted.load(std::memory_order_acquire) == seen) {
+            if (spins < SPINS_BEFORE_PARK) {
+                spins++;
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+                continue;
+            }
+
+            std::unique_lock<std::mutex> guard(mailbox.park_lock);
+            mailbox.parked.store(true);
+            mailbox.wake.wait(guard, [&mailbox, seen] { return mailbox.posted.load() != seen; });
+            mailbox.parked.store(false, std::memory_order_relaxed);
+        }
+        seen++;
+
+        if (mailbox.task == nullptr) {
+            mailbox.finished.store(seen, std::memory_order_release);
+            return;
+        }
+        mailbox.task(mailbox.context);
+        mailbox.finished.store(seen, std::memory_order_release);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef DECAPS_HELPERS_H
+#define DECAPS_HELPERS_H
+
+/**
+ * @file decaps_helpers.h
+ * @brief Helper threads used by the low-latency decapsulation
+ */
+
+#include <stdint.h>
+#include <memory>
+
+/**
+ * Set of helper threads that run the independent sub-steps of a single decapsulation.
+ *
+ * Each helper owns a one-slot mailbox: the caller publishes a task with a store of a
+ * sequence number and the helper acknowledges it the same way, so a handoff to a polling
+ * helper never takes a lock. Helpers busy-poll their mailbox for a while after each task,
+ * which is the price of the low latency, then park on a condition variable until the next
+ * post, so an idle instance does not use any CPU. An instance is meant to be used by one
+ * thread at a time.
+ *
+ * Tasks posted to a helper that does not exist run inline on the calling thread,
+ * so the decapsulation works with any number of helpers.
+ */
+class Decaps_helpers {
+    public:
+        explicit Decaps_helpers(unsigned int helpers = 2, int first_cpu = -1);
+        ~Decaps_helpers();
+
+        Decaps_helpers(const Decaps_helpers&) = delete;
+        Decaps_helpers& operator=(const Decaps_helpers&) = delete;
+
+        void post(unsigned int helper, void (*task)(void *), void *context);
+        void wait(unsigned int helper);
+        unsigned int helper_count() const;
+
+    private:
+        struct Mailbox;
+
+        static void *start(void *mailbox);
+        void run(unsigned int self);
+
+        unsigned int count;
+        std::unique_ptr<Mailbox[]> mailboxes;
+};
+
+int crypto_kem_dec_low_latency(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, Decaps_helpers *helpers);
+
+#endif
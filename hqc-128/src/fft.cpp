@@ -11,15 +11,16 @@
 
 #include "fft.h"
 #include "gf.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include <stdint.h>
 #include <string.h>
 
 static void compute_fft_betas(uint16_t *betas);
 static void compute_subset_sums(uint16_t *subset_sums, const uint16_t *set, uint16_t set_size);
-static void radix(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f);
-static void radix_big(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f);
-static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32_t m_f, const uint16_t *betas);
+template <class P> static void radix(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f);
+template <class P> static void radix_big(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f);
+template <class P> static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32_t m_f, const uint16_t *betas);
 
 
 /**
@@ -71,6 +72,7 @@ static void compute_subset_sums(uint16_t *subset_sums, const uint16_t *set, uint
  * @param[in] f Array of size a power of 2
  * @param[in] m_f 2^{m_f} is the smallest power of 2 greater or equal to the number of coefficients of f
  */
+template <class P>
 static void radix(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f) {
     switch (m_f) {
         case 4:
@@ -117,19 +119,20 @@ static void radix(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f) {
             break;
 
         default:
-            radix_big(f0, f1, f, m_f);
+            radix_big<P>(f0, f1, f, m_f);
             break;
     }
 }
 
+template <class P>
 static void radix_big(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_f) {
-    uint16_t Q[2 * (1 << (PARAM_FFT - 2)) + 1] = {0};
-    uint16_t R[2 * (1 << (PARAM_FFT - 2)) + 1] = {0};
+    uint16_t Q[2 * (1 << (P::fft - 2)) + 1] = {0};
+    uint16_t R[2 * (1 << (P::fft - 2)) + 1] = {0};
 
-    uint16_t Q0[1 << (PARAM_FFT - 2)] = {0};
-    uint16_t Q1[1 << (PARAM_FFT - 2)] = {0};
-    uint16_t R0[1 << (PARAM_FFT - 2)] = {0};
-    uint16_t R1[1 << (PARAM_FFT - 2)] = {0};
+    uint16_t Q0[1 << (P::fft - 2)] = {0};
+    uint16_t Q1[1 << (P::fft - 2)] = {0};
+    uint16_t R0[1 << (P::fft - 2)] = {0};
+    uint16_t R1[1 << (P::fft - 2)] = {0};
 
     size_t i, n;
 
@@ -144,8 +147,8 @@ static void radix_big(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_
         R[n + i] ^= Q[i];
     }
 
-    radix(Q0, Q1, Q, m_f - 1);
-    radix(R0, R1, R, m_f - 1);
+    radix<P>(Q0, Q1, Q, m_f - 1);
+    radix<P>(R0, R1, R, m_f - 1);
 
     memcpy(f0, R0, 2 * n);
     memcpy(f0 + n, Q0, 2 * n);
@@ -167,15 +170,16 @@ static void radix_big(uint16_t *f0, uint16_t *f1, const uint16_t *f, uint32_t m_
  * @param[in] m_f Number of coefficients of f (one more than its degree)
  * @param[in] betas FFT constants
  */
+template <class P>
 static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32_t m_f, const uint16_t *betas) {
-    uint16_t f0[1 << (PARAM_FFT - 2)] = {0};
-    uint16_t f1[1 << (PARAM_FFT - 2)] = {0};
+    uint16_t f0[1 << (P::fft - 2)] = {0};
+    uint16_t f1[1 << (P::fft - 2)] = {0};
     uint16_t gammas[PARAM_M - 2] = {0};
     uint16_t deltas[PARAM_M - 2] = {0};
     uint16_t gammas_sums[1 << (PARAM_M - 2)] = {0};
     uint16_t u[1 << (PARAM_M - 2)] = {0};
     uint16_t v[1 << (PARAM_M - 2)] = {0};
-    uint16_t tmp[PARAM_M - (PARAM_FFT - 1)] = {0};
+    uint16_t tmp[PARAM_M - (P::fft - 1)] = {0};
 
     uint16_t beta_m_pow;
     size_t i, j, k;
@@ -211,7 +215,7 @@ static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32
     }
 
     // Step 3
-    radix(f0, f1, f, m_f);
+    radix<P>(f0, f1, f, m_f);
 
     // Step 4: compute gammas and deltas
     for (i = 0; i + 1 < m; ++i) {
@@ -223,7 +227,7 @@ static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32
     compute_subset_sums(gammas_sums, gammas, m - 1);
 
     // Step 5
-    fft_rec(u, f0, (f_coeffs + 1) / 2, m - 1, m_f - 1, deltas);
+    fft_rec<P>(u, f0, (f_coeffs + 1) / 2, m - 1, m_f - 1, deltas);
 
     k = 1;
     k <<= ((m - 1) & 0xf); // &0xf is to let the compiler know that m-1 is small.
@@ -235,7 +239,7 @@ static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32
             w[k + i] = w[i] ^ f1[0];
         }
     } else {
-        fft_rec(v, f1, f_coeffs / 2, m - 1, m_f - 1, deltas);
+        fft_rec<P>(v, f1, f_coeffs / 2, m - 1, m_f - 1, deltas);
 
         // Step 6
         memcpy(w + k, v, 2 * k);
@@ -266,14 +270,15 @@ static void fft_rec(uint16_t *w, uint16_t *f, size_t f_coeffs, uint8_t m, uint32
  * Also note that f is altered during computation (twisted at each level).
  *
  * @param[out] w Array
- * @param[in] f Array of 2^PARAM_FFT elements
+ * @param[in] f Array of 2^P::fft elements
  * @param[in] f_coeffs Number coefficients of f (i.e. deg(f)+1)
  */
+template <class P>
 void fft(uint16_t *w, const uint16_t *f, size_t f_coeffs) {
     uint16_t betas[PARAM_M - 1] = {0};
     uint16_t betas_sums[1 << (PARAM_M - 1)] = {0};
-    uint16_t f0[1 << (PARAM_FFT - 1)] = {0};
-    uint16_t f1[1 << (PARAM_FFT - 1)] = {0};
+    uint16_t f0[1 << (P::fft - 1)] = {0};
+    uint16_t f1[1 << (P::fft - 1)] = {0};
     uint16_t deltas[PARAM_M - 1] = {0};
     uint16_t u[1 << (PARAM_M - 1)] = {0};
     uint16_t v[1 << (PARAM_M - 1)] = {0};
@@ -283,7 +288,7 @@ void fft(uint16_t *w, const uint16_t *f, size_t f_coeffs) {
     // Follows Gao and Mateer algorithm
     compute_fft_betas(betas);
 
-    // Step 1: PARAM_FFT > 1, nothing to do
+    // Step 1: P::fft > 1, nothing to do
 
     // Compute gammas sums
     compute_subset_sums(betas_sums, betas, PARAM_M - 1);
@@ -291,7 +296,7 @@ void fft(uint16_t *w, const uint16_t *f, size_t f_coeffs) {
     // Step 2: beta_m = 1, nothing to do
 
     // Step 3
-    radix(f0, f1, f, PARAM_FFT);
+    radix<P>(f0, f1, f, P::fft);
 
     // Step 4: Compute deltas
     for (i = 0; i < PARAM_M - 1; ++i) {
@@ -299,8 +304,8 @@ void fft(uint16_t *w, const uint16_t *f, size_t f_coeffs) {
     }
 
     // Step 5
-    fft_rec(u, f0, (f_coeffs + 1) / 2, PARAM_M - 1, PARAM_FFT - 1, deltas);
-    fft_rec(v, f1, f_coeffs / 2, PARAM_M - 1, PARAM_FFT - 1, deltas);
+    fft_rec<P>(u, f0, (f_coeffs + 1) / 2, PARAM_M - 1, P::fft - 1, deltas);
+    fft_rec<P>(v, f1, f_coeffs / 2, PARAM_M - 1, P::fft - 1, deltas);
 
     k = 1 << (PARAM_M - 1);
     // Step 6, 7 and error polynomial computation
@@ -349,3 +354,10 @@ void fft_retrieve_error_poly(uint8_t *error, const uint16_t *w) {
         error[index] ^= 1 ^ ((uint16_t) - w[k + i] >> 15);
     }
 }
+
+
+
+#define INSTANTIATE_FFT(P) \
+    template void fft<P>(uint16_t *, const uint16_t *, size_t);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_FFT)
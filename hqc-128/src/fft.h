@@ -10,7 +10,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
-void fft(uint16_t *w, const uint16_t *f, size_t f_coeffs);
+template <class P> void fft(uint16_t *w, const uint16_t *f, size_t f_coeffs);
 void fft_retrieve_error_poly(uint8_t *error, const uint16_t *w);
 
 #endif
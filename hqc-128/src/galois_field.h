@@ -0,0 +1,161 @@
+#ifndef GALOIS_FIELD_H
+#define GALOIS_FIELD_H
+
+/**
+ * @file galois_field.h
+ * @brief Compile-time tables of GF(2^M) and of the Reed-Solomon codes defined over it
+ *
+ * Every table is a constexpr std::array computed by the compiler from the field and code parameters,
+ * so that other parameter sets or Reed-Solomon lengths only need a new instantiation.
+ */
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The finite field GF(2^M) defined by the primitive polynomial POLY
+ *
+ * Elements are polynomials over GF(2) of degree less than M stored in the low bits of an uint16_t.
+ * The primitive element alpha is X (the value 2).
+ *
+ * @tparam M Degree of the extension
+ * @tparam POLY Primitive polynomial of degree M, including the X^M term (0x11D for 1 + X^2 + X^3 + X^4 + X^8)
+ */
+template <size_t M, uint32_t POLY>
+struct GaloisField {
+    static_assert(M >= 2 && M <= 15, "GF(2^M) elements must fit in an uint16_t");
+    static_assert((POLY >> M) == 1, "POLY must have degree M");
+
+    static constexpr size_t m = M;
+    static constexpr uint32_t poly = POLY;
+    static constexpr size_t size = (size_t) 1 << M;
+    static constexpr size_t mul_order = size - 1;
+
+
+    /**
+     * @brief Multiplies two elements of GF(2^M)
+     *
+     * Shift-and-add multiplication, only meant for compile-time table generation.
+     *
+     * @returns the product a*b
+     * @param[in] a Element of GF(2^M)
+     * @param[in] b Element of GF(2^M)
+     */
+    static constexpr uint16_t mul(uint16_t a, uint16_t b) {
+        uint32_t x = a;
+        uint32_t r = 0;
+        for (size_t i = 0; i < M; ++i) {
+            if ((b >> i) & 1) {
+                r ^= x;
+            }
+            x <<= 1;
+            if (x >> M) {
+                x ^= POLY;
+            }
+        }
+        return (uint16_t) r;
+    }
+
+
+    /**
+     * @brief Powers of alpha
+     *
+     * The last two elements are alpha and alpha^2 again,
+     * they are needed by the gf_mul function (for example if both elements to multiply are zero).
+     *
+     * @returns the array exp such that exp[i] = alpha^i for 0 <= i < 2^M + 2
+     */
+    static constexpr std::array<uint16_t, size + 2> generate_exp() {
+        std::array<uint16_t, size + 2> exp = {};
+        uint16_t elt = 1;
+        for (size_t i = 0; i < size + 2; ++i) {
+            exp[i] = elt;
+            elt = mul(elt, 2);
+        }
+        return exp;
+    }
+
+
+    /**
+     * @brief Logarithms to the base alpha
+     *
+     * The logarithm of 0 is set to 0 by convention.
+     *
+     * @returns the array log such that alpha^log[x] = x for x != 0
+     */
+    static constexpr std::array<uint16_t, size> generate_log() {
+        std::array<uint16_t, size> log = {};
+        uint16_t elt = 1;
+        for (size_t i = 0; i < mul_order; ++i) {
+            log[elt] = (uint16_t) i;
+            elt = mul(elt, 2);
+        }
+        return log;
+    }
+};
+
+
+
+/**
+ * @brief A Reed-Solomon code [N1, K] over the field GF, of correction capacity DELTA
+ *
+ * The code is a shortened primitive code whose generator polynomial has the roots alpha, ..., alpha^(2*DELTA).
+ *
+ * @tparam GF A GaloisField instantiation
+ * @tparam N1 Length of the code in symbols
+ * @tparam K Dimension of the code in symbols
+ * @tparam DELTA Correction capacity of the code, N1 - K = 2 * DELTA
+ */
+template <class GF, size_t N1, size_t K, size_t DELTA>
+struct ReedSolomonCode {
+    static_assert(N1 - K == 2 * DELTA, "the code must be MDS with N1 - K = 2 * DELTA");
+    static_assert(N1 <= GF::mul_order, "the code cannot be longer than the primitive code");
+
+    typedef GF field;
+    static constexpr size_t n1 = N1;
+    static constexpr size_t k = K;
+    static constexpr size_t delta = DELTA;
+    static constexpr size_t g = 2 * DELTA + 1;
+
+
+    /**
+     * @brief Generator polynomial (X - alpha)(X - alpha^2)...(X - alpha^(2*DELTA))
+     *
+     * @returns the coefficients of the generator polynomial, by increasing degree
+     */
+    static constexpr std::array<uint16_t, g> generate_poly() {
+        std::array<uint16_t, g> poly = {};
+        uint16_t root = 1;
+
+        poly[0] = 1;
+        for (size_t i = 1; i < g; ++i) {
+            root = GF::mul(root, 2);
+            poly[i] = poly[i - 1];
+            for (size_t j = i - 1; j; --j) {
+                poly[j] = GF::mul(poly[j], root) ^ poly[j - 1];
+            }
+            poly[0] = GF::mul(poly[0], root);
+        }
+        return poly;
+    }
+
+
+    /**
+     * @brief Syndrome matrix without its first column
+     *
+     * @returns the matrix alpha_ij_pow such that alpha_ij_pow[i][j] = alpha^((i+1)*(j+1))
+     */
+    static constexpr std::array<std::array<uint16_t, N1 - 1>, 2 * DELTA> generate_alpha_ij_pow() {
+        std::array<std::array<uint16_t, N1 - 1>, 2 * DELTA> alpha_ij_pow = {};
+        const std::array<uint16_t, GF::size + 2> exp = GF::generate_exp();
+        for (size_t i = 0; i < 2 * DELTA; ++i) {
+            for (size_t j = 0; j < N1 - 1; ++j) {
+                alpha_ij_pow[i][j] = exp[((i + 1) * (j + 1)) % GF::mul_order];
+            }
+        }
+        return alpha_ij_pow;
+    }
+};
+
+#endif
@@ -164,6 +164,58 @@ uint16_t gf_mul(uint16_t a, uint16_t b) {
 
 
 
+/**
+ * Multiplies two vectors of 16 elements of GF(2^GF_M) stored in 16-bit lanes.
+ *
+ * The carryless products are computed with pclmulqdq, two lanes per 64-bit half,
+ * and the 16 results are then reduced together modulo PARAM_GF_POLY.
+ * Must only be called when cpu_supports_avx2() holds.
+ *
+ * @returns the lane-wise product a*b
+ * @param[in] a Vector of 16 elements of GF(2^GF_M)
+ * @param[in] b Vector of 16 elements of GF(2^GF_M)
+ */
+HQC_TARGET_AVX2 __m256i gf_mul_vect(__m256i a, __m256i b) {
+    // x^(8+i) modulo x^8+x^4+x^3+x^2+1
+    static const uint16_t red[7] = {0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13};
+
+    const __m128i maskl = _mm_set1_epi32(0x0000ffff);
+    const __m128i maskh = _mm_set1_epi32((int) 0xffff0000);
+    const __m128i middlemaskl = _mm_set_epi64x(0x000000000000ffff, 0x000000000000ffff);
+    const __m128i middlemaskh = _mm_set_epi64x(0x0000ffff00000000, 0x0000ffff00000000);
+    const __m128i indexl = _mm_set_epi64x(-1, 0x0d0c090805040100);
+    const __m128i indexh = _mm_set_epi64x(0x0d0c090805040100, -1);
+
+    __m128i half[2];
+    for (int h = 0; h < 2; ++h) {
+        __m128i x = h ? _mm256_extracti128_si256(a, 1) : _mm256_castsi256_si128(a);
+        __m128i y = h ? _mm256_extracti128_si256(b, 1) : _mm256_castsi256_si128(b);
+        __m128i xl = _mm_and_si128(x, maskl), yl = _mm_and_si128(y, maskl);
+        __m128i xh = _mm_and_si128(x, maskh), yh = _mm_and_si128(y, maskh);
+
+        __m128i lo = _mm_and_si128(_mm_clmulepi64_si128(xl, yl, 0x00), middlemaskl);
+        lo = _mm_xor_si128(lo, _mm_and_si128(_mm_clmulepi64_si128(xh, yh, 0x00), middlemaskh));
+
+        __m128i hi = _mm_and_si128(_mm_clmulepi64_si128(xl, yl, 0x11), middlemaskl);
+        hi = _mm_xor_si128(hi, _mm_and_si128(_mm_clmulepi64_si128(xh, yh, 0x11), middlemaskh));
+
+        half[h] = _mm_xor_si128(_mm_shuffle_epi8(lo, indexl), _mm_shuffle_epi8(hi, indexh));
+    }
+
+    __m256i ret = _mm256_inserti128_si256(_mm256_castsi128_si256(half[0]), half[1], 1);
+    __m256i aux = _mm256_set1_epi16(0x0100);
+
+    for (int32_t i = 0; i < 7; i++) {
+        __m256i mask = _mm256_cmpeq_epi16(_mm256_and_si256(ret, aux), aux);
+        ret = _mm256_xor_si256(ret, _mm256_and_si256(_mm256_set1_epi16(red[i]), mask));
+        aux = _mm256_slli_epi16(aux, 1);
+    }
+
+    return _mm256_and_si256(ret, _mm256_set1_epi16(0x00ff));
+}
+
+
+
 /**
  * Squares an element of GF(2^GF_M).
  * @returns a^2
@@ -208,6 +260,44 @@ uint16_t gf_inverse(uint16_t a) {
 
 
 
+/**
+ * Computes the inverses of k elements of GF(2^GF_M) at once.
+ *
+ * Uses simultaneous (Montgomery) inversion: the prefix products of the elements
+ * are inverted with a single call to gf_inverse, then unwound,
+ * for a total of one inversion and 3(k-1) multiplications. <br>
+ * Zero elements are replaced by 1 in the products and their inverse is set to 0,
+ * matching gf_inverse(0) = 0, without branching on the values.
+ *
+ * @param[out] inv Array of k elements receiving the inverses, must not overlap a
+ * @param[in] a Array of k elements of GF(2^GF_M)
+ * @param[in] k Number of elements, at least 1
+ */
+void gf_batch_inverse(uint16_t *inv, const uint16_t *a, size_t k) {
+    uint16_t mask, t;
+
+    // inv[i] = a[0] * ... * a[i], with zeros replaced by 1
+    mask = (uint16_t) (-((int32_t) a[0]) >> 31); // a[0] != 0
+    inv[0] = (mask & a[0]) ^ (~mask & 1);
+    for (size_t i = 1; i < k; ++i) {
+        mask = (uint16_t) (-((int32_t) a[i]) >> 31); // a[i] != 0
+        inv[i] = gf_mul(inv[i - 1], (mask & a[i]) ^ (~mask & 1));
+    }
+
+    // t = (a[0] * ... * a[i])^-1 when processing i
+    t = gf_inverse(inv[k - 1]);
+    for (size_t i = k - 1; i; --i) {
+        mask = (uint16_t) (-((int32_t) a[i]) >> 31); // a[i] != 0
+        inv[i] = mask & gf_mul(t, inv[i - 1]);
+        t = gf_mul(t, (mask & a[i]) ^ (~mask & 1));
+    }
+
+    mask = (uint16_t) (-((int32_t) a[0]) >> 31); // a[0] != 0
+    inv[0] = mask & t;
+}
+
+
+
 /**
  * Returns i modulo 2^GF_M-1.
  * i must be less than 2*(2^GF_M-1).
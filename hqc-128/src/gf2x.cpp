@@ -4,22 +4,31 @@
  */
 
 #include "gf2x.h"
+#include "cpu_features.h"
+#include <string.h>
+#include <immintrin.h>
 using namespace NTL;
 
-GF2XModulus init_modulo();
+template <class P> GF2XModulus init_modulo();
+static inline void base_mul_portable(uint64_t *c, uint64_t a, uint64_t b);
+static void schoolbook_portable(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n);
+HQC_TARGET_AVX2 static void schoolbook_avx2(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n);
+static void karatsuba(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch,
+                      void (*schoolbook)(uint64_t *, const uint64_t *, const uint64_t *, size_t));
 
 /**
  * \fn GF2XModulus init_modulo()
  * \brief This function build the modulus \f$ X^n - 1\f$
  * \return the modulus as an GF2XModulus object
  */
+template <class P>
 GF2XModulus init_modulo() {
-  GF2XModulus P;
+  GF2XModulus modulus;
   GF2X tmp;
-  SetCoeff(tmp, PARAM_N, 1);
+  SetCoeff(tmp, P::n, 1);
   SetCoeff(tmp, 0, 1);
-  build(P, tmp);
-  return P;
+  build(modulus, tmp);
+  return modulus;
 }
 
 
@@ -34,16 +43,220 @@ GF2XModulus init_modulo() {
  * \param[in] v1 Pointer to the first vector
  * \param[in] v2 Pointer to the second vector
  */
+template <class P>
 void vect_mul(uint64_t *o, const uint64_t *v1, const uint64_t *v2) {
   GF2X tmp1, poly1, poly2;
-  uint8_t tmp2[VEC_N_SIZE_BYTES] = {0};
+  uint8_t tmp2[P::vec_n_size_bytes] = {0};
 
-  GF2XFromBytes(poly1, (uint8_t *) v1, VEC_N_SIZE_BYTES);
-  GF2XFromBytes(poly2, (uint8_t *) v2, VEC_N_SIZE_BYTES);
-  GF2XModulus P = init_modulo();
+  GF2XFromBytes(poly1, (uint8_t *) v1, P::vec_n_size_bytes);
+  GF2XFromBytes(poly2, (uint8_t *) v2, P::vec_n_size_bytes);
+  GF2XModulus modulus = init_modulo<P>();
 
-  MulMod(tmp1, poly1, poly2, P);
+  MulMod(tmp1, poly1, poly2, modulus);
 
-  BytesFromGF2X(tmp2, tmp1, VEC_N_SIZE_BYTES);
-  memcpy(o, tmp2, VEC_N_SIZE_BYTES);
-}
\ No newline at end of file
+  BytesFromGF2X(tmp2, tmp1, P::vec_n_size_bytes);
+  memcpy(o, tmp2, P::vec_n_size_bytes);
+}
+
+
+
+/**
+ * \fn static inline void base_mul_portable(uint64_t *c, uint64_t a, uint64_t b)
+ * \brief Carryless multiplication of two words in constant time
+ *
+ * \param[out] c The 128-bit product, low word first
+ * \param[in] a First word
+ * \param[in] b Second word
+ */
+static inline void base_mul_portable(uint64_t *c, uint64_t a, uint64_t b) {
+  uint64_t lo = b & -(a & 1);
+  uint64_t hi = 0;
+
+  for (size_t i = 1; i < 64; i++) {
+    uint64_t mask = -((a >> i) & 1);
+    lo ^= (b << i) & mask;
+    hi ^= (b >> (64 - i)) & mask;
+  }
+
+  c[0] = lo;
+  c[1] = hi;
+}
+
+
+
+/**
+ * \fn static void schoolbook_portable(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n)
+ * \brief Schoolbook multiplication of two n-word polynomials
+ *
+ * \param[out] o The 2n-word product
+ * \param[in] a First polynomial
+ * \param[in] b Second polynomial
+ * \param[in] n Number of words of the polynomials
+ */
+static void schoolbook_portable(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n) {
+  uint64_t c[2];
+
+  memset(o, 0, 2 * n * sizeof(uint64_t));
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      base_mul_portable(c, a[i], b[j]);
+      o[i + j] ^= c[0];
+      o[i + j + 1] ^= c[1];
+    }
+  }
+}
+
+
+
+/**
+ * \fn static void schoolbook_avx2(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n)
+ * \brief Schoolbook multiplication of two n-word polynomials with pclmulqdq
+ *
+ * \param[out] o The 2n-word product
+ * \param[in] a First polynomial
+ * \param[in] b Second polynomial
+ * \param[in] n Number of words of the polynomials
+ */
+HQC_TARGET_AVX2 static void schoolbook_avx2(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n) {
+  __m128i column[2 * KARATSUBA_THRESHOLD];
+
+  for (size_t k = 0; k < 2 * KARATSUBA_THRESHOLD; k++) {
+    column[k] = _mm_setzero_si128();
+  }
+  for (size_t i = 0; i < n; i++) {
+    __m128i ai = _mm_cvtsi64_si128((long long) a[i]);
+    for (size_t j = 0; j < n; j++) {
+      column[i + j] = _mm_xor_si128(column[i + j], _mm_clmulepi64_si128(ai, _mm_cvtsi64_si128((long long) b[j]), 0x00));
+    }
+  }
+
+  // o[k] is the low word of column k plus the high word of column k - 1
+  o[0] = (uint64_t) _mm_cvtsi128_si64(column[0]);
+  for (size_t k = 1; k < 2 * n; k++) {
+    o[k] = (uint64_t) _mm_cvtsi128_si64(column[k]) ^ (uint64_t) _mm_extract_epi64(column[k - 1], 1);
+  }
+}
+
+
+
+/**
+ * \fn static void karatsuba(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch, void (*schoolbook)(uint64_t *, const uint64_t *, const uint64_t *, size_t))
+ * \brief Karatsuba multiplication of two n-word polynomials
+ *
+ * The operands are split in a low half of ceil(n/2) words and a high half of floor(n/2) words.
+ * The low and high products go straight into o, the middle one into the scratch.
+ *
+ * \param[out] o The 2n-word product
+ * \param[in] a First polynomial
+ * \param[in] b Second polynomial
+ * \param[in] n Number of words of the polynomials
+ * \param[in] scratch At least karatsuba_scratch_64(n) words
+ * \param[in] schoolbook Multiplication used below KARATSUBA_THRESHOLD words
+ */
+static void karatsuba(uint64_t *o, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch,
+                      void (*schoolbook)(uint64_t *, const uint64_t *, const uint64_t *, size_t)) {
+  if (n <= KARATSUBA_THRESHOLD) {
+    schoolbook(o, a, b, n);
+    return;
+  }
+
+  const size_t h = (n + 1) / 2;
+  const size_t l = n - h;
+  uint64_t *sum_a = scratch;
+  uint64_t *sum_b = scratch + h;
+  uint64_t *middle = scratch + 2 * h;
+  uint64_t *next = scratch + 4 * h;
+
+  karatsuba(o, a, b, h, next, schoolbook);
+  karatsuba(o + 2 * h, a + h, b + h, l, next, schoolbook);
+
+  for (size_t i = 0; i < h; i++) {
+    sum_a[i] = a[i] ^ ((i < l) ? a[h + i] : 0);
+    sum_b[i] = b[i] ^ ((i < l) ? b[h + i] : 0);
+  }
+  karatsuba(middle, sum_a, sum_b, h, next, schoolbook);
+
+  for (size_t i = 0; i < 2 * h; i++) {
+    middle[i] ^= o[i] ^ ((i < 2 * l) ? o[2 * h + i] : 0);
+  }
+  for (size_t i = 0; i < 2 * h; i++) {
+    o[h + i] ^= middle[i];
+  }
+}
+
+
+
+/**
+ * \fn void vect_mul(uint64_t *o, const uint64_t *v1, const uint64_t *v2, uint64_t *scratch)
+ * \brief Multiply two vectors without allocating
+ *
+ * Same product as vect_mul(o, v1, v2), computed with a Karatsuba multiplication in the caller
+ * scratch followed by a reduction modulo \f$ X^n - 1\f$. The base products use pclmulqdq when
+ * the CPU supports it and a constant-time shift-and-add otherwise.
+ *
+ * \param[out] o Product of <b>v1</b> and <b>v2</b>
+ * \param[in] v1 Pointer to the first vector
+ * \param[in] v2 Pointer to the second vector
+ * \param[in] scratch At least vect_mul_scratch_64<P>() words
+ */
+template <class P>
+void vect_mul(uint64_t *o, const uint64_t *v1, const uint64_t *v2, uint64_t *scratch) {
+  uint64_t *product = scratch;
+  const size_t word = P::n >> 6;
+  const size_t shift = P::n & 0x3f; // never 0, n is odd
+
+  karatsuba(product, v1, v2, P::vec_n_size_64, scratch + 2 * P::vec_n_size_64, cpu_supports_avx2() ? schoolbook_avx2 : schoolbook_portable);
+
+  // Bit i + n of the product folds back onto bit i
+  for (size_t i = 0; i < P::vec_n_size_64; i++) {
+    o[i] = product[i] ^ (product[i + word] >> shift) ^ (product[i + word + 1] << (64 - shift));
+  }
+  o[P::vec_n_size_64 - 1] &= P::red_mask;
+}
+
+
+
+/**
+ * \fn void vect_mul(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2)
+ * \brief Multiply two padded vectors
+ *
+ * Same product as vect_mul<P>(o, v1, v2) on the words of the vectors, with the padding of <b>o</b> cleared.
+ *
+ * \param[out] o Product of <b>v1</b> and <b>v2</b>
+ * \param[in] v1 Pointer to the first vector
+ * \param[in] v2 Pointer to the second vector
+ */
+template <class P>
+void vect_mul(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2) {
+  vect_mul<P>(o->words, v1->words, v2->words);
+  vect_clear_padding(o, P::vec_n_size_bytes);
+}
+
+
+
+/**
+ * \fn void vect_mul(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2, uint64_t *scratch)
+ * \brief Multiply two padded vectors without allocating
+ *
+ * Same product as vect_mul<P>(o, v1, v2, scratch) on the words of the vectors, with the padding of <b>o</b> cleared.
+ *
+ * \param[out] o Product of <b>v1</b> and <b>v2</b>
+ * \param[in] v1 Pointer to the first vector
+ * \param[in] v2 Pointer to the second vector
+ * \param[in] scratch At least vect_mul_scratch_64<P>() words
+ */
+template <class P>
+void vect_mul(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2, uint64_t *scratch) {
+  vect_mul<P>(o->words, v1->words, v2->words, scratch);
+  vect_clear_padding(o, P::vec_n_size_64 * sizeof(uint64_t));
+}
+
+
+
+#define INSTANTIATE_GF2X(P) \
+  template void vect_mul<P>(uint64_t *, const uint64_t *, const uint64_t *); \
+  template void vect_mul<P>(uint64_t *, const uint64_t *, const uint64_t *, uint64_t *); \
+  template void vect_mul<P>(padded_vect<P> *, const padded_vect<P> *, const padded_vect<P> *); \
+  template void vect_mul<P>(padded_vect<P> *, const padded_vect<P> *, const padded_vect<P> *, uint64_t *);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_GF2X)
@@ -8,11 +8,36 @@
 
 #include <NTL/GF2X.h>
 #include <inttypes.h>
+#include <stddef.h>
 
 #include "parameters.h"
+#include "vector.h"
 
 using namespace NTL;
 
-void vect_mul(uint64_t *o, const uint64_t *v1, const uint64_t *v2);
+// Operands of at most this many words are multiplied with the schoolbook method
+#define KARATSUBA_THRESHOLD 12
+
+/**
+ * \brief Number of scratch words used by the Karatsuba multiplication of two n-word polynomials
+ */
+constexpr size_t karatsuba_scratch_64(size_t n) {
+  return (n <= KARATSUBA_THRESHOLD) ? 0 : 4 * ((n + 1) / 2) + karatsuba_scratch_64((n + 1) / 2);
+}
+
+/**
+ * \brief Number of scratch words of the heap-free vect_mul of a parameter set: the unreduced product followed by the Karatsuba scratch
+ */
+template <class P>
+constexpr size_t vect_mul_scratch_64() {
+  return 2 * P::vec_n_size_64 + karatsuba_scratch_64(P::vec_n_size_64);
+}
+
+#define VECT_MUL_SCRATCH_64 vect_mul_scratch_64<hqc128_params>()
+
+template <class P> void vect_mul(uint64_t *o, const uint64_t *v1, const uint64_t *v2);
+template <class P> void vect_mul(uint64_t *o, const uint64_t *v1, const uint64_t *v2, uint64_t *scratch);
+template <class P> void vect_mul(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> void vect_mul(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2, uint64_t *scratch);
 
 #endif
\ No newline at end of file
@@ -4,20 +4,69 @@
  */
 
 #include "hqc.h"
+#include "decaps_helpers.h"
 #include "gf2x.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include "parsing.h"
 #include "shake_prng.h"
 #include "code.h"
 #include "vector.h"
 #include "profiling.h"
+#include "workspace.h"
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <cstdint>
 #ifdef VERBOSE
 #include <stdio.h>
 #endif
 
+struct Mul_task {
+    aligned_vect *o;
+    const aligned_vect *v1;
+    const aligned_vect *v2;
+};
+
+struct Noise_task {
+    seedexpander_state seedexpander;
+    aligned_vect *v;
+    const uint64_t *m;
+};
+
+static void mul_task(void *context);
+static void noise_task(void *context);
+
+
+/**
+ * @brief Helper task computing o = v1.v2
+ *
+ * @param[in] context Pointer to a Mul_task
+ */
+static void mul_task(void *context) {
+    Mul_task *task = (Mul_task *) context;
+    vect_mul<hqc128_params>(task->o, task->v1, task->v2);
+}
+
+
+
+/**
+ * @brief Helper task computing v = e + m.G truncated to PARAM_N1N2 bits
+ *
+ * The seedexpander is a copy of the encryption one taken right after r1 and r2 were drawn,
+ * so e is the same vector as in the serial encryption.
+ *
+ * @param[in] context Pointer to a Noise_task
+ */
+static void noise_task(void *context) {
+    Noise_task *task = (Noise_task *) context;
+    aligned_vect e = {};
+
+    vect_set_random_fixed_weight<hqc128_params>(&task->seedexpander, e.words, PARAM_OMEGA_E);
+    vect_resize(task->v, PARAM_N1N2, &e);
+    code_encode_xor<hqc128_params>(task->v->words, task->m);
+}
+
 
 /**
  * @brief Keygen of the HQC_PKE IND_CPA scheme
@@ -30,78 +79,170 @@
  * @param[out] pk String containing the public key
  * @param[out] sk String containing the secret key
  */
+template <class P>
 void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, Trace_time *keygen_time) {
     seedexpander_state sk_seedexpander;
     seedexpander_state pk_seedexpander;
-    uint8_t sk_seed[SEED_BYTES] = {0};
-    uint8_t sigma[VEC_K_SIZE_BYTES] = {0};
-    uint8_t pk_seed[SEED_BYTES] = {0};
-    uint64_t x[VEC_N_SIZE_64] = {0};
-    uint64_t y[VEC_N_SIZE_64] = {0};
-    uint64_t h[VEC_N_SIZE_64] = {0};
-    uint64_t s[VEC_N_SIZE_64] = {0};
+    uint8_t sk_seed[P::seed_bytes] = {0};
+    uint8_t sigma[P::vec_k_size_bytes] = {0};
+    uint8_t pk_seed[P::seed_bytes] = {0};
+    padded_vect<P> x = {};
+    padded_vect<P> y = {};
+    padded_vect<P> h = {};
+    padded_vect<P> s = {};
     clock_t start, end;
 
     // Create seed_expanders for public key and secret key
     // shake 알고리즘, 해시 함수 같은건데 NIST에 의해 SHA-3의 일부로 채택된것임, SHA-3 알고리즘의 변형
     keygen_time->stack += 1;
     
-    start = clock();
-    shake_prng(sk_seed, SEED_BYTES); // sk_seed를 squeeze함, 출력데이터를 생성한 상태
-    shake_prng(sigma, VEC_K_SIZE_BYTES);
-    shake_prng(pk_seed, SEED_BYTES); // pk_seed를 squeeze
-    end = clock();
+    start = trace_start(keygen_time, TRACE_SHAKE_PRNG);
+    shake_prng(sk_seed, P::seed_bytes); // sk_seed를 squeeze함, 출력데이터를 생성한 상태
+    shake_prng(sigma, P::vec_k_size_bytes);
+    shake_prng(pk_seed, P::seed_bytes); // pk_seed를 squeeze
+    end = trace_stop(keygen_time, TRACE_SHAKE_PRNG);
     keygen_time->shake_prng_time += ((uint32_t)(end - start));
     
-    start = clock();
-    seedexpander_init(&sk_seedexpander, sk_seed, SEED_BYTES); //sk_seed를 absorb함
-    seedexpander_init(&pk_seedexpander, pk_seed, SEED_BYTES); //pk_seed를 absorb함
-    end = clock();
+    start = trace_start(keygen_time, TRACE_SEEDEXPANDER_INIT);
+    seedexpander_init(&sk_seedexpander, sk_seed, P::seed_bytes); //sk_seed를 absorb함
+    seedexpander_init(&pk_seedexpander, pk_seed, P::seed_bytes); //pk_seed를 absorb함
+    end = trace_stop(keygen_time, TRACE_SEEDEXPANDER_INIT);
     keygen_time->seedexpander_init_time += ((uint32_t)(end - start));
 
     // Compute secret key 
-    start = clock();
-    vect_set_random_fixed_weight(&sk_seedexpander, x, PARAM_OMEGA); //hamming weight로 x, y생성
-    vect_set_random_fixed_weight(&sk_seedexpander, y, PARAM_OMEGA); //x, y는 secret key에 해당됨
-    end = clock();
+    start = trace_start(keygen_time, TRACE_VECT_SET_RANDOM_FIXED_WEIGHT);
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, x.words, P::omega); //hamming weight로 x, y생성
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, y.words, P::omega); //x, y는 secret key에 해당됨
+    end = trace_stop(keygen_time, TRACE_VECT_SET_RANDOM_FIXED_WEIGHT);
     keygen_time->vect_set_random_fixed_weight_time += ((uint32_t)(end - start));
 
     // Compute public key
-    start = clock();
-    vect_set_random(&pk_seedexpander, h); //h 벡터 생성
-    end = clock();
+    start = trace_start(keygen_time, TRACE_VECT_SET_RANDOM);
+    vect_set_random(&pk_seedexpander, &h); //h 벡터 생성
+    end = trace_stop(keygen_time, TRACE_VECT_SET_RANDOM);
     keygen_time->vect_set_random_time += ((uint32_t)(end - start));
 
-    start = clock();
-    vect_mul(s, y, h); 
-    vect_add(s, x, s, VEC_N_SIZE_64); // syndrome 생성
-    end = clock();
+    start = trace_start(keygen_time, TRACE_VECT_OPERATION);
+    trace_start(keygen_time, TRACE_VECT_MUL);
+    vect_mul(&s, &y, &h);
+    trace_stop(keygen_time, TRACE_VECT_MUL);
+    vect_add(&s, &x, &s); // syndrome 생성
+    end = trace_stop(keygen_time, TRACE_VECT_OPERATION);
     keygen_time->vect_operation_time += ((uint32_t)(end - start));
 
     // Parse keys to string
-    start = clock();
-    hqc_public_key_to_string(pk, pk_seed, s); //syndrome도 pk니까
-    hqc_secret_key_to_string(sk, sk_seed, sigma, pk);
-    end = clock();
+    start = trace_start(keygen_time, TRACE_PARSING);
+    hqc_public_key_to_string(pk, pk_seed, &s); //syndrome도 pk니까
+    hqc_secret_key_to_string<P>(sk, sk_seed, sigma, pk);
+    end = trace_stop(keygen_time, TRACE_PARSING);
     keygen_time->parsing_time += ((uint32_t)(end - start));
 
     #ifdef VERBOSE
-        printf("\n\nsk_seed: "); for(int i = 0 ; i < SEED_BYTES ; ++i) printf("%02x", sk_seed[i]);
-        printf("\n\nsigma: "); for(int i = 0 ; i < VEC_K_SIZE_BYTES ; ++i) printf("%02x", sigma[i]);
-        printf("\n\nx: "); vect_print(x, VEC_N_SIZE_BYTES);
-        printf("\n\ny: "); vect_print(y, VEC_N_SIZE_BYTES);
+        printf("\n\nsk_seed: "); for(size_t i = 0 ; i < P::seed_bytes ; ++i) printf("%02x", sk_seed[i]);
+        printf("\n\nsigma: "); for(size_t i = 0 ; i < P::vec_k_size_bytes ; ++i) printf("%02x", sigma[i]);
+        printf("\n\nx: "); vect_print<P>(x.words, P::vec_n_size_bytes);
+        printf("\n\ny: "); vect_print<P>(y.words, P::vec_n_size_bytes);
+
+        printf("\n\npk_seed: "); for(size_t i = 0 ; i < P::seed_bytes ; ++i) printf("%02x", pk_seed[i]);
+        printf("\n\nh: "); vect_print<P>(h.words, P::vec_n_size_bytes);
+        printf("\n\ns: "); vect_print<P>(s.words, P::vec_n_size_bytes);
+
+        printf("\n\nsk: "); for(size_t i = 0 ; i < P::secret_key_bytes ; ++i) printf("%02x", sk[i]);
+        printf("\n\npk: "); for(size_t i = 0 ; i < P::public_key_bytes ; ++i) printf("%02x", pk[i]);
+    #endif
+}
+
+
+template <class P>
+void hqc_pke_keygen(unsigned char* pk, unsigned char* sk) {
+    seedexpander_state sk_seedexpander;
+    seedexpander_state pk_seedexpander;
+    uint8_t sk_seed[P::seed_bytes] = {0};
+    uint8_t sigma[P::vec_k_size_bytes] = {0};
+    uint8_t pk_seed[P::seed_bytes] = {0};
+    padded_vect<P> x = {};
+    padded_vect<P> y = {};
+    padded_vect<P> h = {};
+    padded_vect<P> s = {};
+
+    // Create seed_expanders for public key and secret key
+    shake_prng(sk_seed, P::seed_bytes);
+    shake_prng(sigma, P::vec_k_size_bytes);
+    shake_prng(pk_seed, P::seed_bytes);
+
+    seedexpander_init(&sk_seedexpander, sk_seed, P::seed_bytes);
+    seedexpander_init(&pk_seedexpander, pk_seed, P::seed_bytes);
+
+    // Compute secret key
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, x.words, P::omega);
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, y.words, P::omega);
+
+    // Compute public key
+    vect_set_random(&pk_seedexpander, &h);
+    vect_mul(&s, &y, &h);
+    vect_add(&s, &x, &s);
+
+    // Parse keys to string
+    hqc_public_key_to_string(pk, pk_seed, &s);
+    hqc_secret_key_to_string<P>(sk, sk_seed, sigma, pk);
+
+    #ifdef VERBOSE
+        printf("\n\nsk_seed: "); for(size_t i = 0 ; i < P::seed_bytes ; ++i) printf("%02x", sk_seed[i]);
+        printf("\n\nsigma: "); for(size_t i = 0 ; i < P::vec_k_size_bytes ; ++i) printf("%02x", sigma[i]);
+        printf("\n\nx: "); vect_print<P>(x.words, P::vec_n_size_bytes);
+        printf("\n\ny: "); vect_print<P>(y.words, P::vec_n_size_bytes);
 
-        printf("\n\npk_seed: "); for(int i = 0 ; i < SEED_BYTES ; ++i) printf("%02x", pk_seed[i]);
-        printf("\n\nh: "); vect_print(h, VEC_N_SIZE_BYTES);
-        printf("\n\ns: "); vect_print(s, VEC_N_SIZE_BYTES);
+        printf("\n\npk_seed: "); for(size_t i = 0 ; i < P::seed_bytes ; ++i) printf("%02x", pk_seed[i]);
+        printf("\n\nh: "); vect_print<P>(h.words, P::vec_n_size_bytes);
+        printf("\n\ns: "); vect_print<P>(s.words, P::vec_n_size_bytes);
 
-        printf("\n\nsk: "); for(int i = 0 ; i < SECRET_KEY_BYTES ; ++i) printf("%02x", sk[i]);
-        printf("\n\npk: "); for(int i = 0 ; i < PUBLIC_KEY_BYTES ; ++i) printf("%02x", pk[i]);
+        printf("\n\nsk: "); for(size_t i = 0 ; i < P::secret_key_bytes ; ++i) printf("%02x", sk[i]);
+        printf("\n\npk: "); for(size_t i = 0 ; i < P::public_key_bytes ; ++i) printf("%02x", pk[i]);
     #endif
 }
 
 
 
+/**
+ * @brief Keygen of the HQC_PKE IND_CPA scheme working in a caller-provided workspace
+ *
+ * Same keys as hqc_pke_keygen, without heap allocation and with a small stack footprint.
+ *
+ * @param[out] pk String containing the public key
+ * @param[out] sk String containing the secret key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ */
+void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, hqc_workspace *workspace) {
+    seedexpander_state sk_seedexpander;
+    seedexpander_state pk_seedexpander;
+    uint8_t sk_seed[SEED_BYTES] = {0};
+    uint8_t pk_seed[SEED_BYTES] = {0};
+
+    shake_prng(sk_seed, SEED_BYTES);
+    shake_prng(workspace->sigma, VEC_K_SIZE_BYTES);
+    shake_prng(pk_seed, SEED_BYTES);
+
+    seedexpander_init(&sk_seedexpander, sk_seed, SEED_BYTES);
+    seedexpander_init(&pk_seedexpander, pk_seed, SEED_BYTES);
+
+    // Compute secret key
+    memset(&workspace->x, 0, sizeof(aligned_vect));
+    memset(&workspace->y, 0, sizeof(aligned_vect));
+    vect_set_random_fixed_weight(&sk_seedexpander, workspace->x.words, PARAM_OMEGA, &workspace->sampling);
+    vect_set_random_fixed_weight(&sk_seedexpander, workspace->y.words, PARAM_OMEGA, &workspace->sampling);
+
+    // Compute public key
+    vect_set_random(&pk_seedexpander, &workspace->h);
+    vect_mul(&workspace->s, &workspace->y, &workspace->h, workspace->mul);
+    vect_add(&workspace->s, &workspace->x, &workspace->s);
+
+    // Parse keys to string
+    hqc_public_key_to_string(pk, pk_seed, &workspace->s);
+    hqc_secret_key_to_string<hqc128_params>(sk, sk_seed, workspace->sigma, pk);
+}
+
+
+
 /**
  * @brief Encryption of the HQC_PKE IND_CPA scheme
  *
@@ -113,120 +254,237 @@ void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, Trace_time *keygen_tim
  * @param[in] theta Seed used to derive randomness required for encryption
  * @param[in] pk String containing the public key
  */
-void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, Trace_time* common_time) {
+template <class P>
+void hqc_pke_encrypt(padded_vect<P> *u, padded_vect<P> *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, Trace_time* common_time) {
     seedexpander_state seedexpander;
-    uint64_t h[VEC_N_SIZE_64] = {0};
-    uint64_t s[VEC_N_SIZE_64] = {0};
-    uint64_t r1[VEC_N_SIZE_64] = {0};
-    uint64_t r2[VEC_N_SIZE_64] = {0};
-    uint64_t e[VEC_N_SIZE_64] = {0};
-    uint64_t tmp1[VEC_N_SIZE_64] = {0};
-    uint64_t tmp2[VEC_N_SIZE_64] = {0};
+    padded_vect<P> h = {};
+    padded_vect<P> s = {};
+    padded_vect<P> r1 = {};
+    padded_vect<P> r2 = {};
+    padded_vect<P> e = {};
+    padded_vect<P> tmp2 = {};
     clock_t start, end;
     // Create seed_expander from theta
-    start = clock();
-    seedexpander_init(&seedexpander, theta, SEED_BYTES); //Shake 256 처리
-    end = clock();
+    start = trace_start(common_time, TRACE_SEEDEXPANDER_INIT);
+    seedexpander_init(&seedexpander, theta, P::seed_bytes); //Shake 256 처리
+    end = trace_stop(common_time, TRACE_SEEDEXPANDER_INIT);
     common_time->seedexpander_init_time += ((uint32_t)(end - start));
 
     // Retrieve h and s from public key
-    hqc_public_key_from_string(h, s, pk, common_time); //h, s 추출?
+    hqc_public_key_from_string(&h, &s, pk, common_time); //h, s 추출?
 
     // Generate r1, r2 and e
-    start = clock();
-    vect_set_random_fixed_weight(&seedexpander, r1, PARAM_OMEGA_R);
-    vect_set_random_fixed_weight(&seedexpander, r2, PARAM_OMEGA_R);
-    vect_set_random_fixed_weight(&seedexpander, e, PARAM_OMEGA_E);
-    end = clock();
+    start = trace_start(common_time, TRACE_VECT_SET_RANDOM_FIXED_WEIGHT);
+    vect_set_random_fixed_weight<P>(&seedexpander, r1.words, P::omega_r);
+    vect_set_random_fixed_weight<P>(&seedexpander, r2.words, P::omega_r);
+    vect_set_random_fixed_weight<P>(&seedexpander, e.words, P::omega_e);
+    end = trace_stop(common_time, TRACE_VECT_SET_RANDOM_FIXED_WEIGHT);
     common_time->vect_set_random_fixed_weight_time += ((uint32_t)(end - start));
     //r1, r2, e 벡터생성
 
     // Compute u = r1 + r2.h
-    start = clock();
-    vect_mul(u, r2, h);
-    vect_add(u, r1, u, VEC_N_SIZE_64); //u 연산
-    end = clock();
+    start = trace_start(common_time, TRACE_VECT_OPERATION);
+    trace_start(common_time, TRACE_VECT_MUL);
+    vect_mul(u, &r2, &h);
+    trace_stop(common_time, TRACE_VECT_MUL);
+    vect_add(u, &r1, u); //u 연산
+    end = trace_stop(common_time, TRACE_VECT_OPERATION);
     common_time->vect_operation_time += ((uint32_t)(end - start));
 
-    // Compute v = m.G by encoding the message
-
-    code_encode(v, m, common_time); //rs-rm encoding
-
-    start = clock();
-    vect_resize(tmp1, PARAM_N, v, PARAM_N1N2);
-
-    // Compute v = m.G + s.r2 + e
-    vect_mul(tmp2, r2, s);
-    vect_add(tmp2, e, tmp2, VEC_N_SIZE_64);
-    vect_add(tmp2, tmp1, tmp2, VEC_N_SIZE_64);
-    vect_resize(v, PARAM_N1N2, tmp2, PARAM_N);
-    end = clock();
+    // Compute v = s.r2 + e truncated to P::n1n2 bits
+    start = trace_start(common_time, TRACE_VECT_OPERATION);
+    trace_start(common_time, TRACE_VECT_MUL);
+    vect_mul(&tmp2, &r2, &s);
+    trace_stop(common_time, TRACE_VECT_MUL);
+    vect_add(&tmp2, &e, &tmp2);
+    vect_resize(v, P::n1n2, &tmp2);
+    end = trace_stop(common_time, TRACE_VECT_OPERATION);
     common_time->vect_operation_time += ((uint32_t)(end - start));
 
+    // Compute v = m.G + s.r2 + e by adding the encoded message to v
+    code_encode_xor<P>(v->words, m, common_time); //rs-rm encoding
+
     #ifdef VERBOSE
-        printf("\n\nh: "); vect_print(h, VEC_N_SIZE_BYTES);
-        printf("\n\ns: "); vect_print(s, VEC_N_SIZE_BYTES);
-        printf("\n\nr1: "); vect_print(r1, VEC_N_SIZE_BYTES);
-        printf("\n\nr2: "); vect_print(r2, VEC_N_SIZE_BYTES);
-        printf("\n\ne: "); vect_print(e, VEC_N_SIZE_BYTES);
-        printf("\n\ntmp2: "); vect_print(tmp2, VEC_N_SIZE_BYTES);
-
-        printf("\n\nu: "); vect_print(u, VEC_N_SIZE_BYTES);
-        printf("\n\nv: "); vect_print(v, VEC_N1N2_SIZE_BYTES);
+        printf("\n\nh: "); vect_print<P>(h.words, P::vec_n_size_bytes);
+        printf("\n\ns: "); vect_print<P>(s.words, P::vec_n_size_bytes);
+        printf("\n\nr1: "); vect_print<P>(r1.words, P::vec_n_size_bytes);
+        printf("\n\nr2: "); vect_print<P>(r2.words, P::vec_n_size_bytes);
+        printf("\n\ne: "); vect_print<P>(e.words, P::vec_n_size_bytes);
+        printf("\n\ntmp2: "); vect_print<P>(tmp2.words, P::vec_n_size_bytes);
+
+        printf("\n\nu: "); vect_print<P>(u->words, P::vec_n_size_bytes);
+        printf("\n\nv: "); vect_print<P>(v->words, P::vec_n1n2_size_bytes);
     #endif
 }
 
 
-void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta, const unsigned char *pk) {
+template <class P>
+void hqc_pke_encrypt(padded_vect<P> *u, padded_vect<P> *v, uint64_t *m, unsigned char *theta, const unsigned char *pk) {
     seedexpander_state seedexpander;
-    uint64_t h[VEC_N_SIZE_64] = {0};
-    uint64_t s[VEC_N_SIZE_64] = {0};
-    uint64_t r1[VEC_N_SIZE_64] = {0};
-    uint64_t r2[VEC_N_SIZE_64] = {0};
-    uint64_t e[VEC_N_SIZE_64] = {0};
-    uint64_t tmp1[VEC_N_SIZE_64] = {0};
-    uint64_t tmp2[VEC_N_SIZE_64] = {0};
+    padded_vect<P> h = {};
+    padded_vect<P> s = {};
+    padded_vect<P> r1 = {};
+    padded_vect<P> r2 = {};
+    padded_vect<P> e = {};
+    padded_vect<P> tmp2 = {};
 
     // Create seed_expander from theta
-    seedexpander_init(&seedexpander, theta, SEED_BYTES); //Shake 256 처리
+    seedexpander_init(&seedexpander, theta, P::seed_bytes); //Shake 256 처리
 
     // Retrieve h and s from public key
-    hqc_public_key_from_string(h, s, pk); //h, s 추출?
+    hqc_public_key_from_string(&h, &s, pk); //h, s 추출?
 
     // Generate r1, r2 and e
-    vect_set_random_fixed_weight(&seedexpander, r1, PARAM_OMEGA_R);
-    vect_set_random_fixed_weight(&seedexpander, r2, PARAM_OMEGA_R);
-    vect_set_random_fixed_weight(&seedexpander, e, PARAM_OMEGA_E);
+    vect_set_random_fixed_weight<P>(&seedexpander, r1.words, P::omega_r);
+    vect_set_random_fixed_weight<P>(&seedexpander, r2.words, P::omega_r);
+    vect_set_random_fixed_weight<P>(&seedexpander, e.words, P::omega_e);
     //r1, r2, e 벡터생성
 
     // Compute u = r1 + r2.h
-    vect_mul(u, r2, h);
-    vect_add(u, r1, u, VEC_N_SIZE_64); //u 연산
+    vect_mul(u, &r2, &h);
+    vect_add(u, &r1, u); //u 연산
 
-    // Compute v = m.G by encoding the message
-    code_encode(v, m); //rs-rm encoding
-    vect_resize(tmp1, PARAM_N, v, PARAM_N1N2);
+    // Compute v = s.r2 + e truncated to P::n1n2 bits
+    vect_mul(&tmp2, &r2, &s);
+    vect_add(&tmp2, &e, &tmp2);
+    vect_resize(v, P::n1n2, &tmp2);
 
-    // Compute v = m.G + s.r2 + e
-    vect_mul(tmp2, r2, s);
-    vect_add(tmp2, e, tmp2, VEC_N_SIZE_64);
-    vect_add(tmp2, tmp1, tmp2, VEC_N_SIZE_64);
-    vect_resize(v, PARAM_N1N2, tmp2, PARAM_N);
+    // Compute v = m.G + s.r2 + e by adding the encoded message to v
+    code_encode_xor<P>(v->words, m); //rs-rm encoding
 
     #ifdef VERBOSE
-        printf("\n\nh: "); vect_print(h, VEC_N_SIZE_BYTES);
-        printf("\n\ns: "); vect_print(s, VEC_N_SIZE_BYTES);
-        printf("\n\nr1: "); vect_print(r1, VEC_N_SIZE_BYTES);
-        printf("\n\nr2: "); vect_print(r2, VEC_N_SIZE_BYTES);
-        printf("\n\ne: "); vect_print(e, VEC_N_SIZE_BYTES);
-        printf("\n\ntmp2: "); vect_print(tmp2, VEC_N_SIZE_BYTES);
-
-        printf("\n\nu: "); vect_print(u, VEC_N_SIZE_BYTES);
-        printf("\n\nv: "); vect_print(v, VEC_N1N2_SIZE_BYTES);
+        printf("\n\nh: "); vect_print<P>(h.words, P::vec_n_size_bytes);
+        printf("\n\ns: "); vect_print<P>(s.words, P::vec_n_size_bytes);
+        printf("\n\nr1: "); vect_print<P>(r1.words, P::vec_n_size_bytes);
+        printf("\n\nr2: "); vect_print<P>(r2.words, P::vec_n_size_bytes);
+        printf("\n\ne: "); vect_print<P>(e.words, P::vec_n_size_bytes);
+        printf("\n\ntmp2: "); vect_print<P>(tmp2.words, P::vec_n_size_bytes);
+
+        printf("\n\nu: "); vect_print<P>(u->words, P::vec_n_size_bytes);
+        printf("\n\nv: "); vect_print<P>(v->words, P::vec_n1n2_size_bytes);
     #endif
 }
 
 
+/**
+ * @brief Encryption of the HQC_PKE IND_CPA scheme spread over the decapsulation helpers
+ *
+ * Produces the same ciphertext as the serial encryption. Once r1 and r2 are drawn,
+ * helper 0 computes r2.s, helper 1 draws e and encodes m, and the caller computes r2.h.
+ * Without helpers the three steps run one after the other on the caller.
+ *
+ * @param[out] u Vector u (first part of the ciphertext)
+ * @param[out] v Vector v (second part of the ciphertext)
+ * @param[in] m Vector representing the message to encrypt
+ * @param[in] theta Seed used to derive randomness required for encryption
+ * @param[in] h Vector h of the public key
+ * @param[in] s Vector s of the public key
+ * @param[in] helpers Helper threads, idle on entry and on return, or nullptr
+ */
+void hqc_pke_encrypt_low_latency(aligned_vect *u, aligned_vect *v, uint64_t *m, unsigned char *theta, const aligned_vect *h, const aligned_vect *s, Decaps_helpers *helpers) {
+    Noise_task noise;
+    aligned_vect r1 = {};
+    aligned_vect r2 = {};
+    aligned_vect tmp2 = {};
+    aligned_vect tmp3 = {};
+
+    // Generate r1 and r2, e is drawn by helper 1 from a copy of the seedexpander
+    seedexpander_init(&noise.seedexpander, theta, SEED_BYTES);
+    vect_set_random_fixed_weight<hqc128_params>(&noise.seedexpander, r1.words, PARAM_OMEGA_R);
+    vect_set_random_fixed_weight<hqc128_params>(&noise.seedexpander, r2.words, PARAM_OMEGA_R);
+
+    Mul_task product = {&tmp2, &r2, s};
+    noise.v = v;
+    noise.m = m;
+    if (helpers == nullptr) {
+        mul_task(&product);
+        noise_task(&noise);
+    } else {
+        helpers->post(0, mul_task, &product);
+        helpers->post(1, noise_task, &noise);
+    }
+
+    // Compute u = r1 + r2.h
+    vect_mul(u, &r2, h);
+    vect_add(u, &r1, u);
+
+    // Compute v = m.G + e + s.r2 truncated to PARAM_N1N2 bits
+    if (helpers != nullptr) {
+        helpers->wait(0);
+        helpers->wait(1);
+    }
+    vect_resize(&tmp3, PARAM_N1N2, &tmp2);
+    vect_add(v, v, &tmp3);
+}
+
+
+
+/**
+ * @brief Encryption of the HQC_PKE IND_CPA scheme working in a caller-provided workspace
+ *
+ * Same ciphertext as the other encryptions, without heap allocation and with a small stack footprint.
+ * u and v may point into the workspace, but not at the vectors used here.
+ *
+ * @param[out] u Vector u (first part of the ciphertext)
+ * @param[out] v Vector v (second part of the ciphertext)
+ * @param[in] m Vector representing the message to encrypt
+ * @param[in] theta Seed used to derive randomness required for encryption
+ * @param[in] pk String containing the public key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ */
+void hqc_pke_encrypt(aligned_vect *u, aligned_vect *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, hqc_workspace *workspace) {
+    // Retrieve h and s from public key
+    hqc_public_key_from_string(&workspace->h, &workspace->s, pk);
+
+    hqc_pke_encrypt(u, v, m, theta, &workspace->h, &workspace->s, workspace);
+}
+
+
+
+/**
+ * @brief Encryption of the HQC_PKE IND_CPA scheme with an expanded public key, working in a caller-provided workspace
+ *
+ * @param[out] u Vector u (first part of the ciphertext)
+ * @param[out] v Vector v (second part of the ciphertext)
+ * @param[in] m Vector representing the message to encrypt
+ * @param[in] theta Seed used to derive randomness required for encryption
+ * @param[in] h Vector h of the public key
+ * @param[in] s Vector s of the public key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ */
+void hqc_pke_encrypt(aligned_vect *u, aligned_vect *v, uint64_t *m, unsigned char *theta, const aligned_vect *h, const aligned_vect *s, hqc_workspace *workspace) {
+    seedexpander_state seedexpander;
+    aligned_vect *r1 = &workspace->r1;
+    aligned_vect *r2 = &workspace->r2;
+    aligned_vect *e = &workspace->e;
+    aligned_vect *tmp2 = &workspace->tmp2;
+
+    // Create seed_expander from theta
+    seedexpander_init(&seedexpander, theta, SEED_BYTES);
+
+    // Generate r1, r2 and e
+    memset(r1, 0, sizeof(aligned_vect));
+    memset(r2, 0, sizeof(aligned_vect));
+    memset(e, 0, sizeof(aligned_vect));
+    vect_set_random_fixed_weight(&seedexpander, r1->words, PARAM_OMEGA_R, &workspace->sampling);
+    vect_set_random_fixed_weight(&seedexpander, r2->words, PARAM_OMEGA_R, &workspace->sampling);
+    vect_set_random_fixed_weight(&seedexpander, e->words, PARAM_OMEGA_E, &workspace->sampling);
+
+    // Compute u = r1 + r2.h
+    vect_mul(u, r2, h, workspace->mul);
+    vect_add(u, r1, u);
+
+    // Compute v = s.r2 + e truncated to PARAM_N1N2 bits
+    vect_mul(tmp2, r2, s, workspace->mul);
+    vect_add(tmp2, e, tmp2);
+    vect_resize(v, PARAM_N1N2, tmp2);
+
+    // Compute v = m.G + s.r2 + e by adding the encoded message to v
+    code_encode_xor<hqc128_params>(v->words, m);
+}
+
+
+
 /**
  * @brief Decryption of the HQC_PKE IND_CPA scheme
  *
@@ -236,70 +494,136 @@ void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta
  * @param[in] sk String containing the secret key
  * @returns 0 
  */
-uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const uint64_t *u, const uint64_t *v, const uint8_t *sk, Trace_time* decap_time) {
-    uint64_t x[VEC_N_SIZE_64] = {0};
-    uint64_t y[VEC_N_SIZE_64] = {0};
-    uint8_t pk[PUBLIC_KEY_BYTES] = {0};
-    uint64_t tmp1[VEC_N_SIZE_64] = {0};
-    uint64_t tmp2[VEC_N_SIZE_64] = {0};
+template <class P>
+uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const padded_vect<P> *u, const padded_vect<P> *v, const uint8_t *sk, Trace_time* decap_time) {
+    padded_vect<P> x = {};
+    padded_vect<P> y = {};
+    uint8_t pk[P::public_key_bytes] = {0};
+    padded_vect<P> tmp1 = {};
+    padded_vect<P> tmp2 = {};
     clock_t start, end;
 
     // Retrieve x, y, pk from secret key
-    hqc_secret_key_from_string(x, y, sigma, pk, sk, decap_time);
+    hqc_secret_key_from_string(&x, &y, sigma, pk, sk, decap_time);
     //두번의 벡터 생성과 시드 작업
 
     // Compute v - u.y
-    start = clock();
-    vect_resize(tmp1, PARAM_N, v, PARAM_N1N2);
-    vect_mul(tmp2, y, u);
-    vect_add(tmp2, tmp1, tmp2, VEC_N_SIZE_64);
-    end = clock();
+    start = trace_start(decap_time, TRACE_VECT_OPERATION);
+    vect_resize(&tmp1, P::n, v);
+    trace_start(decap_time, TRACE_VECT_MUL);
+    vect_mul(&tmp2, &y, u);
+    trace_stop(decap_time, TRACE_VECT_MUL);
+    vect_add(&tmp2, &tmp1, &tmp2);
+    end = trace_stop(decap_time, TRACE_VECT_OPERATION);
     decap_time->vect_operation_time += ((uint32_t)(end - start));
     // decap_time 
     // 사이즈 변경 및 계산
 
     #ifdef VERBOSE
-        printf("\n\nu: "); vect_print(u, VEC_N_SIZE_BYTES);
-        printf("\n\nv: "); vect_print(v, VEC_N1N2_SIZE_BYTES);
-        printf("\n\ny: "); vect_print(y, VEC_N_SIZE_BYTES);
-        printf("\n\nv - u.y: "); vect_print(tmp2, VEC_N_SIZE_BYTES);
+        printf("\n\nu: "); vect_print<P>(u->words, P::vec_n_size_bytes);
+        printf("\n\nv: "); vect_print<P>(v->words, P::vec_n1n2_size_bytes);
+        printf("\n\ny: "); vect_print<P>(y.words, P::vec_n_size_bytes);
+        printf("\n\nv - u.y: "); vect_print<P>(tmp2.words, P::vec_n_size_bytes);
     #endif
 
     // Compute m by decoding v - u.y
-    code_decode(m, tmp2, decap_time);
+    code_decode<P>(m, tmp2.words, decap_time);
 
     //rm-rs decoding 연산
     
     return 0;
 }
 
-uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const uint64_t *u, const uint64_t *v, const uint8_t *sk) {
-    uint64_t x[VEC_N_SIZE_64] = {0};
-    uint64_t y[VEC_N_SIZE_64] = {0};
-    uint8_t pk[PUBLIC_KEY_BYTES] = {0};
-    uint64_t tmp1[VEC_N_SIZE_64] = {0};
-    uint64_t tmp2[VEC_N_SIZE_64] = {0};
+template <class P>
+uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const padded_vect<P> *u, const padded_vect<P> *v, const uint8_t *sk) {
+    padded_vect<P> x = {};
+    padded_vect<P> y = {};
+    uint8_t pk[P::public_key_bytes] = {0};
+    padded_vect<P> tmp1 = {};
+    padded_vect<P> tmp2 = {};
 
     // Retrieve x, y, pk from secret key
-    hqc_secret_key_from_string(x, y, sigma, pk, sk);
+    hqc_secret_key_from_string(&x, &y, sigma, pk, sk);
     //두번의 벡터 생성과 시드 작업
 
     // Compute v - u.y
-    vect_resize(tmp1, PARAM_N, v, PARAM_N1N2);
-    vect_mul(tmp2, y, u);
-    vect_add(tmp2, tmp1, tmp2, VEC_N_SIZE_64);
+    vect_resize(&tmp1, P::n, v);
+    vect_mul(&tmp2, &y, u);
+    vect_add(&tmp2, &tmp1, &tmp2);
     // 사이즈 변경 및 계산
 
     #ifdef VERBOSE
-        printf("\n\nu: "); vect_print(u, VEC_N_SIZE_BYTES);
-        printf("\n\nv: "); vect_print(v, VEC_N1N2_SIZE_BYTES);
-        printf("\n\ny: "); vect_print(y, VEC_N_SIZE_BYTES);
-        printf("\n\nv - u.y: "); vect_print(tmp2, VEC_N_SIZE_BYTES);
+        printf("\n\nu: "); vect_print<P>(u->words, P::vec_n_size_bytes);
+        printf("\n\nv: "); vect_print<P>(v->words, P::vec_n1n2_size_bytes);
+        printf("\n\ny: "); vect_print<P>(y.words, P::vec_n_size_bytes);
+        printf("\n\nv - u.y: "); vect_print<P>(tmp2.words, P::vec_n_size_bytes);
     #endif
 
     // Compute m by decoding v - u.y
-    code_decode(m, tmp2);
+    code_decode<P>(m, tmp2.words);
     //rm-rs decoding 연산
     
     return 0;
 }
+
+
+
+/**
+ * @brief Decryption of the HQC_PKE IND_CPA scheme working in a caller-provided workspace
+ *
+ * Same message as the other decryptions, without heap allocation and with a small stack footprint.
+ * The public key stored in sk is copied to the pk field of the workspace.
+ *
+ * @param[out] m Vector representing the decrypted message
+ * @param[out] sigma String used in HHK transform
+ * @param[in] u Vector u (first part of the ciphertext)
+ * @param[in] v Vector v (second part of the ciphertext)
+ * @param[in] sk String containing the secret key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0
+ */
+uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const aligned_vect *u, const aligned_vect *v, const uint8_t *sk, hqc_workspace *workspace) {
+    // Retrieve x, y, pk from secret key
+    hqc_secret_key_from_string(&workspace->x, &workspace->y, sigma, workspace->pk, sk, &workspace->sampling);
+
+    return hqc_pke_decrypt(m, u, v, &workspace->y, workspace);
+}
+
+
+
+/**
+ * @brief Decryption of the HQC_PKE IND_CPA scheme with an expanded secret key, working in a caller-provided workspace
+ *
+ * @param[out] m Vector representing the decrypted message
+ * @param[in] u Vector u (first part of the ciphertext)
+ * @param[in] v Vector v (second part of the ciphertext)
+ * @param[in] y Vector y of the secret key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0
+ */
+uint8_t hqc_pke_decrypt(uint64_t *m, const aligned_vect *u, const aligned_vect *v, const aligned_vect *y, hqc_workspace *workspace) {
+    aligned_vect *tmp1 = &workspace->tmp1;
+    aligned_vect *tmp2 = &workspace->tmp2;
+
+    // Compute v - u.y
+    vect_resize(tmp1, PARAM_N, v);
+    vect_mul(tmp2, y, u, workspace->mul);
+    vect_add(tmp2, tmp1, tmp2);
+
+    // Compute m by decoding v - u.y
+    code_decode<hqc128_params>(m, tmp2->words);
+
+    return 0;
+}
+
+
+
+#define INSTANTIATE_HQC(P) \
+    template void hqc_pke_keygen<P>(unsigned char *, unsigned char *, Trace_time *); \
+    template void hqc_pke_keygen<P>(unsigned char *, unsigned char *); \
+    template void hqc_pke_encrypt<P>(padded_vect<P> *, padded_vect<P> *, uint64_t *, unsigned char *, const unsigned char *, Trace_time *); \
+    template void hqc_pke_encrypt<P>(padded_vect<P> *, padded_vect<P> *, uint64_t *, unsigned char *, const unsigned char *); \
+    template uint8_t hqc_pke_decrypt<P>(uint64_t *, uint8_t *, const padded_vect<P> *, const padded_vect<P> *, const uint8_t *, Trace_time *); \
+    template uint8_t hqc_pke_decrypt<P>(uint64_t *, uint8_t *, const padded_vect<P> *, const padded_vect<P> *, const uint8_t *);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_HQC)
@@ -8,11 +8,22 @@
 
 #include <stdint.h>
 #include "profiling.h"
+#include "vector.h"
 
-void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, Trace_time *keygen_time);
-void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta, const unsigned char *pk);
-void hqc_pke_encrypt(uint64_t *u, uint64_t *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, Trace_time* common_time);
-uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const uint64_t *u, const uint64_t *v, const uint8_t *sk);
-uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const uint64_t *u, const uint64_t *v, const uint8_t *sk, Trace_time* decap_time);
+class Decaps_helpers;
+struct hqc_workspace;
+
+template <class P> void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, Trace_time *keygen_time);
+template <class P> void hqc_pke_keygen(unsigned char* pk, unsigned char* sk);
+void hqc_pke_keygen(unsigned char* pk, unsigned char* sk, hqc_workspace *workspace);
+template <class P> void hqc_pke_encrypt(padded_vect<P> *u, padded_vect<P> *v, uint64_t *m, unsigned char *theta, const unsigned char *pk);
+template <class P> void hqc_pke_encrypt(padded_vect<P> *u, padded_vect<P> *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, Trace_time* common_time);
+void hqc_pke_encrypt_low_latency(aligned_vect *u, aligned_vect *v, uint64_t *m, unsigned char *theta, const aligned_vect *h, const aligned_vect *s, Decaps_helpers *helpers);
+void hqc_pke_encrypt(aligned_vect *u, aligned_vect *v, uint64_t *m, unsigned char *theta, const unsigned char *pk, hqc_workspace *workspace);
+void hqc_pke_encrypt(aligned_vect *u, aligned_vect *v, uint64_t *m, unsigned char *theta, const aligned_vect *h, const aligned_vect *s, hqc_workspace *workspace);
+template <class P> uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const padded_vect<P> *u, const padded_vect<P> *v, const uint8_t *sk);
+template <class P> uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const padded_vect<P> *u, const padded_vect<P> *v, const uint8_t *sk, Trace_time* decap_time);
+uint8_t hqc_pke_decrypt(uint64_t *m, uint8_t *sigma, const aligned_vect *u, const aligned_vect *v, const uint8_t *sk, hqc_workspace *workspace);
+uint8_t hqc_pke_decrypt(uint64_t *m, const aligned_vect *u, const aligned_vect *v, const aligned_vect *y, hqc_workspace *workspace);
 
 #endif
\ No newline at end of file
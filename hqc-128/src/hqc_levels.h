@@ -0,0 +1,45 @@
+#ifndef HQC_LEVELS_H
+#define HQC_LEVELS_H
+
+/**
+ * @file hqc_levels.h
+ * @brief HQC_KEM templated on a parameter set of parameter_set.h
+ *
+ * The code, PKE and KEM layers are templated on the parameter set and instantiated
+ * for hqc128_params, hqc192_params and hqc256_params, so that HQC-128, HQC-192 and HQC-256
+ * can be linked side by side. kem.cpp instantiates Kem for the three of them.
+ *
+ * Randomness is drawn from shake_prng, and the KEM of api.h is Kem<hqc128_params>,
+ * so that Kem<hqc128_params> produces the keys, ciphertexts and shared secrets of the KATs of api.h.
+ */
+
+#include "parameter_set.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace hqc {
+
+/**
+ * HQC_KEM IND_CCA2 scheme of a parameter set
+ */
+template <class P>
+class Kem {
+    public:
+        typedef P params;
+        static constexpr size_t public_key_bytes = P::public_key_bytes;
+        static constexpr size_t secret_key_bytes = P::secret_key_bytes;
+        static constexpr size_t ciphertext_bytes = P::ciphertext_bytes;
+        static constexpr size_t shared_secret_bytes = P::shared_secret_bytes;
+
+        static int keypair(uint8_t *pk, uint8_t *sk);
+        static int encapsulate(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
+        static int decapsulate(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
+};
+
+extern template class Kem<hqc128_params>;
+extern template class Kem<hqc192_params>;
+extern template class Kem<hqc256_params>;
+
+} // namespace hqc
+
+#endif
@@ -4,13 +4,17 @@
  */
 
 #include "api.h"
+#include "decaps_helpers.h"
 #include "hqc.h"
+#include "hqc_levels.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include "parsing.h"
 #include "shake_ds.h"
 #include "fips202.h"
 #include "vector.h"
 #include "profiling.h"
+#include "workspace.h"
 #include <stdint.h>
 #include <string.h>
 #include <time.h>
@@ -18,9 +22,117 @@
 #include <stdio.h>
 #endif
 
+struct Public_key_task {
+    aligned_vect *h;
+    aligned_vect *s;
+    const uint8_t *pk;
+};
+
+static void public_key_task(void *context);
+static void clear_secrets(hqc_workspace *workspace);
+static int decapsulate(unsigned char *ss, const unsigned char *ct, const uint8_t *pk, const uint8_t *sigma, const aligned_vect *y, const aligned_vect *h, const aligned_vect *s, hqc_workspace *workspace);
+
 
 /**
- * @brief Keygen of the HQC_KEM IND_CAA2 scheme
+ * @brief Helper task expanding the public key into h and s
+ *
+ * @param[in] context Pointer to a Public_key_task
+ */
+static void public_key_task(void *context) {
+    Public_key_task *task = (Public_key_task *) context;
+    hqc_public_key_from_string(task->h, task->s, task->pk);
+}
+
+
+
+/**
+ * @brief Overwrites with zeros the members of a workspace that hold secret values
+ *
+ * Called at the end of every workspace call, so that only public values (u, v, u2, v2, the salt,
+ * h, s and pk) outlive it. memset is called through a volatile pointer so that the stores are not dropped as dead.
+ *
+ * @param[out] workspace Workspace to clear
+ */
+static void clear_secrets(hqc_workspace *workspace) {
+    static void *(*const volatile zero)(void *, int, size_t) = memset;
+
+    zero(workspace->m, 0, sizeof(workspace->m));
+    zero(workspace->sigma, 0, sizeof(workspace->sigma));
+    zero(workspace->theta, 0, sizeof(workspace->theta));
+    zero(workspace->hash_input, 0, sizeof(workspace->hash_input));
+    zero(&workspace->x, 0, sizeof(aligned_vect));
+    zero(&workspace->y, 0, sizeof(aligned_vect));
+    zero(&workspace->r1, 0, sizeof(aligned_vect));
+    zero(&workspace->r2, 0, sizeof(aligned_vect));
+    zero(&workspace->e, 0, sizeof(aligned_vect));
+    zero(&workspace->tmp1, 0, sizeof(aligned_vect));
+    zero(&workspace->tmp2, 0, sizeof(aligned_vect));
+    zero(workspace->mul, 0, sizeof(workspace->mul));
+    zero(&workspace->sampling, 0, sizeof(workspace->sampling));
+}
+
+
+
+/**
+ * @brief Decapsulation working in a caller-provided workspace, from the expanded secret key
+ *
+ * @param[out] ss String containing the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] pk String containing the public key
+ * @param[in] sigma String used in HHK transform
+ * @param[in] y Vector y of the secret key
+ * @param[in] h Vector h of the public key
+ * @param[in] s Vector s of the public key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0 if decapsulation is successful, -1 otherwise
+ */
+static int decapsulate(unsigned char *ss, const unsigned char *ct, const uint8_t *pk, const uint8_t *sigma, const aligned_vect *y, const aligned_vect *h, const aligned_vect *s, hqc_workspace *workspace) {
+    uint8_t result;
+    aligned_vect *u = &workspace->u;
+    aligned_vect *v = &workspace->v;
+    uint8_t *m = (uint8_t *) workspace->m;
+    uint8_t *tmp = workspace->hash_input;
+    uint8_t *mc = workspace->hash_input;
+    shake256incctx shake256state;
+
+    // Retrieving u, v and d from ciphertext
+    hqc_ciphertext_from_string(u, v, workspace->salt, ct);
+
+    // Decrypting
+    result = hqc_pke_decrypt(workspace->m, u, v, y, workspace);
+
+    // Computing theta
+    memcpy(tmp, m, VEC_K_SIZE_BYTES);
+    memcpy(tmp + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
+    memcpy(tmp + VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES, workspace->salt, SALT_SIZE_BYTES);
+    shake256_512_ds(&shake256state, workspace->theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
+
+    // Encrypting m'
+    hqc_pke_encrypt(&workspace->u2, &workspace->v2, workspace->m, workspace->theta, h, s, workspace);
+
+    // Check if c != c'
+    result |= vect_compare(u, &workspace->u2);
+    result |= vect_compare(v, &workspace->v2);
+
+    result -= 1;
+
+    for (size_t i = 0; i < VEC_K_SIZE_BYTES; ++i) {
+        mc[i] = (m[i] & result) ^ (sigma[i] & ~result);
+    }
+
+    // Computing shared secret
+    memcpy(mc + VEC_K_SIZE_BYTES, u->words, VEC_N_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v->words, VEC_N1N2_SIZE_BYTES);
+    shake256_512_ds(&shake256state, ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
+
+    clear_secrets(workspace);
+    return (result & 1) - 1;
+}
+
+
+
+/**
+ * @brief Keygen of the HQC_KEM IND_CAA2 scheme of the parameter set P
  *
  * The public key is composed of the syndrome <b>s</b> as well as the seed used to generate the vector <b>h</b>.
  *
@@ -31,137 +143,258 @@
  * @param[out] sk String containing the secret key
  * @returns 0 if keygen is successful
  */
-int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, Trace_time* keygen_time) {
+template <class P>
+int hqc::Kem<P>::keypair(uint8_t *pk, uint8_t *sk) {
     #ifdef VERBOSE
         printf("\n\n\n\n### KEYGEN ###");
     #endif
 
-    hqc_pke_keygen(pk, sk, keygen_time);
+    hqc_pke_keygen<P>(pk, sk);
     return 0;
 }
 
 
 
 /**
- * @brief Encapsulation of the HQC_KEM IND_CAA2 scheme
+ * @brief Encapsulation of the HQC_KEM IND_CAA2 scheme of the parameter set P
  *
  * @param[out] ct String containing the ciphertext
  * @param[out] ss String containing the shared secret
  * @param[in] pk String containing the public key
  * @returns 0 if encapsulation is successful
  */
-int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, Trace_time* encap_time) {
+template <class P>
+int hqc::Kem<P>::encapsulate(uint8_t *ct, uint8_t *ss, const uint8_t *pk) {
     #ifdef VERBOSE
         printf("\n\n\n\n### ENCAPS ###");
     #endif
 
     uint8_t theta[SHAKE256_512_BYTES] = {0};
-    uint8_t m[VEC_K_SIZE_BYTES] = {0};
-    uint64_t u[VEC_N_SIZE_64] = {0};
-    uint64_t v[VEC_N1N2_SIZE_64] = {0};
-    uint8_t mc[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES] = {0};
-    uint64_t salt[SALT_SIZE_64] = {0};
-    uint8_t tmp[VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES] = {0};
+    uint8_t m[P::vec_k_size_bytes] = {0};
+    padded_vect<P> u = {};
+    padded_vect<P> v = {};
+    uint8_t mc[P::vec_k_size_bytes + P::vec_n_size_bytes + P::vec_n1n2_size_bytes] = {0};
+    uint64_t salt[P::salt_size_64] = {0};
+    uint8_t tmp[P::vec_k_size_bytes + P::public_key_bytes + P::salt_size_bytes] = {0};
     shake256incctx shake256state;
-    clock_t start, end;
-    encap_time->stack += 1;
+
     // Computing m
-    
-    start = clock();
-    vect_set_random_from_prng((uint64_t *)m, VEC_K_SIZE_64); // shake_prng, generate random vector
-    vect_set_random_from_prng(salt, SALT_SIZE_64); // Computing theta
-    end = clock();
-    encap_time->shake_prng_time += ((uint32_t)(end - start));
+    vect_set_random_from_prng((uint64_t *)m, P::vec_k_size_64); // shake_prng, generate random vector
 
-    start = clock();
-    memcpy(tmp, m, VEC_K_SIZE_BYTES);
-    memcpy(tmp + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
-    memcpy(tmp + VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES, salt, SALT_SIZE_BYTES);
-    end = clock();
-    encap_time->parsing_time += ((uint32_t) (end - start));
-    
-    
-    start = clock();
+    // Computing theta
+    vect_set_random_from_prng(salt, P::salt_size_64);
+    memcpy(tmp, m, P::vec_k_size_bytes);
+    memcpy(tmp + P::vec_k_size_bytes, pk, P::public_key_bytes);
+    memcpy(tmp + P::vec_k_size_bytes + P::public_key_bytes, salt, P::salt_size_bytes);
     //tmp에 m, pk, salt 들어있음, m과 salt는 랜덤벡터에 해당됨
-    shake256_512_ds(&shake256state, theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
-    end = clock();
-    encap_time->shake256_512_ds_time += ((uint32_t) (end - start));
-    
+    shake256_512_ds(&shake256state, theta, tmp, P::vec_k_size_bytes + P::public_key_bytes + P::salt_size_bytes, G_FCT_DOMAIN);
     //tmp를 shake 256처리해서 theta에 넣어줌
     // Encrypting m
-    hqc_pke_encrypt(u, v, (uint64_t *)m, theta, pk, encap_time);
+    hqc_pke_encrypt(&u, &v, (uint64_t *)m, theta, pk);
     //random generation이랑, rs-rm encoding, 그리고 벡터연산 몇개 포함됨
 
     // Computing shared secret
-    start = clock();
-    memcpy(mc, m, VEC_K_SIZE_BYTES);
-    memcpy(mc + VEC_K_SIZE_BYTES, u, VEC_N_SIZE_BYTES);
-    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v, VEC_N1N2_SIZE_BYTES);
-    end = clock();
-    encap_time->parsing_time += ((uint32_t)(end - start));
-    
-    start = clock();
-    shake256_512_ds(&shake256state, ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
-    end = clock();
-    encap_time->shake256_512_ds_time += ((uint32_t)(end - start));
-    
+    memcpy(mc, m, P::vec_k_size_bytes);
+    memcpy(mc + P::vec_k_size_bytes, u.words, P::vec_n_size_bytes);
+    memcpy(mc + P::vec_k_size_bytes + P::vec_n_size_bytes, v.words, P::vec_n1n2_size_bytes);
+    shake256_512_ds(&shake256state, ss, mc, P::vec_k_size_bytes + P::vec_n_size_bytes + P::vec_n1n2_size_bytes, K_FCT_DOMAIN);
     // mc에 m, u, v 넣은다음 shake shake해서 ss에 대입해줌
     // Computing ciphertext
-    start = clock();
-    hqc_ciphertext_to_string(ct, u, v, salt); 
-    end = clock();
-    encap_time->parsing_time += ((uint32_t)(end - start));
+    hqc_ciphertext_to_string(ct, &u, &v, salt); 
     //ct에 u, v, salt넣어줌
     // ss, ct return
 
     #ifdef VERBOSE
-        printf("\n\npk: "); for(int i = 0 ; i < PUBLIC_KEY_BYTES ; ++i) printf("%02x", pk[i]);
+        printf("\n\npk: "); for(size_t i = 0 ; i < P::public_key_bytes ; ++i) printf("%02x", pk[i]);
         printf("\n\ntheta: "); for(int i = 0 ; i < SHAKE256_512_BYTES ; ++i) printf("%02x", theta[i]);
-        printf("\n\nciphertext: "); for(int i = 0 ; i < CIPHERTEXT_BYTES ; ++i) printf("%02x", ct[i]);
-        printf("\n\nsecret 1: "); for(int i = 0 ; i < SHARED_SECRET_BYTES ; ++i) printf("%02x", ss[i]);
+        printf("\n\nciphertext: "); for(size_t i = 0 ; i < P::ciphertext_bytes ; ++i) printf("%02x", ct[i]);
+        printf("\n\nsecret 1: "); for(size_t i = 0 ; i < P::shared_secret_bytes ; ++i) printf("%02x", ss[i]);
     #endif
 
     return 0;
 }
 
 
-int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk) {
+
+/**
+ * @brief Decapsulation of the HQC_KEM IND_CAA2 scheme of the parameter set P
+ *
+ * @param[out] ss String containing the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @returns 0 if decapsulation is successful, -1 otherwise
+ */
+template <class P>
+int hqc::Kem<P>::decapsulate(uint8_t *ss, const uint8_t *ct, const uint8_t *sk) {
+    #ifdef VERBOSE
+        printf("\n\n\n\n### DECAPS ###");
+    #endif
+
+    uint8_t result;
+    padded_vect<P> u = {};
+    padded_vect<P> v = {};
+    uint8_t pk[P::public_key_bytes] = {0};
+    uint8_t m[P::vec_k_size_bytes] = {0};
+    uint8_t sigma[P::vec_k_size_bytes] = {0};
+    uint8_t theta[SHAKE256_512_BYTES] = {0};
+    padded_vect<P> u2 = {};
+    padded_vect<P> v2 = {};
+    uint8_t mc[P::vec_k_size_bytes + P::vec_n_size_bytes + P::vec_n1n2_size_bytes] = {0};
+    uint64_t salt[P::salt_size_64] = {0};
+    uint8_t tmp[P::vec_k_size_bytes + P::public_key_bytes + P::salt_size_bytes] = {0};
+    shake256incctx shake256state;
+
+    // Retrieving u, v and d from ciphertext
+    hqc_ciphertext_from_string(&u, &v, salt, ct);
+    //encryption에서 ct에 u, v, salt를 넣어줬었는데 반대로 분리해주는 과정
+
+    // Retrieving pk from sk
+    memcpy(pk, sk + P::seed_bytes + P::vec_k_size_bytes, P::public_key_bytes);
+    // pk 가져오기
+
+    // Decrypting
+    result = hqc_pke_decrypt((uint64_t *)m, sigma, &u, &v, sk);
+    // 몇가지 랜덤 처리와 마지막 rs-rm decoding 연산이 포함되어있음
+
+    // Computing theta
+    memcpy(tmp, m, P::vec_k_size_bytes);
+    memcpy(tmp + P::vec_k_size_bytes, pk, P::public_key_bytes);
+    memcpy(tmp + P::vec_k_size_bytes + P::public_key_bytes, salt, P::salt_size_bytes);
+    shake256_512_ds(&shake256state, theta, tmp, P::vec_k_size_bytes + P::public_key_bytes + P::salt_size_bytes, G_FCT_DOMAIN);
+
+    // Encrypting m'
+    hqc_pke_encrypt(&u2, &v2, (uint64_t *)m, theta, pk);
+    //3번의 랜덤 생성, rs-rm encoding, 그밖의 벡터 연산
+
+    // Check if c != c'
+    result |= vect_compare(&u, &u2);
+    result |= vect_compare(&v, &v2);
+
+    result -= 1;
+
+    for (size_t i = 0; i < P::vec_k_size_bytes; ++i) {
+        mc[i] = (m[i] & result) ^ (sigma[i] & ~result);
+    }
+
+    // Computing shared secret
+    memcpy(mc + P::vec_k_size_bytes, u.words, P::vec_n_size_bytes);
+    memcpy(mc + P::vec_k_size_bytes + P::vec_n_size_bytes, v.words, P::vec_n1n2_size_bytes);
+    shake256_512_ds(&shake256state, ss, mc, P::vec_k_size_bytes + P::vec_n_size_bytes + P::vec_n1n2_size_bytes, K_FCT_DOMAIN);
+
+    #ifdef VERBOSE
+        printf("\n\npk: "); for(size_t i = 0 ; i < P::public_key_bytes ; ++i) printf("%02x", pk[i]);
+        printf("\n\nsk: "); for(size_t i = 0 ; i < P::secret_key_bytes ; ++i) printf("%02x", sk[i]);
+        printf("\n\nciphertext: "); for(size_t i = 0 ; i < P::ciphertext_bytes ; ++i) printf("%02x", ct[i]);
+        printf("\n\nm: "); vect_print<P>((uint64_t *)m, P::vec_k_size_bytes);
+        printf("\n\ntheta: "); for(int i = 0 ; i < SHAKE256_512_BYTES ; ++i) printf("%02x", theta[i]);
+        printf("\n\n\n# Checking Ciphertext- Begin #");
+        printf("\n\nu2: "); vect_print<P>(u2.words, P::vec_n_size_bytes);
+        printf("\n\nv2: "); vect_print<P>(v2.words, P::vec_n1n2_size_bytes);
+        printf("\n\n# Checking Ciphertext - End #\n");
+    #endif
+
+    return (result & 1) - 1;
+}
+
+
+
+/**
+ * @brief Keygen of the HQC_KEM IND_CAA2 scheme
+ *
+ * The public key is composed of the syndrome <b>s</b> as well as the seed used to generate the vector <b>h</b>.
+ *
+ * The secret key is composed of the seed used to generate vectors <b>x</b> and <b>y</b>.
+ * As a technicality, the public key is appended to the secret key in order to respect NIST API.
+ *
+ * @param[out] pk String containing the public key
+ * @param[out] sk String containing the secret key
+ * @returns 0 if keygen is successful
+ */
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, Trace_time* keygen_time) {
+    #ifdef VERBOSE
+        printf("\n\n\n\n### KEYGEN ###");
+    #endif
+
+    hqc_pke_keygen<hqc128_params>(pk, sk, keygen_time);
+    return 0;
+}
+
+
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk) {
+    return hqc::Kem<hqc128_params>::keypair(pk, sk);
+}
+
+
+
+/**
+ * @brief Encapsulation of the HQC_KEM IND_CAA2 scheme
+ *
+ * @param[out] ct String containing the ciphertext
+ * @param[out] ss String containing the shared secret
+ * @param[in] pk String containing the public key
+ * @returns 0 if encapsulation is successful
+ */
+int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, Trace_time* encap_time) {
     #ifdef VERBOSE
         printf("\n\n\n\n### ENCAPS ###");
     #endif
 
     uint8_t theta[SHAKE256_512_BYTES] = {0};
     uint8_t m[VEC_K_SIZE_BYTES] = {0};
-    uint64_t u[VEC_N_SIZE_64] = {0};
-    uint64_t v[VEC_N1N2_SIZE_64] = {0};
+    aligned_vect u = {};
+    aligned_vect v = {};
     uint8_t mc[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES] = {0};
     uint64_t salt[SALT_SIZE_64] = {0};
     uint8_t tmp[VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES] = {0};
     shake256incctx shake256state;
-
+    clock_t start, end;
+    encap_time->stack += 1;
     // Computing m
+    
+    start = trace_start(encap_time, TRACE_SHAKE_PRNG);
     vect_set_random_from_prng((uint64_t *)m, VEC_K_SIZE_64); // shake_prng, generate random vector
+    vect_set_random_from_prng(salt, SALT_SIZE_64); // Computing theta
+    end = trace_stop(encap_time, TRACE_SHAKE_PRNG);
+    encap_time->shake_prng_time += ((uint32_t)(end - start));
 
-    // Computing theta
-    vect_set_random_from_prng(salt, SALT_SIZE_64);
+    start = trace_start(encap_time, TRACE_PARSING);
     memcpy(tmp, m, VEC_K_SIZE_BYTES);
     memcpy(tmp + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
     memcpy(tmp + VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES, salt, SALT_SIZE_BYTES);
+    end = trace_stop(encap_time, TRACE_PARSING);
+    encap_time->parsing_time += ((uint32_t) (end - start));
+    
+    
+    start = trace_start(encap_time, TRACE_SHAKE256_512_DS);
     //tmp에 m, pk, salt 들어있음, m과 salt는 랜덤벡터에 해당됨
     shake256_512_ds(&shake256state, theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
+    end = trace_stop(encap_time, TRACE_SHAKE256_512_DS);
+    encap_time->shake256_512_ds_time += ((uint32_t) (end - start));
+    
     //tmp를 shake 256처리해서 theta에 넣어줌
     // Encrypting m
-    hqc_pke_encrypt(u, v, (uint64_t *)m, theta, pk);
+    hqc_pke_encrypt(&u, &v, (uint64_t *)m, theta, pk, encap_time);
     //random generation이랑, rs-rm encoding, 그리고 벡터연산 몇개 포함됨
 
     // Computing shared secret
+    start = trace_start(encap_time, TRACE_PARSING);
     memcpy(mc, m, VEC_K_SIZE_BYTES);
-    memcpy(mc + VEC_K_SIZE_BYTES, u, VEC_N_SIZE_BYTES);
-    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v, VEC_N1N2_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES, u.words, VEC_N_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v.words, VEC_N1N2_SIZE_BYTES);
+    end = trace_stop(encap_time, TRACE_PARSING);
+    encap_time->parsing_time += ((uint32_t)(end - start));
+    
+    start = trace_start(encap_time, TRACE_SHAKE256_512_DS);
     shake256_512_ds(&shake256state, ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
+    end = trace_stop(encap_time, TRACE_SHAKE256_512_DS);
+    encap_time->shake256_512_ds_time += ((uint32_t)(end - start));
+    
     // mc에 m, u, v 넣은다음 shake shake해서 ss에 대입해줌
     // Computing ciphertext
-    hqc_ciphertext_to_string(ct, u, v, salt); 
+    start = trace_start(encap_time, TRACE_PARSING);
+    hqc_ciphertext_to_string(ct, &u, &v, salt); 
+    end = trace_stop(encap_time, TRACE_PARSING);
+    encap_time->parsing_time += ((uint32_t)(end - start));
     //ct에 u, v, salt넣어줌
     // ss, ct return
 
@@ -175,6 +408,11 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
     return 0;
 }
 
+
+int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk) {
+    return hqc::Kem<hqc128_params>::encapsulate(ct, ss, pk);
+}
+
 /**
  * @brief Decapsulation of the HQC_KEM IND_CAA2 scheme
  *
@@ -189,14 +427,14 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
     #endif
 
     uint8_t result;
-    uint64_t u[VEC_N_SIZE_64] = {0};
-    uint64_t v[VEC_N1N2_SIZE_64] = {0};
+    aligned_vect u = {};
+    aligned_vect v = {};
     uint8_t pk[PUBLIC_KEY_BYTES] = {0};
     uint8_t m[VEC_K_SIZE_BYTES] = {0};
     uint8_t sigma[VEC_K_SIZE_BYTES] = {0};
     uint8_t theta[SHAKE256_512_BYTES] = {0};
-    uint64_t u2[VEC_N_SIZE_64] = {0};
-    uint64_t v2[VEC_N1N2_SIZE_64] = {0};
+    aligned_vect u2 = {};
+    aligned_vect v2 = {};
     uint8_t mc[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES] = {0};
     uint64_t salt[SALT_SIZE_64] = {0};
     uint8_t tmp[VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES] = {0};
@@ -205,107 +443,126 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
 
     decap_time->stack += 1;
     // Retrieving u, v and d from ciphertext
-    start = clock();
-    hqc_ciphertext_from_string(u, v, salt, ct);
+    start = trace_start(decap_time, TRACE_PARSING);
+    hqc_ciphertext_from_string(&u, &v, salt, ct);
     //encryption에서 ct에 u, v, salt를 넣어줬었는데 반대로 분리해주는 과정
 
     // Retrieving pk from sk
-    memcpy(pk, sk + SEED_BYTES, PUBLIC_KEY_BYTES);
-    end = clock();
+    memcpy(pk, sk + SEED_BYTES + VEC_K_SIZE_BYTES, PUBLIC_KEY_BYTES);
+    end = trace_stop(decap_time, TRACE_PARSING);
     decap_time->parsing_time += ((uint32_t)(end - start));
     // pk 가져오기
 
     // Decrypting
-    result = hqc_pke_decrypt((uint64_t *)m, sigma, u, v, sk, decap_time);
+    result = hqc_pke_decrypt((uint64_t *)m, sigma, &u, &v, sk, decap_time);
     // 몇가지 랜덤 처리와 마지막 rs-rm decoding 연산이 포함되어있음
 
     // Computing theta
-    start = clock();
+    start = trace_start(decap_time, TRACE_PARSING);
     memcpy(tmp, m, VEC_K_SIZE_BYTES);
     memcpy(tmp + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
     memcpy(tmp + VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES, salt, SALT_SIZE_BYTES);
-    end = clock();
+    end = trace_stop(decap_time, TRACE_PARSING);
     decap_time->parsing_time += ((uint32_t)(end - start));
 
-    start = clock();
+    start = trace_start(decap_time, TRACE_SHAKE256_512_DS);
     shake256_512_ds(&shake256state, theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
-    end = clock();
+    end = trace_stop(decap_time, TRACE_SHAKE256_512_DS);
     decap_time->shake256_512_ds_time += ((uint32_t)(end-start));
 
     // Encrypting m'
-    hqc_pke_encrypt(u2, v2, (uint64_t *)m, theta, pk, decap_time);
+    hqc_pke_encrypt(&u2, &v2, (uint64_t *)m, theta, pk, decap_time);
     //3번의 랜덤 생성, rs-rm encoding, 그밖의 벡터 연산
 
-    start = clock();
+    start = trace_start(decap_time, TRACE_VECT_OPERATION);
     // Check if c != c'
-    result |= vect_compare((uint8_t *)u, (uint8_t *)u2, VEC_N_SIZE_BYTES);
-    result |= vect_compare((uint8_t *)v, (uint8_t *)v2, VEC_N1N2_SIZE_BYTES);
+    result |= vect_compare(&u, &u2);
+    result |= vect_compare(&v, &v2);
 
-    result = (uint8_t) (-((int16_t) result) >> 15);
+    result -= 1;
 
     for (size_t i = 0; i < VEC_K_SIZE_BYTES; ++i) {
         mc[i] = (m[i] & result) ^ (sigma[i] & ~result);
     }
-    end = clock();
+    end = trace_stop(decap_time, TRACE_VECT_OPERATION);
     decap_time->vect_operation_time += ((uint32_t)(end - start));
 
     // Computing shared secret
-    start = clock();
-    memcpy(mc + VEC_K_SIZE_BYTES, u, VEC_N_SIZE_BYTES);
-    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v, VEC_N1N2_SIZE_BYTES);
-    end = clock();
+    start = trace_start(decap_time, TRACE_PARSING);
+    memcpy(mc + VEC_K_SIZE_BYTES, u.words, VEC_N_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v.words, VEC_N1N2_SIZE_BYTES);
+    end = trace_stop(decap_time, TRACE_PARSING);
     decap_time->parsing_time += ((uint32_t)(end - start));
 
-    start = clock();
+    start = trace_start(decap_time, TRACE_SHAKE256_512_DS);
     shake256_512_ds(&shake256state, ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
-    end = clock();
+    end = trace_stop(decap_time, TRACE_SHAKE256_512_DS);
     decap_time->shake256_512_ds_time += ((uint32_t)(end - start));
 
     #ifdef VERBOSE
         printf("\n\npk: "); for(int i = 0 ; i < PUBLIC_KEY_BYTES ; ++i) printf("%02x", pk[i]);
         printf("\n\nsk: "); for(int i = 0 ; i < SECRET_KEY_BYTES ; ++i) printf("%02x", sk[i]);
         printf("\n\nciphertext: "); for(int i = 0 ; i < CIPHERTEXT_BYTES ; ++i) printf("%02x", ct[i]);
-        printf("\n\nm: "); vect_print((uint64_t *)m, VEC_K_SIZE_BYTES);
+        printf("\n\nm: "); vect_print<hqc128_params>((uint64_t *)m, VEC_K_SIZE_BYTES);
         printf("\n\ntheta: "); for(int i = 0 ; i < SHAKE256_512_BYTES ; ++i) printf("%02x", theta[i]);
         printf("\n\n\n# Checking Ciphertext- Begin #");
-        printf("\n\nu2: "); vect_print(u2, VEC_N_SIZE_BYTES);
-        printf("\n\nv2: "); vect_print(v2, VEC_N1N2_SIZE_BYTES);
+        printf("\n\nu2: "); vect_print<hqc128_params>(u2.words, VEC_N_SIZE_BYTES);
+        printf("\n\nv2: "); vect_print<hqc128_params>(v2.words, VEC_N1N2_SIZE_BYTES);
         printf("\n\n# Checking Ciphertext - End #\n");
     #endif
 
-    return -(~result & 1);
+    return (result & 1) - 1;
 }
 
 int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk) {
-    #ifdef VERBOSE
-        printf("\n\n\n\n### DECAPS ###");
-    #endif
+    return hqc::Kem<hqc128_params>::decapsulate(ss, ct, sk);
+}
+
+
+
+/**
+ * @brief Low-latency decapsulation of the HQC_KEM IND_CCA2 scheme
+ *
+ * Same result as crypto_kem_dec, with the independent steps spread over helper threads:
+ * the public key is expanded by helper 0 while the ciphertext is decrypted, then the
+ * re-encryption splits r2.h, r2.s and the sampling of e over the caller and the helpers.
+ *
+ * @param[out] ss String containing the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @param[in] helpers Helper threads, see decaps_helpers.h, or nullptr to run the serial crypto_kem_dec
+ * @returns 0 if decapsulation is successful, -1 otherwise
+ */
+int crypto_kem_dec_low_latency(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, Decaps_helpers *helpers) {
+    if (helpers == nullptr) {
+        return crypto_kem_dec(ss, ct, sk);
+    }
 
     uint8_t result;
-    uint64_t u[VEC_N_SIZE_64] = {0};
-    uint64_t v[VEC_N1N2_SIZE_64] = {0};
-    uint8_t pk[PUBLIC_KEY_BYTES] = {0};
+    aligned_vect u = {};
+    aligned_vect v = {};
+    aligned_vect h = {};
+    aligned_vect s = {};
+    const uint8_t *pk = sk + SEED_BYTES + VEC_K_SIZE_BYTES;
     uint8_t m[VEC_K_SIZE_BYTES] = {0};
     uint8_t sigma[VEC_K_SIZE_BYTES] = {0};
     uint8_t theta[SHAKE256_512_BYTES] = {0};
-    uint64_t u2[VEC_N_SIZE_64] = {0};
-    uint64_t v2[VEC_N1N2_SIZE_64] = {0};
+    aligned_vect u2 = {};
+    aligned_vect v2 = {};
     uint8_t mc[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES] = {0};
     uint64_t salt[SALT_SIZE_64] = {0};
     uint8_t tmp[VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES] = {0};
     shake256incctx shake256state;
 
-    // Retrieving u, v and d from ciphertext
-    hqc_ciphertext_from_string(u, v, salt, ct);
-    //encryption에서 ct에 u, v, salt를 넣어줬었는데 반대로 분리해주는 과정
+    // Expand h and s from the public key stored in sk while decrypting
+    Public_key_task expansion = {&h, &s, pk};
+    helpers->post(0, public_key_task, &expansion);
 
-    // Retrieving pk from sk
-    memcpy(pk, sk + SEED_BYTES, PUBLIC_KEY_BYTES);
-    // pk 가져오기
+    // Retrieving u, v and d from ciphertext
+    hqc_ciphertext_from_string(&u, &v, salt, ct);
 
     // Decrypting
-    result = hqc_pke_decrypt((uint64_t *)m, sigma, u, v, sk);
-    // 몇가지 랜덤 처리와 마지막 rs-rm decoding 연산이 포함되어있음
+    result = hqc_pke_decrypt((uint64_t *)m, sigma, &u, &v, sk);
 
     // Computing theta
     memcpy(tmp, m, VEC_K_SIZE_BYTES);
@@ -314,35 +571,146 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
     shake256_512_ds(&shake256state, theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
 
     // Encrypting m'
-    hqc_pke_encrypt(u2, v2, (uint64_t *)m, theta, pk);
-    //3번의 랜덤 생성, rs-rm encoding, 그밖의 벡터 연산
+    helpers->wait(0);
+    hqc_pke_encrypt_low_latency(&u2, &v2, (uint64_t *)m, theta, &h, &s, helpers);
 
     // Check if c != c'
-    result |= vect_compare((uint8_t *)u, (uint8_t *)u2, VEC_N_SIZE_BYTES);
-    result |= vect_compare((uint8_t *)v, (uint8_t *)v2, VEC_N1N2_SIZE_BYTES);
+    result |= vect_compare(&u, &u2);
+    result |= vect_compare(&v, &v2);
 
-    result = (uint8_t) (-((int16_t) result) >> 15);
+    result -= 1;
 
     for (size_t i = 0; i < VEC_K_SIZE_BYTES; ++i) {
         mc[i] = (m[i] & result) ^ (sigma[i] & ~result);
     }
 
     // Computing shared secret
-    memcpy(mc + VEC_K_SIZE_BYTES, u, VEC_N_SIZE_BYTES);
-    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v, VEC_N1N2_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES, u.words, VEC_N_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, v.words, VEC_N1N2_SIZE_BYTES);
     shake256_512_ds(&shake256state, ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
 
-    #ifdef VERBOSE
-        printf("\n\npk: "); for(int i = 0 ; i < PUBLIC_KEY_BYTES ; ++i) printf("%02x", pk[i]);
-        printf("\n\nsk: "); for(int i = 0 ; i < SECRET_KEY_BYTES ; ++i) printf("%02x", sk[i]);
-        printf("\n\nciphertext: "); for(int i = 0 ; i < CIPHERTEXT_BYTES ; ++i) printf("%02x", ct[i]);
-        printf("\n\nm: "); vect_print((uint64_t *)m, VEC_K_SIZE_BYTES);
-        printf("\n\ntheta: "); for(int i = 0 ; i < SHAKE256_512_BYTES ; ++i) printf("%02x", theta[i]);
-        printf("\n\n\n# Checking Ciphertext- Begin #");
-        printf("\n\nu2: "); vect_print(u2, VEC_N_SIZE_BYTES);
-        printf("\n\nv2: "); vect_print(v2, VEC_N1N2_SIZE_BYTES);
-        printf("\n\n# Checking Ciphertext - End #\n");
-    #endif
+    return (result & 1) - 1;
+}
 
-    return -(~result & 1);
+
+
+/**
+ * @brief Keygen of the HQC_KEM IND_CAA2 scheme working in a caller-provided workspace
+ *
+ * @param[out] pk String containing the public key
+ * @param[out] sk String containing the secret key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0 if keygen is successful
+ */
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, hqc_workspace *workspace) {
+    hqc_pke_keygen(pk, sk, workspace);
+    clear_secrets(workspace);
+    return 0;
 }
+
+
+
+/**
+ * @brief Encapsulation of the HQC_KEM IND_CAA2 scheme working in a caller-provided workspace
+ *
+ * Same result as crypto_kem_enc, without heap allocation and with a small stack footprint.
+ *
+ * @param[out] ct String containing the ciphertext
+ * @param[out] ss String containing the shared secret
+ * @param[in] pk String containing the public key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0 if encapsulation is successful
+ */
+int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, hqc_workspace *workspace) {
+    uint8_t *m = (uint8_t *) workspace->m;
+    uint8_t *tmp = workspace->hash_input;
+    uint8_t *mc = workspace->hash_input;
+    shake256incctx shake256state;
+
+    // Computing m
+    vect_set_random_from_prng(workspace->m, VEC_K_SIZE_64);
+
+    // Computing theta
+    vect_set_random_from_prng(workspace->salt, SALT_SIZE_64);
+    memcpy(tmp, m, VEC_K_SIZE_BYTES);
+    memcpy(tmp + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
+    memcpy(tmp + VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES, workspace->salt, SALT_SIZE_BYTES);
+    shake256_512_ds(&shake256state, workspace->theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
+
+    // Encrypting m
+    hqc_pke_encrypt(&workspace->u, &workspace->v, workspace->m, workspace->theta, pk, workspace);
+
+    // Computing shared secret
+    memcpy(mc, m, VEC_K_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES, workspace->u.words, VEC_N_SIZE_BYTES);
+    memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, workspace->v.words, VEC_N1N2_SIZE_BYTES);
+    shake256_512_ds(&shake256state, ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
+
+    // Computing ciphertext
+    hqc_ciphertext_to_string(ct, &workspace->u, &workspace->v, workspace->salt);
+
+    clear_secrets(workspace);
+    return 0;
+}
+
+
+
+/**
+ * @brief Decapsulation of the HQC_KEM IND_CAA2 scheme working in a caller-provided workspace
+ *
+ * Same result as crypto_kem_dec, without heap allocation and with a small stack footprint.
+ *
+ * @param[out] ss String containing the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0 if decapsulation is successful, -1 otherwise
+ */
+int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, hqc_workspace *workspace) {
+    // Retrieving x, y and sigma from sk, then h and s from the public key
+    hqc_secret_key_from_string(&workspace->x, &workspace->y, workspace->sigma, workspace->pk, sk, &workspace->sampling);
+    hqc_public_key_from_string(&workspace->h, &workspace->s, sk + SEED_BYTES + VEC_K_SIZE_BYTES);
+
+    return decapsulate(ss, ct, sk + SEED_BYTES + VEC_K_SIZE_BYTES, workspace->sigma, &workspace->y, &workspace->h, &workspace->s, workspace);
+}
+
+
+
+/**
+ * @brief Expands a secret key for crypto_kem_dec
+ *
+ * @param[out] expanded Vectors expanded from sk
+ * @param[in] sk String containing the secret key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ */
+void hqc_expand_secret_key(hqc_expanded_sk *expanded, const unsigned char *sk, hqc_workspace *workspace) {
+    memset(expanded, 0, sizeof(hqc_expanded_sk));
+    hqc_secret_key_from_string(&workspace->x, &expanded->y, expanded->sigma, workspace->pk, sk, &workspace->sampling);
+    hqc_public_key_from_string(&expanded->h, &expanded->s, sk + SEED_BYTES + VEC_K_SIZE_BYTES);
+    clear_secrets(workspace);
+}
+
+
+
+/**
+ * @brief Decapsulation of the HQC_KEM IND_CAA2 scheme with an expanded secret key, working in a caller-provided workspace
+ *
+ * Same result as crypto_kem_dec, without heap allocation and with a small stack footprint.
+ *
+ * @param[out] ss String containing the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @param[in] expanded Vectors expanded from sk by hqc_expand_secret_key
+ * @param[in] workspace Workspace of the call, see workspace.h
+ * @returns 0 if decapsulation is successful, -1 otherwise
+ */
+int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, const hqc_expanded_sk *expanded, hqc_workspace *workspace) {
+    return decapsulate(ss, ct, sk + SEED_BYTES + VEC_K_SIZE_BYTES, expanded->sigma, &expanded->y, &expanded->h, &expanded->s, workspace);
+}
+
+
+
+#define INSTANTIATE_KEM(P) \
+    template class hqc::Kem<P>;
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_KEM)
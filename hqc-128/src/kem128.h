@@ -0,0 +1,217 @@
+#ifndef KEM128_H
+#define KEM128_H
+
+/**
+ * @file kem128.h
+ * @brief Header-only C++ interface of the HQC_KEM IND_CCA2 scheme
+ *
+ * Keys and ciphertexts are fixed-size, move-only objects zeroized when destroyed or moved from.
+ * A Kem128 object owns the workspace of the heap-free calls of workspace.h, so that keygen,
+ * encapsulation and decapsulation never allocate and write straight into the caller buffers.
+ * Randomness is drawn from the shake_prng state of the calling thread.
+ */
+
+#include "api.h"
+#include "parameters.h"
+#include "workspace.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <array>
+#include <optional>
+#include <type_traits>
+
+namespace hqc {
+
+/**
+ * @brief Overwrites a buffer holding key material with zeros
+ *
+ * Written through a volatile pointer so that the stores are not dropped as dead.
+ *
+ * @param[out] buffer Buffer to clear
+ * @param[in] length Length of the buffer in bytes
+ */
+inline void secure_zero(void *buffer, size_t length) {
+    volatile uint8_t *bytes = (volatile uint8_t *) buffer;
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = 0;
+    }
+}
+
+/**
+ * View of N contiguous bytes owned by the caller, built from a C array, a std::array
+ * or a pointer the caller vouches for.
+ */
+template <typename T, size_t N>
+class Span {
+    public:
+        using Byte = std::remove_const_t<T>;
+
+        constexpr Span(T (&array)[N]) noexcept : pointer(array) {}
+        constexpr Span(std::array<Byte, N>& array) noexcept : pointer(array.data()) {}
+        constexpr Span(const std::array<Byte, N>& array) noexcept : pointer(array.data()) {}
+        constexpr explicit Span(T *data) noexcept : pointer(data) {}
+
+        constexpr T *data() const noexcept { return pointer; }
+        static constexpr size_t size() noexcept { return N; }
+
+    private:
+        T *pointer;
+};
+
+/**
+ * Move-only byte string zeroized on destruction. Moving copies the bytes and zeroizes the source.
+ */
+template <size_t N>
+class Secure_bytes {
+    public:
+        static constexpr size_t bytes = N;
+
+        Secure_bytes() noexcept : value{} {}
+        explicit Secure_bytes(Span<const uint8_t, N> from) noexcept { memcpy(value.data(), from.data(), N); }
+        Secure_bytes(Secure_bytes&& other) noexcept : value(other.value) { other.clear(); }
+        Secure_bytes& operator=(Secure_bytes&& other) noexcept {
+            if (this != &other) {
+                value = other.value;
+                other.clear();
+            }
+            return *this;
+        }
+        Secure_bytes(const Secure_bytes&) = delete;
+        Secure_bytes& operator=(const Secure_bytes&) = delete;
+        ~Secure_bytes() { clear(); }
+
+        uint8_t *data() noexcept { return value.data(); }
+        const uint8_t *data() const noexcept { return value.data(); }
+        static constexpr size_t size() noexcept { return N; }
+
+        operator Span<uint8_t, N>() noexcept { return Span<uint8_t, N>(value); }
+        operator Span<const uint8_t, N>() const noexcept { return Span<const uint8_t, N>(value); }
+
+        void clear() noexcept { secure_zero(value.data(), N); }
+
+    private:
+        std::array<uint8_t, N> value;
+};
+
+class PublicKey : public Secure_bytes<PUBLIC_KEY_BYTES> {
+    public:
+        using Secure_bytes::Secure_bytes;
+};
+
+class Ciphertext : public Secure_bytes<CIPHERTEXT_BYTES> {
+    public:
+        using Secure_bytes::Secure_bytes;
+};
+
+/**
+ * Secret key, with an optional cache of the vectors expanded from it (see Kem128::expand).
+ * The cache is dropped whenever the key bytes are written through Kem128::keypair.
+ */
+class SecretKey : public Secure_bytes<SECRET_KEY_BYTES> {
+    public:
+        using Secure_bytes::Secure_bytes;
+
+        SecretKey() noexcept = default;
+        SecretKey(SecretKey&& other) noexcept : Secure_bytes(std::move(other)), expanded(other.expanded) { other.forget(); }
+        SecretKey& operator=(SecretKey&& other) noexcept {
+            if (this != &other) {
+                forget();
+                Secure_bytes::operator=(std::move(other));
+                expanded = other.expanded;
+                other.forget();
+            }
+            return *this;
+        }
+        ~SecretKey() { forget(); }
+
+        bool is_expanded() const noexcept { return expanded.has_value(); }
+
+        /**
+         * Zeroizes and drops the expanded vectors, keeping the key bytes.
+         */
+        void forget() noexcept {
+            if (expanded) {
+                secure_zero(&*expanded, sizeof(hqc_expanded_sk));
+                expanded.reset();
+            }
+        }
+
+    private:
+        friend class Kem128;
+        std::optional<hqc_expanded_sk> expanded;
+};
+
+/**
+ * HQC-128 KEM bound to its own workspace. One object serves one thread at a time;
+ * it is neither copyable nor movable since the workspace is stored inline.
+ */
+class Kem128 {
+    public:
+        static constexpr size_t public_key_bytes = PUBLIC_KEY_BYTES;
+        static constexpr size_t secret_key_bytes = SECRET_KEY_BYTES;
+        static constexpr size_t ciphertext_bytes = CIPHERTEXT_BYTES;
+        static constexpr size_t shared_secret_bytes = SHARED_SECRET_BYTES;
+
+        Kem128() noexcept = default;
+        Kem128(const Kem128&) = delete;
+        Kem128& operator=(const Kem128&) = delete;
+        ~Kem128() { secure_zero(&workspace, sizeof(hqc_workspace)); }
+
+        /**
+         * @brief Generates a keypair
+         *
+         * @param[out] pk Public key
+         * @param[out] sk Secret key, its expanded vectors are dropped
+         */
+        void keypair(PublicKey& pk, SecretKey& sk) noexcept {
+            sk.forget();
+            crypto_kem_keypair(pk.data(), sk.data(), &workspace);
+        }
+
+        /**
+         * @brief Encapsulation
+         *
+         * @param[out] ct Ciphertext
+         * @param[out] ss Shared secret
+         * @param[in] pk Public key
+         * @returns 0 if encapsulation is successful
+         */
+        int encapsulate(Span<uint8_t, CIPHERTEXT_BYTES> ct, Span<uint8_t, SHARED_SECRET_BYTES> ss, const PublicKey& pk) noexcept {
+            return crypto_kem_enc(ct.data(), ss.data(), pk.data(), &workspace);
+        }
+
+        /**
+         * @brief Decapsulation, from the expanded vectors of sk when it has them
+         *
+         * @param[out] ss Shared secret
+         * @param[in] ct Ciphertext
+         * @param[in] sk Secret key
+         * @returns 0 if decapsulation is successful, -1 otherwise
+         */
+        int decapsulate(Span<uint8_t, SHARED_SECRET_BYTES> ss, Span<const uint8_t, CIPHERTEXT_BYTES> ct, const SecretKey& sk) noexcept {
+            if (sk.expanded) {
+                return crypto_kem_dec(ss.data(), ct.data(), sk.data(), &*sk.expanded, &workspace);
+            }
+            return crypto_kem_dec(ss.data(), ct.data(), sk.data(), &workspace);
+        }
+
+        /**
+         * @brief Caches in sk the vectors expanded from it, making its decapsulations cheaper
+         *
+         * @param[in,out] sk Secret key
+         */
+        void expand(SecretKey& sk) noexcept {
+            if (!sk.expanded) {
+                sk.expanded.emplace();
+            }
+            hqc_expand_secret_key(&*sk.expanded, sk.data(), &workspace);
+        }
+
+    private:
+        hqc_workspace workspace;
+};
+
+} // namespace hqc
+
+#endif
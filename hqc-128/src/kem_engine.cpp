@@ -0,0 +1,264 @@
+/**
+ * @file kem_engine.cpp
+ * @brief Implementation of kem_engine.h
+ */
+
+#include "kem_engine.h"
+#include "api.h"
+#include "shake_prng.h"
+#include <string.h>
+
+#define WORKER_SEED_BYTES 48
+
+/**
+ * Per-worker state, kept on its own cache lines so that the deque locks of
+ * neighbouring workers do not false-share.
+ *
+ * The workspace of a worker is its thread: the KEM operations keep their
+ * vectors on the worker stack and draw randomness from the thread-local
+ * shake_prng state, seeded from seed when the worker starts.
+ */
+struct alignas(64) Kem_engine::Worker {
+    std::mutex lock;
+    std::deque<Kem_job> jobs;
+    std::thread thread;
+    uint8_t seed[WORKER_SEED_BYTES];
+};
+
+static thread_local const Kem_engine *current_engine = nullptr;
+static thread_local unsigned int current_worker = 0;
+
+
+/**
+ * @brief Starts the workers
+ *
+ * The PRNG seeds of the workers are drawn from the shake_prng state of the calling thread,
+ * so a seeded caller gets reproducible workers.
+ *
+ * @param[in] workers Number of worker threads, at least one is started
+ */
+Kem_engine::Kem_engine(unsigned int workers) : count(workers ? workers : 1), workers(new Worker[count]) {
+    for (unsigned int i = 0; i < count; i++) {
+        shake_prng(this->workers[i].seed, WORKER_SEED_BYTES);
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        this->workers[i].thread = std::thread(&Kem_engine::run, this, i);
+    }
+}
+
+
+
+/**
+ * @brief Runs the jobs still queued and stops the workers
+ */
+Kem_engine::~Kem_engine() {
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (unsigned int i = 0; i < count; i++) {
+        workers[i].thread.join();
+    }
+}
+
+
+
+/**
+ * @brief Queues an encapsulation
+ *
+ * @param[out] ct String receiving the ciphertext
+ * @param[out] ss String receiving the shared secret
+ * @param[in] pk String containing the public key
+ * @param[in] done Called on the worker thread with the return value of crypto_kem_enc
+ */
+void Kem_engine::submit_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, Kem_callback done) {
+    submit(Kem_job{Kem_operation::encaps, ss, ct, nullptr, pk, std::move(done)});
+}
+
+
+
+/**
+ * @brief Queues an encapsulation
+ *
+ * @param[out] ct String receiving the ciphertext
+ * @param[out] ss String receiving the shared secret
+ * @param[in] pk String containing the public key
+ * @returns Future holding the return value of crypto_kem_enc
+ */
+std::future<int> Kem_engine::submit_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk) {
+    std::shared_ptr<std::promise<int>> result = std::make_shared<std::promise<int>>();
+    std::future<int> future = result->get_future();
+    submit_enc(ct, ss, pk, [result](int status) { result->set_value(status); });
+    return future;
+}
+
+
+
+/**
+ * @brief Queues a decapsulation
+ *
+ * @param[out] ss String receiving the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @param[in] done Called on the worker thread with the return value of crypto_kem_dec
+ */
+void Kem_engine::submit_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, Kem_callback done) {
+    submit(Kem_job{Kem_operation::decaps, ss, nullptr, ct, sk, std::move(done)});
+}
+
+
+
+/**
+ * @brief Queues a decapsulation
+ *
+ * @param[out] ss String receiving the shared secret
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @returns Future holding the return value of crypto_kem_dec
+ */
+std::future<int> Kem_engine::submit_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk) {
+    std::shared_ptr<std::promise<int>> result = std::make_shared<std::promise<int>>();
+    std::future<int> future = result->get_future();
+    submit_dec(ss, ct, sk, [result](int status) { result->set_value(status); });
+    return future;
+}
+
+
+
+/**
+ * @brief Blocks until every submitted job has completed
+ */
+void Kem_engine::wait_idle() {
+    std::unique_lock<std::mutex> guard(sleep_lock);
+    idle.wait(guard, [this] { return in_flight.load() == 0; });
+}
+
+
+
+/**
+ * @returns Number of worker threads
+ */
+unsigned int Kem_engine::worker_count() const {
+    return count;
+}
+
+
+
+/**
+ * @returns Number of jobs a worker took from the deque of another one
+ */
+uint64_t Kem_engine::steal_count() const {
+    return steals.load(std::memory_order_relaxed);
+}
+
+
+
+/**
+ * @brief Pushes a job on a worker deque and wakes up a sleeping worker
+ *
+ * queued is raised under the deque lock, after the push, so that a worker seeing it
+ * non-zero finds the job and a take never brings it below zero. The sleep lock is only
+ * taken when a worker is asleep: a worker registers in sleepers before it checks queued,
+ * and the submitter checks sleepers after raising queued, so one of them sees the other.
+ *
+ * @param[in] job The job
+ */
+void Kem_engine::submit(Kem_job job) {
+    unsigned int target = (current_engine == this) ? current_worker : next_worker.fetch_add(1, std::memory_order_relaxed) % count;
+
+    in_flight.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(workers[target].lock);
+        workers[target].jobs.push_back(std::move(job));
+        queued.fetch_add(1);
+    }
+
+    if (sleepers.load() > 0) {
+        { std::lock_guard<std::mutex> guard(sleep_lock); }
+        wake.notify_one();
+    }
+}
+
+
+
+/**
+ * @brief Takes the oldest job of a worker deque, or steals the newest job of another one
+ *
+ * @param[in] self Index of the calling worker
+ * @param[out] job The job taken
+ * @returns true if a job was taken
+ */
+bool Kem_engine::take(unsigned int self, Kem_job *job) {
+    {
+        std::lock_guard<std::mutex> guard(workers[self].lock);
+        if (!workers[self].jobs.empty()) {
+            *job = std::move(workers[self].jobs.front());
+            workers[self].jobs.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (unsigned int i = 1; i < count; i++) {
+        Worker& victim = workers[(self + i) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            *job = std::move(victim.jobs.back());
+            victim.jobs.pop_back();
+            queued.fetch_sub(1);
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Main loop of a worker
+ *
+ * Seeds the thread-local PRNG, then runs jobs until the engine stops and no job is left.
+ *
+ * @param[in] self Index of the worker
+ */
+void Kem_engine::run(unsigned int self) {
+    current_engine = this;
+    current_worker = self;
+    shake_prng_init(workers[self].seed, NULL, WORKER_SEED_BYTES, 0);
+    memset(workers[self].seed, 0, WORKER_SEED_BYTES);
+
+    Kem_job job{};
+    while (true) {
+        if (!take(self, &job)) {
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            sleepers.fetch_add(1);
+            wake.wait(guard, [this] { return stopping || queued.load() > 0; });
+            sleepers.fetch_sub(1);
+            if (stopping && queued.load() == 0) {
+                return;
+            }
+            continue;
+        }
+
+        int status;
+        if (job.operation == Kem_operation::encaps) {
+            status = crypto_kem_enc(job.ct_out, job.ss, job.key);
+        } else {
+            status = crypto_kem_dec(job.ss, job.ct_in, job.key);
+        }
+        if (job.done) {
+            job.done(status);
+        }
+        job.done = nullptr;
+
+        if (in_flight.fetch_sub(1) == 1) {
+            { std::lock_guard<std::mutex> guard(sleep_lock); }
+            idle.notify_all();
+        }
+    }
+}
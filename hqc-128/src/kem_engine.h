@@ -0,0 +1,84 @@
+#ifndef KEM_ENGINE_H
+#define KEM_ENGINE_H
+
+/**
+ * @file kem_engine.h
+ * @brief Multithreaded service layer running the HQC_KEM operations on a work-stealing pool
+ *
+ * Buffers passed to the submit functions are owned by the caller and must stay valid
+ * until the job has completed, that is until its callback has run or its future is ready.
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Completion callback of a job, called on the worker thread with the return value
+ * of crypto_kem_enc or crypto_kem_dec. It must not throw.
+ */
+typedef std::function<void(int)> Kem_callback;
+
+enum class Kem_operation { encaps, decaps };
+
+struct Kem_job {
+    Kem_operation operation;
+    unsigned char *ss;
+    unsigned char *ct_out; // Ciphertext written by an encapsulation
+    const unsigned char *ct_in; // Ciphertext read by a decapsulation
+    const unsigned char *key; // Public key for an encapsulation, secret key for a decapsulation
+    Kem_callback done;
+};
+
+/**
+ * Pool of worker threads, each one owning a job deque and a workspace.
+ *
+ * Workers take jobs from the front of their own deque and, once it is empty,
+ * steal from the back of the other ones. Jobs submitted from a worker thread
+ * (for instance from a callback) go to that worker's deque, the other ones are
+ * spread over the workers in round-robin.
+ */
+class Kem_engine {
+    public:
+        explicit Kem_engine(unsigned int workers = std::thread::hardware_concurrency());
+        ~Kem_engine();
+
+        Kem_engine(const Kem_engine&) = delete;
+        Kem_engine& operator=(const Kem_engine&) = delete;
+
+        void submit_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, Kem_callback done);
+        std::future<int> submit_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk);
+        void submit_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, Kem_callback done);
+        std::future<int> submit_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
+
+        void wait_idle();
+        unsigned int worker_count() const;
+        uint64_t steal_count() const;
+
+    private:
+        struct Worker;
+
+        void submit(Kem_job job);
+        bool take(unsigned int self, Kem_job *job);
+        void run(unsigned int self);
+
+        unsigned int count;
+        std::unique_ptr<Worker[]> workers;
+        std::atomic<unsigned int> next_worker{0};
+        std::atomic<uint64_t> queued{0};
+        std::atomic<uint64_t> in_flight{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<unsigned int> sleepers{0};
+        std::mutex sleep_lock;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,351 @@
+/**
+ * @file keypair_pool.cpp
+ * @brief Implementation of keypair_pool.h
+ */
+
+#include "keypair_pool.h"
+#include "api.h"
+#include "shake_prng.h"
+#include <stdint.h>
+#include <string.h>
+
+#define FILLER_SEED_BYTES 48
+
+struct Keypair_pool::Slot {
+    std::atomic<size_t> sequence;
+    Pooled_keypair keypair;
+};
+
+static void zeroize(void *buffer, size_t length);
+
+
+/**
+ * @brief Overwrites a buffer holding key material with zeros
+ *
+ * Written through a volatile pointer so that the stores are not dropped as dead.
+ *
+ * @param[out] buffer Buffer to clear
+ * @param[in] length Length of the buffer in bytes
+ */
+static void zeroize(void *buffer, size_t length) {
+    volatile uint8_t *bytes = (volatile uint8_t *) buffer;
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = 0;
+    }
+}
+
+
+
+/**
+ * @brief Allocates the ring and starts the fill threads
+ *
+ * The capacity is rounded up to a power of two. The watermarks are clamped so that
+ * 0 <= low_watermark < high_watermark <= capacity. The PRNG seeds of the fill threads
+ * are drawn from the shake_prng state of the calling thread.
+ *
+ * @param[in] capacity Number of slots of the ring
+ * @param[in] low_watermark The fill threads wake up when a pop leaves this many keypairs
+ * @param[in] high_watermark The fill threads go to sleep once this many keypairs are ready
+ * @param[in] fillers Number of fill threads
+ * @param[in] expand Also store each secret key expanded by hqc_expand_secret_key
+ */
+Keypair_pool::Keypair_pool(size_t capacity, size_t low_watermark, size_t high_watermark, unsigned int fillers, bool expand) : expand(expand) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask = size - 1;
+    high = (high_watermark == 0) ? 1 : (high_watermark > size ? size : high_watermark);
+    low = (low_watermark >= high) ? high - 1 : low_watermark;
+
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    filler_count = (fillers == 0) ? 1 : fillers;
+    seeds.reset(new uint8_t[filler_count * FILLER_SEED_BYTES]);
+    shake_prng(seeds.get(), filler_count * FILLER_SEED_BYTES);
+
+    threads.reset(new std::thread[filler_count]);
+    for (unsigned int i = 0; i < filler_count; i++) {
+        threads[i] = std::thread(&Keypair_pool::fill, this, i);
+    }
+}
+
+
+
+/**
+ * @brief Stops the fill threads and zeroizes the keypairs left in the pool
+ */
+Keypair_pool::~Keypair_pool() {
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (unsigned int i = 0; i < filler_count; i++) {
+        threads[i].join();
+    }
+
+    drain();
+}
+
+
+
+/**
+ * @brief Takes a ready keypair
+ *
+ * @param[out] keypair Receives the keypair
+ * @returns true on a hit, false if the pool was empty
+ */
+bool Keypair_pool::pop(Pooled_keypair *keypair) {
+    if (!take(keypair)) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+
+    // Only the pop bringing the pool down to the low watermark wakes the fill threads
+    if (available.fetch_sub(1) == low + 1) {
+        { std::lock_guard<std::mutex> guard(sleep_lock); }
+        wake.notify_all();
+    }
+    return true;
+}
+
+
+
+/**
+ * @brief Takes a ready keypair, without its expanded secret key
+ *
+ * @param[out] pk String receiving the public key
+ * @param[out] sk String receiving the secret key
+ * @returns true on a hit, false if the pool was empty
+ */
+bool Keypair_pool::pop(uint8_t *pk, uint8_t *sk) {
+    Pooled_keypair keypair;
+    if (!pop(&keypair)) {
+        return false;
+    }
+
+    memcpy(pk, keypair.pk, PUBLIC_KEY_BYTES);
+    memcpy(sk, keypair.sk, SECRET_KEY_BYTES);
+    zeroize(&keypair, sizeof(keypair));
+    return true;
+}
+
+
+
+/**
+ * @brief Takes a ready keypair with its expanded secret key
+ *
+ * @param[out] pk String receiving the public key
+ * @param[out] sk String receiving the secret key
+ * @param[out] expanded Receives the secret key expanded by hqc_expand_secret_key
+ * @returns true on a hit, false if the pool was empty or was created without expand
+ */
+bool Keypair_pool::pop(uint8_t *pk, uint8_t *sk, hqc_expanded_sk *expanded) {
+    Pooled_keypair keypair;
+    if (!expand || !pop(&keypair)) {
+        return false;
+    }
+
+    memcpy(pk, keypair.pk, PUBLIC_KEY_BYTES);
+    memcpy(sk, keypair.sk, SECRET_KEY_BYTES);
+    memcpy(expanded, &keypair.expanded, sizeof(hqc_expanded_sk));
+    zeroize(&keypair, sizeof(keypair));
+    return true;
+}
+
+
+
+/**
+ * @brief Removes and zeroizes every keypair currently in the pool
+ *
+ * The fill threads keep running, so the pool refills afterwards unless it is being destroyed.
+ *
+ * @returns Number of keypairs removed
+ */
+size_t Keypair_pool::drain() {
+    Pooled_keypair keypair;
+    size_t drained = 0;
+
+    while (take(&keypair)) {
+        available.fetch_sub(1);
+        drained++;
+    }
+    zeroize(&keypair, sizeof(keypair));
+
+    { std::lock_guard<std::mutex> guard(sleep_lock); }
+    wake.notify_all();
+    return drained;
+}
+
+
+
+/**
+ * @returns Snapshot of the pool counters
+ */
+Keypair_pool_stats Keypair_pool::stats() const {
+    Keypair_pool_stats snapshot;
+    snapshot.hits = hits.load(std::memory_order_relaxed);
+    snapshot.misses = misses.load(std::memory_order_relaxed);
+    snapshot.generated = generated.load(std::memory_order_relaxed);
+    snapshot.available = available.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+
+
+/**
+ * @brief Copies a keypair into the next free slot of the ring
+ *
+ * @param[in] keypair The keypair
+ * @returns false if the ring is full
+ */
+bool Keypair_pool::push(const Pooled_keypair *keypair) {
+    size_t position = enqueue_position.load(std::memory_order_relaxed);
+    Slot *slot;
+
+    while (true) {
+        slot = &slots[position & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+
+        if (difference == 0) {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Counted before it is published so that a concurrent pop never takes the count below zero
+    memcpy(&slot->keypair, keypair, sizeof(Pooled_keypair));
+    available.fetch_add(1);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+
+
+/**
+ * @brief Moves the oldest keypair of the ring out and zeroizes its slot
+ *
+ * @param[out] keypair Receives the keypair
+ * @returns false if the ring is empty
+ */
+bool Keypair_pool::take(Pooled_keypair *keypair) {
+    size_t position = dequeue_position.load(std::memory_order_relaxed);
+    Slot *slot;
+
+    while (true) {
+        slot = &slots[position & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) (position + 1);
+
+        if (difference == 0) {
+            if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = dequeue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    memcpy(keypair, &slot->keypair, sizeof(Pooled_keypair));
+    zeroize(&slot->keypair, sizeof(Pooled_keypair));
+    slot->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+
+
+
+/**
+ * @brief Main loop of a fill thread
+ *
+ * Tops the pool up to the high watermark, then sleeps until it drops to the low watermark.
+ *
+ * @param[in] self Index of the fill thread
+ */
+void Keypair_pool::fill(unsigned int self) {
+    Pooled_keypair keypair;
+    std::unique_ptr<hqc_workspace> workspace(expand ? new hqc_workspace : nullptr);
+
+    shake_prng_init(&seeds[self * FILLER_SEED_BYTES], NULL, FILLER_SEED_BYTES, 0);
+    zeroize(&seeds[self * FILLER_SEED_BYTES], FILLER_SEED_BYTES);
+    memset(&keypair, 0, sizeof(keypair));
+
+    while (true) {
+        while (available.load() < high) {
+            crypto_kem_keypair(keypair.pk, keypair.sk);
+            if (expand) {
+                hqc_expand_secret_key(&keypair.expanded, keypair.sk, workspace.get());
+            }
+            generated.fetch_add(1, std::memory_order_relaxed);
+
+            bool pushed = push(&keypair);
+            zeroize(&keypair, sizeof(keypair));
+            if (!pushed) {
+                break;
+            }
+
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            if (stopping) {
+                break;
+            }
+        }
+        if (workspace) {
+            zeroize(workspace.get(), sizeof(hqc_workspace));
+        }
+
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        wake.wait(guard, [this] { return stopping || available.load() <= low; });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Keygen of the HQC_KEM IND_CAA2 scheme served from a keypair pool
+ *
+ * The keypair only ever comes from the fill threads, which seed their own PRNG.
+ * On a pool miss pk and sk are left untouched and the caller decides whether to retry
+ * or to generate the keypair itself.
+ *
+ * @param[out] pk String containing the public key
+ * @param[out] sk String containing the secret key
+ * @param[in] pool Pool to take the keypair from
+ * @returns 0 if a keypair was taken from the pool, -1 if the pool was empty
+ */
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, Keypair_pool *pool) {
+    return pool->pop(pk, sk) ? 0 : -1;
+}
+
+
+
+/**
+ * @brief Keygen of the HQC_KEM IND_CAA2 scheme served from a keypair pool, with the expanded secret key
+ *
+ * Same as the call above, for a pool created with expand set. expanded can be passed
+ * to crypto_kem_dec in place of the expansion of sk.
+ *
+ * @param[out] pk String containing the public key
+ * @param[out] sk String containing the secret key
+ * @param[out] expanded Secret key expanded by hqc_expand_secret_key
+ * @param[in] pool Pool to take the keypair from
+ * @returns 0 if a keypair was taken from the pool, -1 if the pool was empty or was created without expand
+ */
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, hqc_expanded_sk *expanded, Keypair_pool *pool) {
+    return pool->pop(pk, sk, expanded) ? 0 : -1;
+}
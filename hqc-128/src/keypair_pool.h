@@ -0,0 +1,90 @@
+#ifndef KEYPAIR_POOL_H
+#define KEYPAIR_POOL_H
+
+/**
+ * @file keypair_pool.h
+ * @brief Pool of pre-generated HQC_KEM keypairs filled by background threads
+ */
+
+#include "parameters.h"
+#include "vector.h"
+#include "workspace.h"
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * A ready keypair. expanded is the secret key expanded by hqc_expand_secret_key, filled only
+ * when the pool was created with expand set, in the form crypto_kem_dec takes it.
+ */
+struct Pooled_keypair {
+    uint8_t pk[PUBLIC_KEY_BYTES];
+    uint8_t sk[SECRET_KEY_BYTES];
+    hqc_expanded_sk expanded;
+};
+
+struct Keypair_pool_stats {
+    uint64_t hits; // Keypairs handed out from the pool
+    uint64_t misses; // Pops that found the pool empty
+    uint64_t generated; // Keypairs generated by the fill threads
+    uint64_t available; // Keypairs currently in the pool
+};
+
+/**
+ * Bounded lock-free MPMC ring of keypairs.
+ *
+ * Each slot carries a sequence number telling whether it is ready to be written or read,
+ * so producers and consumers only race on a compare-and-swap of the ring positions.
+ * The fill threads top the ring up to the high watermark, then sleep until a pop
+ * brings it down to the low watermark. Popped slots and the keypairs left at
+ * destruction or drain are zeroized.
+ */
+class Keypair_pool {
+    public:
+        Keypair_pool(size_t capacity, size_t low_watermark, size_t high_watermark, unsigned int fillers = 1, bool expand = false);
+        ~Keypair_pool();
+
+        Keypair_pool(const Keypair_pool&) = delete;
+        Keypair_pool& operator=(const Keypair_pool&) = delete;
+
+        bool pop(Pooled_keypair *keypair);
+        bool pop(uint8_t *pk, uint8_t *sk);
+        bool pop(uint8_t *pk, uint8_t *sk, hqc_expanded_sk *expanded);
+        size_t drain();
+        Keypair_pool_stats stats() const;
+
+    private:
+        struct Slot;
+
+        bool push(const Pooled_keypair *keypair);
+        bool take(Pooled_keypair *keypair);
+        void fill(unsigned int self);
+
+        size_t mask;
+        size_t low;
+        size_t high;
+        bool expand;
+        std::unique_ptr<Slot[]> slots;
+        std::unique_ptr<std::thread[]> threads;
+        std::unique_ptr<uint8_t[]> seeds;
+        unsigned int filler_count;
+
+        alignas(64) std::atomic<size_t> enqueue_position{0};
+        alignas(64) std::atomic<size_t> dequeue_position{0};
+        alignas(64) std::atomic<size_t> available{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> generated{0};
+
+        std::mutex sleep_lock;
+        std::condition_variable wake;
+        bool stopping = false;
+};
+
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, Keypair_pool *pool);
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, hqc_expanded_sk *expanded, Keypair_pool *pool);
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "api.h"
+#include "kem_engine.h"
+#include "parameters.h"
+#include "profiling.h"
+
+#define KEYS 16
+
+/**
+ * Scaling benchmark of Kem_engine: ops/sec of bulk encapsulation and decapsulation for 1..N workers.
+ * Usage: hqc-128-engine [max workers] [operations per run]
+ */
+int main(int argc, char **argv) {
+
+	unsigned int max_workers = (argc > 1) ? (unsigned int)atoi(argv[1]) : std::thread::hardware_concurrency();
+	int iter = (argc > 2) ? atoi(argv[2]) : 4000;
+	if (max_workers == 0) max_workers = 1;
+
+	printf("\n");
+	printf("*********************\n");
+	printf("**** HQC-%d-%d ****\n", PARAM_SECURITY, PARAM_DFR_EXP);
+	printf("*********************\n");
+
+	printf("\n");
+	printf("Work-stealing KEM engine, %d operations per run, %u worker(s) max\n", iter, max_workers);
+
+	std::vector<unsigned char> pk(KEYS * PUBLIC_KEY_BYTES);
+	std::vector<unsigned char> sk(KEYS * SECRET_KEY_BYTES);
+	std::vector<unsigned char> ct((size_t)iter * CIPHERTEXT_BYTES);
+	std::vector<unsigned char> key1((size_t)iter * SHARED_SECRET_BYTES);
+	std::vector<unsigned char> key2((size_t)iter * SHARED_SECRET_BYTES);
+
+	Trace_time keygen_time;
+	for (int i = 0; i < KEYS; i++) {
+		crypto_kem_keypair(&pk[i * PUBLIC_KEY_BYTES], &sk[i * SECRET_KEY_BYTES], &keygen_time);
+	}
+
+	double encap_base = 0;
+	double decap_base = 0;
+
+	printf("\n%8s %14s %9s %14s %9s %8s\n", "workers", "encap ops/s", "speedup", "decap ops/s", "speedup", "steals");
+	for (unsigned int workers = 1; workers <= max_workers; workers++) {
+		Kem_engine engine(workers);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iter; i++) {
+			engine.submit_enc(&ct[(size_t)i * CIPHERTEXT_BYTES], &key1[(size_t)i * SHARED_SECRET_BYTES], &pk[(i % KEYS) * PUBLIC_KEY_BYTES], nullptr);
+		}
+		engine.wait_idle();
+		auto middle = std::chrono::steady_clock::now();
+		for (int i = 0; i < iter; i++) {
+			engine.submit_dec(&key2[(size_t)i * SHARED_SECRET_BYTES], &ct[(size_t)i * CIPHERTEXT_BYTES], &sk[(i % KEYS) * SECRET_KEY_BYTES], nullptr);
+		}
+		engine.wait_idle();
+		auto end = std::chrono::steady_clock::now();
+
+		double encap_rate = iter / std::chrono::duration<double>(middle - start).count();
+		double decap_rate = iter / std::chrono::duration<double>(end - middle).count();
+		if (workers == 1) {
+			encap_base = encap_rate;
+			decap_base = decap_rate;
+		}
+
+		printf("%8u %14.1f %9.2f %14.1f %9.2f %8lu\n", workers, encap_rate, encap_rate / encap_base, decap_rate, decap_rate / decap_base, (unsigned long)engine.steal_count());
+
+		if (key1 != key2) {
+			printf("\nshared secrets differ with %u worker(s)\n", workers);
+			return 1;
+		}
+	}
+
+	printf("\n\nsecret1: ");
+	for(int i = 0 ; i < SHARED_SECRET_BYTES ; ++i) printf("%x", key1[i]);
+
+	printf("\nsecret2: ");
+	for(int i = 0 ; i < SHARED_SECRET_BYTES ; ++i) printf("%x", key2[i]);
+	printf("\n\n");
+
+	return 0;
+}
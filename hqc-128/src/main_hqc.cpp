@@ -1,10 +1,112 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <ucontext.h>
 #include "api.h"
 #include "parameters.h"
 #include "profiling.h"
+#include "workspace.h"
 
-int main() {
+#define PROBE_STACK_BYTES (256 * 1024)
+#define PROBE_PAINT 0xA5
+
+static unsigned char probe_pk[PUBLIC_KEY_BYTES];
+static unsigned char probe_sk[SECRET_KEY_BYTES];
+static unsigned char probe_ct[CIPHERTEXT_BYTES];
+static unsigned char probe_key1[SHARED_SECRET_BYTES];
+static unsigned char probe_key2[SHARED_SECRET_BYTES];
+static hqc_workspace probe_workspace;
+
+static ucontext_t probe_caller;
+static ucontext_t probe_fiber;
+static void (*probe_call)(void);
+
+static void probe_entry() {
+	probe_call();
+}
+
+/**
+ * Runs call on a fiber whose stack is painted beforehand and returns
+ * the number of bytes of that stack the call wrote to.
+ */
+static size_t peak_stack(void (*call)(void)) {
+	alignas(64) static unsigned char stack[PROBE_STACK_BYTES];
+	size_t untouched = 0;
+
+	memset(stack, PROBE_PAINT, PROBE_STACK_BYTES);
+	getcontext(&probe_fiber);
+	probe_fiber.uc_stack.ss_sp = stack;
+	probe_fiber.uc_stack.ss_size = PROBE_STACK_BYTES;
+	probe_fiber.uc_link = &probe_caller;
+	probe_call = call;
+	makecontext(&probe_fiber, probe_entry, 0);
+	swapcontext(&probe_caller, &probe_fiber);
+
+	while (untouched < PROBE_STACK_BYTES && stack[untouched] == PROBE_PAINT) {
+		untouched++;
+	}
+	return PROBE_STACK_BYTES - untouched;
+}
+
+/**
+ * Writes a histogram, in microseconds, to directory/name.hgrm and returns 0 on success
+ */
+static int write_histogram(const Latency_histogram& histogram, const char *directory, const char *name) {
+	char path[4096];
+
+	snprintf(path, sizeof(path), "%s/%s.hgrm", directory, name);
+	if (histogram.write(path, 1000.0)) {
+		printf("cannot write %s\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+static void stack_report() {
+	size_t keygen_stack = peak_stack([] { crypto_kem_keypair(probe_pk, probe_sk); });
+	size_t encap_stack = peak_stack([] { crypto_kem_enc(probe_ct, probe_key1, probe_pk); });
+	size_t decap_stack = peak_stack([] { crypto_kem_dec(probe_key2, probe_ct, probe_sk); });
+	int default_ok = !memcmp(probe_key1, probe_key2, SHARED_SECRET_BYTES);
+
+	size_t keygen_ws_stack = peak_stack([] { crypto_kem_keypair(probe_pk, probe_sk, &probe_workspace); });
+	size_t encap_ws_stack = peak_stack([] { crypto_kem_enc(probe_ct, probe_key1, probe_pk, &probe_workspace); });
+	size_t decap_ws_stack = peak_stack([] { crypto_kem_dec(probe_key2, probe_ct, probe_sk, &probe_workspace); });
+	int workspace_ok = !memcmp(probe_key1, probe_key2, SHARED_SECRET_BYTES);
+
+	printf("\npeak stack (bytes)   keygen   encap   decap\n");
+	printf("default API        %8zu %7zu %7zu   %s\n", keygen_stack, encap_stack, decap_stack, default_ok ? "ok" : "MISMATCH");
+	printf("workspace API      %8zu %7zu %7zu   %s\n", keygen_ws_stack, encap_ws_stack, decap_ws_stack, workspace_ok ? "ok" : "MISMATCH");
+	printf("workspace: %zu bytes, aligned on %d bytes\n", (size_t) HQC_WORKSPACE_BYTES, HQC_WORKSPACE_ALIGNMENT);
+}
+
+/**
+ * Benchmark of the scheme: latency percentiles, per-stage times and peak stack.
+ * The keygen, encaps and decaps latencies come from untraced calls, the stage ones from a second, traced pass.
+ * Usage: hqc-128 [--iterations N] [--warmup N] [--histograms DIR] [--perf]
+ */
+int main(int argc, char *argv[]) {
+	bool perf = false;
+	int iter = 20000;
+	int warmup = 100;
+	const char *histogram_dir = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--perf")) {
+			perf = true;
+		} else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) {
+			iter = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) {
+			warmup = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "--histograms") && i + 1 < argc) {
+			histogram_dir = argv[++i];
+		} else {
+			printf("usage: %s [--iterations N] [--warmup N] [--histograms DIR] [--perf]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (iter < 1) iter = 1;
+	if (warmup < 0) warmup = 0;
 
 	printf("\n");
 	printf("*********************\n");
@@ -26,20 +128,61 @@ int main() {
 	unsigned char ct[CIPHERTEXT_BYTES];
 	unsigned char key1[SHARED_SECRET_BYTES];
 	unsigned char key2[SHARED_SECRET_BYTES];
-	
-	int iter = 20000; 
+
+	// Warm-up runs fault the pages in and ramp the clock up, outside of every statistic
+	for (int i = 0; i < warmup; i++) {
+		crypto_kem_keypair(pk, sk);
+		crypto_kem_enc(ct, key1, pk);
+		crypto_kem_dec(key2, ct, sk);
+	}
+
+	// The operations are timed on the untraced calls, so that no stage bracket adds to their latency
+	static Latency_histogram keygen_latency, encap_latency, decap_latency;
+	for (int i = 0; i < iter; i++) {
+		uint64_t start = monotonic_ns();
+		crypto_kem_keypair(pk, sk);
+		uint64_t keygen_end = monotonic_ns();
+
+		crypto_kem_enc(ct, key1, pk);
+		uint64_t encap_end = monotonic_ns();
+
+		crypto_kem_dec(key2, ct, sk);
+		uint64_t decap_end = monotonic_ns();
+
+		keygen_latency.record(keygen_end - start);
+		encap_latency.record(encap_end - keygen_end);
+		decap_latency.record(decap_end - encap_end);
+	}
 
 	Trace_time keygen_time;
 	Trace_time encap_time;
 	Trace_time decap_time;
 
-	for (int i = 0; i < iter; i++) {
+	// Counters are opened on this thread, one group per operation
+	Perf_counters *keygen_counters = perf ? new Perf_counters() : nullptr;
+	Perf_counters *encap_counters = perf ? new Perf_counters() : nullptr;
+	Perf_counters *decap_counters = perf ? new Perf_counters() : nullptr;
+	keygen_time.counters = keygen_counters;
+	encap_time.counters = encap_counters;
+	decap_time.counters = decap_counters;
 
-		crypto_kem_keypair(pk, sk, &keygen_time);
+	// Then a separate traced pass records every bracket of the traced stages, in nanoseconds
+	static Latency_histogram vect_mul_latency, code_decode_latency, shake256_512_ds_latency;
+	Stage_clock stage_clock;
+	stage_clock.histograms[TRACE_VECT_MUL] = &vect_mul_latency;
+	stage_clock.histograms[TRACE_SHAKE256_512_DS] = &shake256_512_ds_latency;
+	keygen_time.stage_clock = &stage_clock;
+	encap_time.stage_clock = &stage_clock;
+	decap_time.stage_clock = &stage_clock;
 
+	for (int i = 0; i < iter; i++) {
+		crypto_kem_keypair(pk, sk, &keygen_time);
 		crypto_kem_enc(ct, key1, pk, &encap_time);
 
+		// code_decode is the Reed-Muller then Reed-Solomon decoding of the decapsulation
+		uint64_t decoding = stage_clock.elapsed[TRACE_RM_DECODE] + stage_clock.elapsed[TRACE_RS_DECODE];
 		crypto_kem_dec(key2, ct, sk, &decap_time);
+		code_decode_latency.record(stage_clock.elapsed[TRACE_RM_DECODE] + stage_clock.elapsed[TRACE_RS_DECODE] - decoding);
 	}
 
 	printf("\nkeygen\n");
@@ -51,6 +194,41 @@ int main() {
 	printf("rs-decode details \n");
 	rs_decode_detail_analysis(&decap_time);
 
+	if (perf) {
+		printf("keygen counters\n");
+		perf_analysis(&keygen_time);
+		printf("encap counters\n");
+		perf_analysis(&encap_time);
+		printf("decap counters\n");
+		perf_analysis(&decap_time);
+	}
+	delete keygen_counters;
+	delete encap_counters;
+	delete decap_counters;
+
+	printf("latency (us)        count        min        p50        p90        p99      p99.9        max       mean\n");
+	keygen_latency.print_percentiles("keygen", 1000.0);
+	encap_latency.print_percentiles("encaps", 1000.0);
+	decap_latency.print_percentiles("decaps", 1000.0);
+	vect_mul_latency.print_percentiles("vect_mul", 1000.0);
+	code_decode_latency.print_percentiles("code_decode", 1000.0);
+	shake256_512_ds_latency.print_percentiles("shake256_512_ds", 1000.0);
+
+	if (histogram_dir) {
+		int failed = 0;
+		failed |= write_histogram(keygen_latency, histogram_dir, "keygen");
+		failed |= write_histogram(encap_latency, histogram_dir, "encaps");
+		failed |= write_histogram(decap_latency, histogram_dir, "decaps");
+		failed |= write_histogram(vect_mul_latency, histogram_dir, "vect_mul");
+		failed |= write_histogram(code_decode_latency, histogram_dir, "code_decode");
+		failed |= write_histogram(shake256_512_ds_latency, histogram_dir, "shake256_512_ds");
+		if (!failed) {
+			printf("histograms written to %s\n", histogram_dir);
+		}
+	}
+
+	stack_report();
+
 
 	printf("\n\nsecret1: ");
 	for(int i = 0 ; i < SHARED_SECRET_BYTES ; ++i) printf("%x", key1[i]);
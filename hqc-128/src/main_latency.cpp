@@ -0,0 +1,121 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "api.h"
+#include "decaps_helpers.h"
+#include "parameters.h"
+#include "profiling.h"
+
+static double percentile(std::vector<double>& samples, double p);
+static void report(const char *name, std::vector<double>& samples);
+static void pin_caller(int cpu);
+
+
+/**
+ * @brief Returns the p-th percentile of the samples, sorting them in place
+ */
+static double percentile(std::vector<double>& samples, double p) {
+	std::sort(samples.begin(), samples.end());
+	size_t index = (size_t)(p * (samples.size() - 1) + 0.5);
+	return samples[index];
+}
+
+
+
+static void report(const char *name, std::vector<double>& samples) {
+	printf("%-22s %10.1f %10.1f %10.1f\n", name, percentile(samples, 0.50), percentile(samples, 0.99), percentile(samples, 1.0));
+}
+
+
+
+/**
+ * @brief Pins the calling thread on a CPU
+ */
+static void pin_caller(int cpu) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+		printf("cannot pin the caller on CPU %d\n", cpu);
+	}
+}
+
+
+
+/**
+ * Latency benchmark of the decapsulation: serial path against the low-latency mode with 1 and 2 helpers.
+ * The caller, the helper of the first mode and the two helpers of the second one are pinned on
+ * four consecutive CPUs, so that a helper still polling after its task never shares a core with another mode.
+ * Usage: hqc-128-latency [iterations] [first cpu, -1 for no pinning]
+ */
+int main(int argc, char **argv) {
+
+	int iter = (argc > 1) ? atoi(argv[1]) : 2000;
+	int first_cpu = (argc > 2) ? atoi(argv[2]) : 0;
+	if (iter < 1) iter = 1;
+
+	printf("\n");
+	printf("*********************\n");
+	printf("**** HQC-%d-%d ****\n", PARAM_SECURITY, PARAM_DFR_EXP);
+	printf("*********************\n");
+
+	unsigned char pk[PUBLIC_KEY_BYTES];
+	unsigned char sk[SECRET_KEY_BYTES];
+	unsigned char ct[CIPHERTEXT_BYTES];
+	unsigned char key1[SHARED_SECRET_BYTES];
+	unsigned char key2[SHARED_SECRET_BYTES];
+
+	Trace_time keygen_time;
+	Trace_time encap_time;
+	crypto_kem_keypair(pk, sk, &keygen_time);
+	crypto_kem_enc(ct, key1, pk, &encap_time);
+
+	if (first_cpu >= 0) {
+		int cpus = (int) std::thread::hardware_concurrency();
+		if (cpus > 0 && first_cpu + 4 > cpus) {
+			printf("\nonly %d CPUs from CPU %d, the caller and the helpers of both modes share cores\n", cpus - first_cpu, first_cpu);
+		}
+		pin_caller(cpus > 0 ? first_cpu % cpus : first_cpu);
+	}
+	Decaps_helpers one_helper(1, first_cpu < 0 ? -1 : first_cpu + 1);
+	Decaps_helpers two_helpers(2, first_cpu < 0 ? -1 : first_cpu + 2);
+	Decaps_helpers *modes[3] = {nullptr, &one_helper, &two_helpers};
+	const char *names[3] = {"serial", "low latency, 1 helper", "low latency, 2 helpers"};
+	std::vector<double> samples[3];
+
+	// Interleave the modes so that frequency and cache effects hit them evenly
+	for (int i = 0; i < iter; i++) {
+		for (int mode = 0; mode < 3; mode++) {
+			auto start = std::chrono::steady_clock::now();
+			crypto_kem_dec_low_latency(key2, ct, sk, modes[mode]);
+			auto end = std::chrono::steady_clock::now();
+			samples[mode].push_back(std::chrono::duration<double, std::micro>(end - start).count());
+
+			if (memcmp(key1, key2, SHARED_SECRET_BYTES) != 0) {
+				printf("\nshared secrets differ in mode '%s'\n", names[mode]);
+				return 1;
+			}
+		}
+	}
+
+	printf("\ndecap latency over %d runs (us)\n", iter);
+	printf("%-22s %10s %10s %10s\n", "mode", "p50", "p99", "max");
+	for (int mode = 0; mode < 3; mode++) {
+		report(names[mode], samples[mode]);
+	}
+
+	printf("\n\nsecret1: ");
+	for(int i = 0 ; i < SHARED_SECRET_BYTES ; ++i) printf("%x", key1[i]);
+
+	printf("\nsecret2: ");
+	for(int i = 0 ; i < SHARED_SECRET_BYTES ; ++i) printf("%x", key2[i]);
+	printf("\n\n");
+
+	return 0;
+}
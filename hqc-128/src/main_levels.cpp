@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "api.h"
+#include "fips202.h"
+#include "hqc_levels.h"
+#include "parameters.h"
+#include "profiling.h"
+#include "shake_prng.h"
+
+#define KAT_COUNT 100
+
+// SHA3-256 of the pk, sk, ct and ss of the 100 KAT entries of each level, in this order
+static const char *kat_digests[3] = {
+	"2d27c7a31013bfc931025f7905e7a8da42d3354fd6d7c75caa469ac87d5bfe7f",
+	"b8e3a6a2062fd012344e64e07e152368f1ecae2c4ce76dc432a3a646dfecd4f9",
+	"ea377efd21fd1e8b8134ef8be3b3703381c9a67171f08585a27d609cc4f61d04",
+};
+
+struct Kat_seeds {
+	unsigned char seed[KAT_COUNT][48];
+};
+
+static void generate_seeds(Kat_seeds *seeds);
+static void to_hex(char *hex, const unsigned char *bytes, size_t length);
+template <class P> static int check_level(const Kat_seeds *seeds, int count, const char *expected);
+static int check_api(const Kat_seeds *seeds, int count);
+
+
+/**
+ * @brief Draws the seeds of the KAT entries like the KAT generator (main_kat.c)
+ */
+static void generate_seeds(Kat_seeds *seeds) {
+	unsigned char entropy_input[48];
+
+	for (int i = 0; i < 48; i++) {
+		entropy_input[i] = i;
+	}
+
+	shake_prng_init(entropy_input, NULL, 48, 0);
+	for (int i = 0; i < KAT_COUNT; i++) {
+		shake_prng(seeds->seed[i], 48);
+	}
+}
+
+
+
+static void to_hex(char *hex, const unsigned char *bytes, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		sprintf(hex + 2 * i, "%02x", bytes[i]);
+	}
+}
+
+
+
+/**
+ * @brief Runs the KAT entries on Kem<P>: digest of pk, sk, ct and ss, round trip and implicit rejection
+ *
+ * @returns the number of failed checks
+ */
+template <class P>
+static int check_level(const Kat_seeds *seeds, int count, const char *expected) {
+	typedef hqc::Kem<P> kem;
+	std::vector<unsigned char> pk(kem::public_key_bytes);
+	std::vector<unsigned char> sk(kem::secret_key_bytes);
+	std::vector<unsigned char> ct(kem::ciphertext_bytes);
+	unsigned char ss1[kem::shared_secret_bytes];
+	unsigned char ss2[kem::shared_secret_bytes];
+	unsigned char ss3[kem::shared_secret_bytes];
+	unsigned char digest[32];
+	char hex[65];
+	sha3_256incctx state;
+	int failures = 0;
+
+	sha3_256_inc_init(&state);
+	for (int i = 0; i < count; i++) {
+		shake_prng_init((uint8_t *) seeds->seed[i], NULL, 48, 0);
+		kem::keypair(pk.data(), sk.data());
+		kem::encapsulate(ct.data(), ss1, pk.data());
+
+		sha3_256_inc_absorb(&state, pk.data(), pk.size());
+		sha3_256_inc_absorb(&state, sk.data(), sk.size());
+		sha3_256_inc_absorb(&state, ct.data(), ct.size());
+		sha3_256_inc_absorb(&state, ss1, sizeof(ss1));
+
+		if (kem::decapsulate(ss2, ct.data(), sk.data()) != 0 || memcmp(ss1, ss2, sizeof(ss1)) != 0) {
+			printf("  count %d: decapsulation does not recover the shared secret\n", i);
+			failures++;
+		}
+
+		ct[i % ct.size()] ^= 1;
+		if (kem::decapsulate(ss3, ct.data(), sk.data()) != -1 || memcmp(ss1, ss3, sizeof(ss1)) == 0) {
+			printf("  count %d: tampered ciphertext not rejected\n", i);
+			failures++;
+		}
+	}
+	sha3_256_inc_finalize(digest, &state);
+	to_hex(hex, digest, sizeof(digest));
+
+	printf("HQC-%zu: pk %zu, sk %zu, ct %zu bytes, KAT digest %s", P::security, kem::public_key_bytes, kem::secret_key_bytes, kem::ciphertext_bytes, hex);
+	if (count != KAT_COUNT) {
+		printf(" (%d entries, not checked)\n", count);
+	} else if (strcmp(hex, expected) == 0) {
+		printf(" OK\n");
+	} else {
+		printf(" MISMATCH, expected %s\n", expected);
+		failures++;
+	}
+
+	return failures;
+}
+
+
+
+/**
+ * @brief Compares Kem<hqc128_params> with the KEM of api.h on the KAT entries
+ *
+ * @returns the number of mismatching entries
+ */
+static int check_api(const Kat_seeds *seeds, int count) {
+	typedef hqc::Kem<hqc128_params> kem;
+	unsigned char pk1[PUBLIC_KEY_BYTES], sk1[SECRET_KEY_BYTES], ct1[CIPHERTEXT_BYTES], ss1[SHARED_SECRET_BYTES];
+	unsigned char pk2[PUBLIC_KEY_BYTES], sk2[SECRET_KEY_BYTES], ct2[CIPHERTEXT_BYTES], ss2[SHARED_SECRET_BYTES];
+	Trace_time keygen_time;
+	int failures = 0;
+
+	for (int i = 0; i < count; i++) {
+		shake_prng_init((uint8_t *) seeds->seed[i], NULL, 48, 0);
+		crypto_kem_keypair(pk1, sk1, &keygen_time);
+		crypto_kem_enc(ct1, ss1, pk1);
+
+		shake_prng_init((uint8_t *) seeds->seed[i], NULL, 48, 0);
+		kem::keypair(pk2, sk2);
+		kem::encapsulate(ct2, ss2, pk2);
+
+		if (memcmp(pk1, pk2, sizeof(pk1)) || memcmp(sk1, sk2, sizeof(sk1)) || memcmp(ct1, ct2, sizeof(ct1)) || memcmp(ss1, ss2, sizeof(ss1))) {
+			printf("  count %d: Kem<hqc128_params> differs from crypto_kem_*\n", i);
+			failures++;
+		}
+	}
+
+	printf("HQC-128: Kem<hqc128_params> against crypto_kem_* on %d entries: %s\n", count, failures ? "MISMATCH" : "OK");
+	return failures;
+}
+
+
+
+/**
+ * KAT checks of the HQC-128, HQC-192 and HQC-256 instantiations of hqc::Kem.
+ * Usage: hqc-levels-kat [entries], the digests are only checked on the 100 entries of the KAT files.
+ */
+int main(int argc, char **argv) {
+
+	int count = (argc > 1) ? atoi(argv[1]) : KAT_COUNT;
+	if (count < 1 || count > KAT_COUNT) count = KAT_COUNT;
+
+	static Kat_seeds seeds;
+	generate_seeds(&seeds);
+
+	printf("\n");
+	int failures = check_api(&seeds, count);
+	failures += check_level<hqc128_params>(&seeds, count, kat_digests[0]);
+	failures += check_level<hqc192_params>(&seeds, count, kat_digests[1]);
+	failures += check_level<hqc256_params>(&seeds, count, kat_digests[2]);
+	printf("\n");
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "api.h"
+#include "parameters.h"
+#include "staged_dec.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "main_staged.cpp checks the coroutine wrapper of staged_dec.h and needs C++20 coroutines"
+#endif
+
+#define HANDSHAKES 6
+#define TAMPERED 3
+
+/**
+ * Scheduler of an event loop batching the decapsulations by stage: each round resumes,
+ * in a row, every coroutine waiting for the earliest pending stage.
+ */
+class Batching_scheduler : public Dec_scheduler {
+	public:
+		void schedule(std::coroutine_handle<> handle, hqc_dec_stage next) override {
+			pending[next].push_back(handle);
+		}
+
+		/**
+		 * @brief Resumes the batch of the earliest stage having pending coroutines
+		 *
+		 * @returns Number of coroutines resumed, 0 once every decapsulation is done
+		 */
+		size_t run_round() {
+			for (int stage = 0; stage < HQC_DEC_DONE; stage++) {
+				if (!pending[stage].empty()) {
+					std::vector<std::coroutine_handle<>> batch;
+					batch.swap(pending[stage]);
+					for (std::coroutine_handle<> handle : batch) {
+						handle.resume();
+					}
+					return batch.size();
+				}
+			}
+			return 0;
+		}
+
+	private:
+		std::vector<std::coroutine_handle<>> pending[HQC_DEC_DONE];
+};
+
+static unsigned char pk[HANDSHAKES][PUBLIC_KEY_BYTES];
+static unsigned char sk[HANDSHAKES][SECRET_KEY_BYTES];
+static unsigned char ct[HANDSHAKES][CIPHERTEXT_BYTES];
+static unsigned char key1[HANDSHAKES][SHARED_SECRET_BYTES];
+static unsigned char key2[HANDSHAKES][SHARED_SECRET_BYTES];
+static unsigned char key3[HANDSHAKES][SHARED_SECRET_BYTES];
+static hqc_dec_state states[HANDSHAKES];
+
+/**
+ * Check of the coroutine wrapper of staged_dec.h: HANDSHAKES decapsulations, one of them
+ * with a tampered ciphertext, run as coroutines batched by stage, and their shared secrets
+ * and return values are compared with the ones of crypto_kem_dec.
+ */
+int main() {
+
+	printf("\n");
+	printf("*********************\n");
+	printf("**** HQC-%d-%d ****\n", PARAM_SECURITY, PARAM_DFR_EXP);
+	printf("*********************\n");
+
+	int expected[HANDSHAKES];
+	for (int i = 0; i < HANDSHAKES; i++) {
+		crypto_kem_keypair(pk[i], sk[i]);
+		crypto_kem_enc(ct[i], key1[i], pk[i]);
+		if (i == TAMPERED) {
+			ct[i][0] ^= 1;
+		}
+		expected[i] = crypto_kem_dec(key2[i], ct[i], sk[i]);
+	}
+
+	Batching_scheduler scheduler;
+	std::vector<Dec_task> tasks;
+	for (int i = 0; i < HANDSHAKES; i++) {
+		tasks.push_back(crypto_kem_dec_async(key3[i], &states[i], ct[i], sk[i], &scheduler));
+	}
+
+	int rounds = 0;
+	while (scheduler.run_round()) {
+		rounds++;
+	}
+
+	int failed = 0;
+	for (int i = 0; i < HANDSHAKES; i++) {
+		int ok = tasks[i].done() && tasks[i].result() == expected[i] && !memcmp(key2[i], key3[i], SHARED_SECRET_BYTES);
+		int agreed = !memcmp(key1[i], key3[i], SHARED_SECRET_BYTES);
+		printf("handshake %d%s: status %d, %s, %s\n", i, (i == TAMPERED) ? " (tampered)" : "", tasks[i].done() ? tasks[i].result() : 1,
+		       agreed ? "shared secret agreed" : "implicit rejection", ok ? "matches crypto_kem_dec" : "MISMATCH");
+		failed |= !ok || (agreed == (i == TAMPERED));
+	}
+
+	printf("\n%d handshakes in %d batched rounds: %s\n\n", HANDSHAKES, rounds, failed ? "FAIL" : "OK");
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+#ifndef PARAMETER_SET_H
+#define PARAMETER_SET_H
+
+/**
+ * @file parameter_set.h
+ * @brief Compile-time parameter sets of HQC-128, HQC-192 and HQC-256
+ *
+ * A parameter set carries the parameters of the scheme and every size derived from them as
+ * static constexpr members, so that the vector, code, PKE and KEM layers templated on it only see constants.
+ * The three sets share the field GF(2^8) and the RM(1,7) inner code.
+ */
+
+#include "galois_field.h"
+#include "gf.h"
+#include "parameters.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Parameters of one security level of HQC
+ *
+ * @tparam SECURITY Security level in bits
+ * @tparam N Length of the ambient space, a prime
+ * @tparam N1 Length of the Reed-Solomon code
+ * @tparam N2 Length of the duplicated Reed-Muller code, a multiple of 128
+ * @tparam OMEGA Weight of the secret vectors x and y
+ * @tparam OMEGA_R Weight of the encryption vectors r1 and r2
+ * @tparam OMEGA_E Weight of the encryption vector e
+ * @tparam K Dimension of the Reed-Solomon code, the message length in bytes
+ * @tparam DELTA Correction capacity of the Reed-Solomon code
+ * @tparam FFT The additive FFT takes a 2^FFT coefficient polynomial as input
+ */
+template <size_t SECURITY, size_t N, size_t N1, size_t N2, size_t OMEGA, size_t OMEGA_R, size_t OMEGA_E, size_t K, size_t DELTA, size_t FFT>
+struct ParameterSet {
+    static_assert(N % 64 != 0, "the reduction modulo X^N - 1 expects a partial last word");
+    static_assert(N2 % 128 == 0, "the Reed-Muller code is made of whole RM(1,7) codewords");
+    static_assert(N1 * N2 <= N, "the concatenated code must fit in the ambient space");
+    static_assert(DELTA + 1 <= ((size_t) 1 << FFT), "the error locator polynomial must fit in the FFT input");
+
+    typedef gf_field field;
+    typedef ReedSolomonCode<field, N1, K, DELTA> rs_code;
+
+    static constexpr size_t security = SECURITY;
+    static constexpr size_t n = N;
+    static constexpr size_t n1 = N1;
+    static constexpr size_t n2 = N2;
+    static constexpr size_t n1n2 = N1 * N2;
+    static constexpr size_t omega = OMEGA;
+    static constexpr size_t omega_r = OMEGA_R;
+    static constexpr size_t omega_e = OMEGA_E;
+    static constexpr size_t k = K;
+    static constexpr size_t delta = DELTA;
+    static constexpr size_t g = rs_code::g;
+    static constexpr size_t fft = FFT;
+    static constexpr size_t multiplicity = N2 / 128;
+
+    static constexpr size_t vec_n_size_bytes = CEIL_DIVIDE(N, 8);
+    static constexpr size_t vec_k_size_bytes = K;
+    static constexpr size_t vec_n1_size_bytes = N1;
+    static constexpr size_t vec_n1n2_size_bytes = CEIL_DIVIDE(N1 * N2, 8);
+    static constexpr size_t vec_n_size_64 = CEIL_DIVIDE(N, 64);
+    static constexpr size_t vec_k_size_64 = CEIL_DIVIDE(K, 8);
+    static constexpr size_t vec_n1_size_64 = CEIL_DIVIDE(N1, 8);
+    static constexpr size_t vec_n1n2_size_64 = CEIL_DIVIDE(N1 * N2, 64);
+    static constexpr uint64_t red_mask = ((uint64_t) 1 << (N % 64)) - 1;
+
+    static constexpr size_t seed_bytes = SEED_BYTES;
+    static constexpr size_t salt_size_bytes = SALT_SIZE_BYTES;
+    static constexpr size_t salt_size_64 = SALT_SIZE_64;
+    static constexpr size_t public_key_bytes = SEED_BYTES + vec_n_size_bytes;
+    static constexpr size_t secret_key_bytes = SEED_BYTES + K + public_key_bytes;
+    static constexpr size_t ciphertext_bytes = vec_n_size_bytes + vec_n1n2_size_bytes + SALT_SIZE_BYTES;
+    static constexpr size_t shared_secret_bytes = SHAKE256_512_BYTES;
+};
+
+typedef ParameterSet<128, 17669, 46, 384, 66, 75, 75, 16, 15, 4> hqc128_params;
+typedef ParameterSet<192, 35851, 56, 640, 100, 114, 114, 24, 16, 5> hqc192_params;
+typedef ParameterSet<256, 57637, 90, 640, 131, 149, 149, 32, 29, 5> hqc256_params;
+
+// Expands INSTANTIATE(P) for each parameter set, to explicitly instantiate the templates of a layer
+#define HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE) \
+    INSTANTIATE(hqc128_params) \
+    INSTANTIATE(hqc192_params) \
+    INSTANTIATE(hqc256_params)
+
+// The macros of parameters.h describe HQC-128
+static_assert(hqc128_params::n == PARAM_N && hqc128_params::n1 == PARAM_N1 && hqc128_params::n2 == PARAM_N2, "hqc128_params must match parameters.h");
+static_assert(hqc128_params::omega == PARAM_OMEGA && hqc128_params::omega_r == PARAM_OMEGA_R && hqc128_params::omega_e == PARAM_OMEGA_E, "hqc128_params must match parameters.h");
+static_assert(hqc128_params::g == PARAM_G && hqc128_params::fft == PARAM_FFT, "hqc128_params must match parameters.h");
+static_assert(hqc128_params::public_key_bytes == PUBLIC_KEY_BYTES && hqc128_params::secret_key_bytes == SECRET_KEY_BYTES, "hqc128_params must match api.h");
+static_assert(hqc128_params::ciphertext_bytes == CIPHERTEXT_BYTES && hqc128_params::shared_secret_bytes == SHARED_SECRET_BYTES, "hqc128_params must match api.h");
+
+// Sizes of the HQC-192 and HQC-256 KEMs of the specification
+static_assert(hqc192_params::public_key_bytes == 4522 && hqc192_params::secret_key_bytes == 4586 && hqc192_params::ciphertext_bytes == 8978, "HQC-192 sizes");
+static_assert(hqc256_params::public_key_bytes == 7245 && hqc256_params::secret_key_bytes == 7317 && hqc256_params::ciphertext_bytes == 14421, "HQC-256 sizes");
+
+#endif
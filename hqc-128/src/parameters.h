@@ -50,7 +50,6 @@
   #define PARAM_FFT                             The additive FFT takes a 2^PARAM_FFT polynomial as input
                                                 We use the FFT to compute the roots of sigma, whose degree if PARAM_DELTA=24
                                                 The smallest power of 2 greater than 24+1 is 32=2^5
-  #define RS_POLY_COEFS                         Coefficients of the generator polynomial of the Reed-Solomon code
 
   #define RED_MASK                              A mask fot the higher bits of a vector
   #define SHAKE256_512_BYTES                    Define the size of SHAKE-256 output in bytes
@@ -94,7 +93,6 @@
 #define PARAM_K                               16
 #define PARAM_G                               31
 #define PARAM_FFT                             4
-#define RS_POLY_COEFS 89,69,153,116,176,117,111,75,73,233,242,233,65,210,21,139,103,173,67,118,105,210,174,110,74,69,228,82,255,181,1
 
 #define RED_MASK                              BITMASK(PARAM_N, 64)
 #define SHAKE256_512_BYTES                    64
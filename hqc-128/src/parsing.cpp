@@ -4,6 +4,7 @@
  */
 
 #include "shake_prng.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include "parsing.h"
 #include "vector.h"
@@ -22,10 +23,11 @@
  * @param[in] sigma String used in HHK transform
  * @param[in] pk String containing the public key
  */
+template <class P>
 void hqc_secret_key_to_string(uint8_t *sk, const uint8_t *sk_seed, const uint8_t *sigma, const uint8_t *pk) {
-    memcpy(sk, sk_seed, SEED_BYTES);
-    memcpy(sk + SEED_BYTES, sigma, VEC_K_SIZE_BYTES);
-    memcpy(sk + SEED_BYTES + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
+    memcpy(sk, sk_seed, P::seed_bytes);
+    memcpy(sk + P::seed_bytes, sigma, P::vec_k_size_bytes);
+    memcpy(sk + P::seed_bytes + P::vec_k_size_bytes, pk, P::public_key_bytes);
 }
 
 
@@ -36,47 +38,79 @@ void hqc_secret_key_to_string(uint8_t *sk, const uint8_t *sk_seed, const uint8_t
  * The secret key is composed of the seed used to generate vectors <b>x</b> and <b>y</b>.
  * As technicality, the public key is appended to the secret key in order to respect NIST API.
  *
- * @param[out] x uint64_t representation of vector x
- * @param[out] y uint32_t representation of vector y
+ * @param[out] x Padded vector x
+ * @param[out] y Padded vector y
  * @param[in] sigma String used in HHK transform
  * @param[out] pk String containing the public key
  * @param[in] sk String containing the secret key
  */
-void hqc_secret_key_from_string(uint64_t *x, uint64_t *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk, Trace_time* decap_time) {
+template <class P>
+void hqc_secret_key_from_string(padded_vect<P> *x, padded_vect<P> *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk, Trace_time* decap_time) {
     seedexpander_state sk_seedexpander;
-    uint8_t sk_seed[SEED_BYTES] = {0};
+    uint8_t sk_seed[P::seed_bytes] = {0};
     clock_t start, end;
 
-    start = clock();
-    memcpy(sk_seed, sk, SEED_BYTES);
-    memcpy(sigma, sk + SEED_BYTES, VEC_K_SIZE_BYTES);
-    end = clock();
+    start = trace_start(decap_time, TRACE_PARSING);
+    memcpy(sk_seed, sk, P::seed_bytes);
+    memcpy(sigma, sk + P::seed_bytes, P::vec_k_size_bytes);
+    end = trace_stop(decap_time, TRACE_PARSING);
     decap_time->parsing_time += ((uint32_t)(end - start));
 
-    start = clock();
-    seedexpander_init(&sk_seedexpander, sk_seed, SEED_BYTES);
-    end = clock();
+    start = trace_start(decap_time, TRACE_SEEDEXPANDER_INIT);
+    seedexpander_init(&sk_seedexpander, sk_seed, P::seed_bytes);
+    end = trace_stop(decap_time, TRACE_SEEDEXPANDER_INIT);
     decap_time->seedexpander_init_time += ((uint32_t)(end - start));
     
-    start = clock();
-    vect_set_random_fixed_weight(&sk_seedexpander, x, PARAM_OMEGA);
-    vect_set_random_fixed_weight(&sk_seedexpander, y, PARAM_OMEGA);
-    end = clock();
+    start = trace_start(decap_time, TRACE_VECT_SET_RANDOM_FIXED_WEIGHT);
+    memset(x, 0, sizeof(padded_vect<P>));
+    memset(y, 0, sizeof(padded_vect<P>));
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, x->words, P::omega);
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, y->words, P::omega);
+    end = trace_stop(decap_time, TRACE_VECT_SET_RANDOM_FIXED_WEIGHT);
     decap_time->vect_set_random_fixed_weight_time += ((uint32_t)(end - start));
-    memcpy(pk, sk + SEED_BYTES + VEC_K_SIZE_BYTES, PUBLIC_KEY_BYTES);
+    memcpy(pk, sk + P::seed_bytes + P::vec_k_size_bytes, P::public_key_bytes);
 }
 
-void hqc_secret_key_from_string(uint64_t *x, uint64_t *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk) {
+template <class P>
+void hqc_secret_key_from_string(padded_vect<P> *x, padded_vect<P> *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk) {
     seedexpander_state sk_seedexpander;
-    uint8_t sk_seed[SEED_BYTES] = {0};
+    uint8_t sk_seed[P::seed_bytes] = {0};
 
-    memcpy(sk_seed, sk, SEED_BYTES);
-    memcpy(sigma, sk + SEED_BYTES, VEC_K_SIZE_BYTES);
-    seedexpander_init(&sk_seedexpander, sk_seed, SEED_BYTES);
+    memcpy(sk_seed, sk, P::seed_bytes);
+    memcpy(sigma, sk + P::seed_bytes, P::vec_k_size_bytes);
+    seedexpander_init(&sk_seedexpander, sk_seed, P::seed_bytes);
 
-    vect_set_random_fixed_weight(&sk_seedexpander, x, PARAM_OMEGA);
-    vect_set_random_fixed_weight(&sk_seedexpander, y, PARAM_OMEGA);
-    memcpy(pk, sk + SEED_BYTES + VEC_K_SIZE_BYTES, PUBLIC_KEY_BYTES);
+    memset(x, 0, sizeof(padded_vect<P>));
+    memset(y, 0, sizeof(padded_vect<P>));
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, x->words, P::omega);
+    vect_set_random_fixed_weight<P>(&sk_seedexpander, y->words, P::omega);
+    memcpy(pk, sk + P::seed_bytes + P::vec_k_size_bytes, P::public_key_bytes);
+}
+
+
+
+/**
+ * @brief Parse a secret key from a string, sampling into caller-provided scratch
+ *
+ * @param[out] x Padded vector x
+ * @param[out] y Padded vector y
+ * @param[out] sigma String used in HHK transform
+ * @param[out] pk String containing the public key
+ * @param[in] sk String containing the secret key
+ * @param[in] scratch Scratch of vect_set_random_fixed_weight
+ */
+template <class P>
+void hqc_secret_key_from_string(padded_vect<P> *x, padded_vect<P> *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk, sampling_scratch<P> *scratch) {
+    seedexpander_state sk_seedexpander;
+
+    memcpy(sigma, sk + P::seed_bytes, P::vec_k_size_bytes);
+    seedexpander_init(&sk_seedexpander, sk, P::seed_bytes);
+
+    memset(x, 0, sizeof(padded_vect<P>));
+    memset(y, 0, sizeof(padded_vect<P>));
+    vect_set_random_fixed_weight(&sk_seedexpander, x->words, P::omega, scratch);
+    vect_set_random_fixed_weight(&sk_seedexpander, y->words, P::omega, scratch);
+    memcpy(pk, sk + P::seed_bytes + P::vec_k_size_bytes, P::public_key_bytes);
 }
 
 
@@ -88,11 +122,12 @@ void hqc_secret_key_from_string(uint64_t *x, uint64_t *y, uint8_t *sigma, uint8_
  *
  * @param[out] pk String containing the public key
  * @param[in] pk_seed Seed used to generate the public key
- * @param[in] s uint8_t representation of vector s
+ * @param[in] s Padded vector s
  */
-void hqc_public_key_to_string(uint8_t *pk, const uint8_t *pk_seed, const uint64_t *s) {
-    memcpy(pk, pk_seed, SEED_BYTES);
-    memcpy(pk + SEED_BYTES, s, VEC_N_SIZE_BYTES);
+template <class P>
+void hqc_public_key_to_string(uint8_t *pk, const uint8_t *pk_seed, const padded_vect<P> *s) {
+    memcpy(pk, pk_seed, P::seed_bytes);
+    memcpy(pk + P::seed_bytes, s->words, P::vec_n_size_bytes);
 }
 
 
@@ -102,39 +137,43 @@ void hqc_public_key_to_string(uint8_t *pk, const uint8_t *pk_seed, const uint64_
  *
  * The public key is composed of the syndrome <b>s</b> as well as the seed used to generate the vector <b>h</b>
  *
- * @param[out] h uint8_t representation of vector h
- * @param[out] s uint8_t representation of vector s
+ * @param[out] h Padded vector h
+ * @param[out] s Padded vector s
  * @param[in] pk String containing the public key
  */
-void hqc_public_key_from_string(uint64_t *h, uint64_t *s, const uint8_t *pk) {
+template <class P>
+void hqc_public_key_from_string(padded_vect<P> *h, padded_vect<P> *s, const uint8_t *pk) {
     seedexpander_state pk_seedexpander;
-    uint8_t pk_seed[SEED_BYTES] = {0};
+    uint8_t pk_seed[P::seed_bytes] = {0};
 
-    memcpy(pk_seed, pk, SEED_BYTES);
-    seedexpander_init(&pk_seedexpander, pk_seed, SEED_BYTES);
+    memcpy(pk_seed, pk, P::seed_bytes);
+    seedexpander_init(&pk_seedexpander, pk_seed, P::seed_bytes);
     vect_set_random(&pk_seedexpander, h);
 
-    memcpy(s, pk + SEED_BYTES, VEC_N_SIZE_BYTES);
+    memcpy(s->words, pk + P::seed_bytes, P::vec_n_size_bytes);
+    vect_clear_padding(s, P::vec_n_size_bytes);
 }
 
-void hqc_public_key_from_string(uint64_t *h, uint64_t *s, const uint8_t *pk, Trace_time* common_time) {
+template <class P>
+void hqc_public_key_from_string(padded_vect<P> *h, padded_vect<P> *s, const uint8_t *pk, Trace_time* common_time) {
     seedexpander_state pk_seedexpander;
-    uint8_t pk_seed[SEED_BYTES] = {0};
+    uint8_t pk_seed[P::seed_bytes] = {0};
     clock_t start, end;
 
-    memcpy(pk_seed, pk, SEED_BYTES);
+    memcpy(pk_seed, pk, P::seed_bytes);
 
-    start = clock();
-    seedexpander_init(&pk_seedexpander, pk_seed, SEED_BYTES);
-    end = clock();
+    start = trace_start(common_time, TRACE_SEEDEXPANDER_INIT);
+    seedexpander_init(&pk_seedexpander, pk_seed, P::seed_bytes);
+    end = trace_stop(common_time, TRACE_SEEDEXPANDER_INIT);
     common_time->seedexpander_init_time += ((uint32_t)(end - start));
 
-    start = clock();
+    start = trace_start(common_time, TRACE_VECT_SET_RANDOM);
     vect_set_random(&pk_seedexpander, h);
-    end = clock();
+    end = trace_stop(common_time, TRACE_VECT_SET_RANDOM);
     common_time->vect_set_random_time += ((uint32_t)(end - start));
 
-    memcpy(s, pk + SEED_BYTES, VEC_N_SIZE_BYTES);
+    memcpy(s->words, pk + P::seed_bytes, P::vec_n_size_bytes);
+    vect_clear_padding(s, P::vec_n_size_bytes);
 }
 
 /**
@@ -143,14 +182,15 @@ void hqc_public_key_from_string(uint64_t *h, uint64_t *s, const uint8_t *pk, Tra
  * The ciphertext is composed of vectors <b>u</b>, <b>v</b> and salt.
  *
  * @param[out] ct String containing the ciphertext
- * @param[in] u uint8_t representation of vector u
- * @param[in] v uint8_t representation of vector v
+ * @param[in] u Padded vector u
+ * @param[in] v Padded vector v
  * @param[in] salt String containing a salt
  */
-void hqc_ciphertext_to_string(uint8_t *ct, const uint64_t *u, const uint64_t *v, const uint64_t *salt) {
-    memcpy(ct, u, VEC_N_SIZE_BYTES);
-    memcpy(ct + VEC_N_SIZE_BYTES, v, VEC_N1N2_SIZE_BYTES);
-    memcpy(ct + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, salt, SALT_SIZE_BYTES);
+template <class P>
+void hqc_ciphertext_to_string(uint8_t *ct, const padded_vect<P> *u, const padded_vect<P> *v, const uint64_t *salt) {
+    memcpy(ct, u->words, P::vec_n_size_bytes);
+    memcpy(ct + P::vec_n_size_bytes, v->words, P::vec_n1n2_size_bytes);
+    memcpy(ct + P::vec_n_size_bytes + P::vec_n1n2_size_bytes, salt, P::salt_size_bytes);
 }
 
 
@@ -160,13 +200,31 @@ void hqc_ciphertext_to_string(uint8_t *ct, const uint64_t *u, const uint64_t *v,
  *
  * The ciphertext is composed of vectors <b>u</b>, <b>v</b> and salt.
  *
- * @param[out] u uint8_t representation of vector u
- * @param[out] v uint8_t representation of vector v
+ * @param[out] u Padded vector u
+ * @param[out] v Padded vector v
  * @param[out] d String containing the hash d
  * @param[in] ct String containing the ciphertext
  */
-void hqc_ciphertext_from_string(uint64_t *u, uint64_t *v, uint64_t *salt, const uint8_t *ct) {
-    memcpy(u, ct, VEC_N_SIZE_BYTES);
-    memcpy(v, ct + VEC_N_SIZE_BYTES, VEC_N1N2_SIZE_BYTES);
-    memcpy(salt, ct + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, SALT_SIZE_BYTES);
+template <class P>
+void hqc_ciphertext_from_string(padded_vect<P> *u, padded_vect<P> *v, uint64_t *salt, const uint8_t *ct) {
+    memcpy(u->words, ct, P::vec_n_size_bytes);
+    vect_clear_padding(u, P::vec_n_size_bytes);
+    memcpy(v->words, ct + P::vec_n_size_bytes, P::vec_n1n2_size_bytes);
+    vect_clear_padding(v, P::vec_n1n2_size_bytes);
+    memcpy(salt, ct + P::vec_n_size_bytes + P::vec_n1n2_size_bytes, P::salt_size_bytes);
 }
+
+
+
+#define INSTANTIATE_PARSING(P) \
+    template void hqc_secret_key_to_string<P>(uint8_t *, const uint8_t *, const uint8_t *, const uint8_t *); \
+    template void hqc_secret_key_from_string<P>(padded_vect<P> *, padded_vect<P> *, uint8_t *, uint8_t *, const uint8_t *); \
+    template void hqc_secret_key_from_string<P>(padded_vect<P> *, padded_vect<P> *, uint8_t *, uint8_t *, const uint8_t *, Trace_time *); \
+    template void hqc_secret_key_from_string<P>(padded_vect<P> *, padded_vect<P> *, uint8_t *, uint8_t *, const uint8_t *, sampling_scratch<P> *); \
+    template void hqc_public_key_to_string<P>(uint8_t *, const uint8_t *, const padded_vect<P> *); \
+    template void hqc_public_key_from_string<P>(padded_vect<P> *, padded_vect<P> *, const uint8_t *); \
+    template void hqc_public_key_from_string<P>(padded_vect<P> *, padded_vect<P> *, const uint8_t *, Trace_time *); \
+    template void hqc_ciphertext_to_string<P>(uint8_t *, const padded_vect<P> *, const padded_vect<P> *, const uint64_t *); \
+    template void hqc_ciphertext_from_string<P>(padded_vect<P> *, padded_vect<P> *, uint64_t *, const uint8_t *);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_PARSING)
@@ -8,16 +8,18 @@
 
 #include <stdint.h>
 #include "profiling.h"
+#include "vector.h"
 
-void hqc_secret_key_to_string(uint8_t *sk, const uint8_t *sk_seed, const uint8_t *sigma, const uint8_t *pk);
-void hqc_secret_key_from_string(uint64_t *x, uint64_t *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk);
-void hqc_secret_key_from_string(uint64_t *x, uint64_t *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk, Trace_time* decap_time);
+template <class P> void hqc_secret_key_to_string(uint8_t *sk, const uint8_t *sk_seed, const uint8_t *sigma, const uint8_t *pk);
+template <class P> void hqc_secret_key_from_string(padded_vect<P> *x, padded_vect<P> *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk);
+template <class P> void hqc_secret_key_from_string(padded_vect<P> *x, padded_vect<P> *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk, Trace_time* decap_time);
+template <class P> void hqc_secret_key_from_string(padded_vect<P> *x, padded_vect<P> *y, uint8_t *sigma, uint8_t *pk, const uint8_t *sk, sampling_scratch<P> *scratch);
 
-void hqc_public_key_to_string(uint8_t *pk, const uint8_t *pk_seed, const uint64_t *s);
-void hqc_public_key_from_string(uint64_t *h, uint64_t *s, const uint8_t *pk);
-void hqc_public_key_from_string(uint64_t *h, uint64_t *s, const uint8_t *pk, Trace_time* common_time);
+template <class P> void hqc_public_key_to_string(uint8_t *pk, const uint8_t *pk_seed, const padded_vect<P> *s);
+template <class P> void hqc_public_key_from_string(padded_vect<P> *h, padded_vect<P> *s, const uint8_t *pk);
+template <class P> void hqc_public_key_from_string(padded_vect<P> *h, padded_vect<P> *s, const uint8_t *pk, Trace_time* common_time);
 
-void hqc_ciphertext_to_string(uint8_t *ct, const uint64_t *u, const uint64_t *v, const uint64_t *salt);
-void hqc_ciphertext_from_string(uint64_t *u, uint64_t *v, uint64_t *salt, const uint8_t *ct);
+template <class P> void hqc_ciphertext_to_string(uint8_t *ct, const padded_vect<P> *u, const padded_vect<P> *v, const uint64_t *salt);
+template <class P> void hqc_ciphertext_from_string(padded_vect<P> *u, padded_vect<P> *v, uint64_t *salt, const uint8_t *ct);
 
 #endif
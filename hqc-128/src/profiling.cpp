@@ -1,6 +1,22 @@
 #include "profiling.h"
 #include <cstdio>
 #include <iomanip> // For setw() function
+#include <math.h>
+#include <string.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *const trace_stage_names[TRACE_STAGES] = {
+    "shake_prng", "seedexpander_init", "vect_set_random_fixed_weight", "vect_operation", "parsing",
+    "[Encode] rs_encode", "[Encode] rm_encode", "vect_set_random", "[Decode] rs_decode", "[Decode] rm_decode",
+    "shake256_512_ds", "  compute_syndromes", "  compute_elp", "  compute_roots", "  compute_z_poly",
+    "  compute_error_values", "  correct_errors",
+    "  vect_mul"
+};
 
 void time_analysis(Trace_time* trace_time) {
     // Exclude stack, shake_prng_time, seedexpander_init_time, and parsing_time
@@ -89,3 +105,354 @@ void rs_decode_detail_analysis(const Trace_time* trace_time) {
     printf("%-38s %.6fms (%.2f%%)\n", "Correct Errors:", correct_errors_ms, correct_errors_percent);
     printf("\n");
 }
+
+
+
+#ifdef __linux__
+/**
+ * @brief Opens one event of the calling thread, user space only
+ *
+ * @param[in] type Event type of perf_event_attr
+ * @param[in] config Event of that type
+ * @param[in] group Descriptor of the group leader, or -1 to open a leader
+ * @returns the descriptor of the event, or -1 if it cannot be counted
+ */
+static int perf_open(uint32_t type, uint64_t config, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+
+
+Perf_counters::Perf_counters() {
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        fds[e] = -1;
+        slot[e] = -1;
+    }
+#ifdef __linux__
+    static const uint32_t types[PERF_EVENTS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+    };
+    static const uint64_t configs[PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int opened = 0;
+
+    // The first event that opens leads the group, the others join it
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        fds[e] = perf_open(types[e], configs[e], leader);
+        if (fds[e] < 0) {
+            continue;
+        }
+        if (leader < 0) {
+            leader = fds[e];
+        }
+        slot[e] = opened++;
+    }
+    if (leader < 0) {
+        reason = "perf_event_open failed (no PMU access, see /proc/sys/kernel/perf_event_paranoid)";
+        return;
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    // Some hypervisors hand out counters that never count: check the group moves
+    uint64_t before[PERF_EVENTS] = {0}, after[PERF_EVENTS] = {0};
+    volatile uint64_t spin = 0;
+    read_group(before);
+    for (int i = 0; i < 100000; i++) {
+        spin = spin + i;
+    }
+    read_group(after);
+    uint64_t moved = 0;
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        moved |= after[e] - before[e];
+    }
+    if (!moved) {
+        reason = "hardware counters opened but do not count";
+        for (int e = 0; e < PERF_EVENTS; e++) {
+            if (fds[e] >= 0) {
+                close(fds[e]);
+            }
+            fds[e] = -1;
+            slot[e] = -1;
+        }
+        leader = -1;
+    }
+#else
+    reason = "hardware counters need Linux perf_event_open";
+#endif
+}
+
+
+
+Perf_counters::~Perf_counters() {
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            close(fds[e]);
+        }
+    }
+#endif
+}
+
+
+
+/**
+ * @brief Reads every event of the group with one system call
+ *
+ * @param[out] values Counts indexed by Perf_event, 0 for the events that are not available
+ */
+void Perf_counters::read_group(uint64_t *values) const {
+    uint64_t buffer[1 + PERF_EVENTS] = {0};
+
+#ifdef __linux__
+    if (read(leader, buffer, sizeof(buffer)) < (ssize_t) sizeof(uint64_t)) {
+        memset(buffer, 0, sizeof(buffer));
+    }
+#endif
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        values[e] = slot[e] >= 0 && (uint64_t) slot[e] < buffer[0] ? buffer[1 + slot[e]] : 0;
+    }
+}
+
+
+
+void Perf_counters::begin(Trace_stage stage) {
+    if (leader >= 0) {
+        read_group(started[stage]);
+    }
+}
+
+
+
+void Perf_counters::end(Trace_stage stage) {
+    uint64_t values[PERF_EVENTS];
+
+    if (leader < 0) {
+        return;
+    }
+    read_group(values);
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        totals[stage][e] += values[e] - started[stage][e];
+    }
+    counts[stage] += 1;
+}
+
+
+
+/**
+ * @brief Prints the hardware counters gathered per stage, averaged over the KEM operations
+ *
+ * Every bracket costs a read() system call while counters are attached, so the times of
+ * time_analysis are inflated in that mode; the counters themselves exclude the kernel.
+ *
+ * @param[in] trace_time Trace whose counters are printed
+ */
+void perf_analysis(const Trace_time* trace_time) {
+    const Perf_counters *counters = trace_time->counters;
+    double ops = trace_time->stack ? static_cast<double>(trace_time->stack) : 1.0;
+
+    if (!counters || !counters->available()) {
+        printf("Hardware counters unavailable: %s\n\n", counters && counters->error() ? counters->error() : "not attached (run with --perf)");
+        return;
+    }
+
+    printf("%-32s %8s %12s %6s %10s %10s %10s\n", "Stage (per KEM op)", "calls", "cycles", "IPC", "L1D miss", "LLC miss", "br miss");
+    printf("-------------------------------- -------- ------------ ------ ---------- ---------- ----------\n");
+    for (int s = 0; s < TRACE_STAGES; s++) {
+        Trace_stage stage = (Trace_stage) s;
+        if (counters->calls(stage) == 0) {
+            continue;
+        }
+        printf("%-32s %8.1f", trace_stage_names[s], counters->calls(stage) / ops);
+
+        if (counters->available(PERF_CYCLES)) {
+            printf(" %12.0f", counters->total(stage, PERF_CYCLES) / ops);
+        } else {
+            printf(" %12s", "n/a");
+        }
+        if (counters->available(PERF_CYCLES) && counters->available(PERF_INSTRUCTIONS) && counters->total(stage, PERF_CYCLES)) {
+            printf(" %6.2f", counters->total(stage, PERF_INSTRUCTIONS) / static_cast<double>(counters->total(stage, PERF_CYCLES)));
+        } else {
+            printf(" %6s", "n/a");
+        }
+        for (int e = PERF_L1D_MISSES; e <= PERF_BRANCH_MISSES; e++) {
+            if (counters->available((Perf_event) e)) {
+                printf(" %10.1f", counters->total(stage, (Perf_event) e) / ops);
+            } else {
+                printf(" %10s", "n/a");
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+
+
+/**
+ * @brief Index of the bucket counting a value
+ *
+ * Values below 2^(LATENCY_SUB_BUCKET_BITS + 1) have a bucket of their own. Above, a value whose
+ * most significant bit is b lands in the sub-bucket (value >> shift) of the power of two 2^b,
+ * with shift = b - LATENCY_SUB_BUCKET_BITS.
+ *
+ * @param[in] value Value, at most LATENCY_MAX_VALUE
+ * @returns the index of its bucket
+ */
+uint32_t Latency_histogram::index_of(uint64_t value) {
+    uint32_t shift = 0;
+
+    if (value >> (LATENCY_SUB_BUCKET_BITS + 1)) {
+        shift = 63 - __builtin_clzll(value) - LATENCY_SUB_BUCKET_BITS;
+    }
+    return (shift << LATENCY_SUB_BUCKET_BITS) + (uint32_t) (value >> shift);
+}
+
+
+
+/**
+ * @brief Largest value counted by a bucket
+ *
+ * @param[in] index Index of the bucket
+ * @returns the largest value whose index is index
+ */
+uint64_t Latency_histogram::highest_equivalent(uint32_t index) {
+    uint32_t shift = 0;
+
+    if (index >> (LATENCY_SUB_BUCKET_BITS + 1)) {
+        shift = (index >> LATENCY_SUB_BUCKET_BITS) - 1;
+    }
+    uint64_t sub_bucket = index - (shift << LATENCY_SUB_BUCKET_BITS);
+    return (sub_bucket << shift) + ((UINT64_C(1) << shift) - 1);
+}
+
+
+
+void Latency_histogram::record(uint64_t value) {
+    counts[index_of(value < LATENCY_MAX_VALUE ? value : LATENCY_MAX_VALUE)] += 1;
+    total += 1;
+    sum += (double) value;
+    sum_squares += (double) value * (double) value;
+    lowest = value < lowest ? value : lowest;
+    highest = value > highest ? value : highest;
+}
+
+
+
+void Latency_histogram::reset() {
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    lowest = UINT64_MAX;
+    highest = 0;
+    sum = 0;
+    sum_squares = 0;
+}
+
+
+
+double Latency_histogram::mean() const {
+    return total ? sum / (double) total : 0;
+}
+
+
+
+double Latency_histogram::deviation() const {
+    double average = mean();
+    double variance = total ? sum_squares / (double) total - average * average : 0;
+    return variance > 0 ? sqrt(variance) : 0;
+}
+
+
+
+/**
+ * @brief Value below which a given share of the recorded values fall
+ *
+ * Reported as the largest value of the bucket reaching that share, capped by the maximum,
+ * as HdrHistogram does.
+ *
+ * @param[in] percent Share of the values, between 0 and 100
+ * @returns the value at that percentile, 0 if nothing was recorded
+ */
+uint64_t Latency_histogram::percentile(double percent) const {
+    uint64_t target = (uint64_t) (percent / 100.0 * (double) total + 0.5);
+    uint64_t seen = 0;
+
+    target = target ? target : 1;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS && total; i++) {
+        seen += counts[i];
+        if (seen >= target) {
+            uint64_t value = highest_equivalent(i);
+            return value < highest ? value : highest;
+        }
+    }
+    return highest;
+}
+
+
+
+/**
+ * @brief Prints the count and the main percentiles of a histogram on one line
+ *
+ * @param[in] name Name of the histogram
+ * @param[in] unit Recorded units per printed unit
+ */
+void Latency_histogram::print_percentiles(const char *name, double unit) const {
+    printf("%-18s %8llu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", name, (unsigned long long) total,
+           min() / unit, percentile(50.0) / unit, percentile(90.0) / unit, percentile(99.0) / unit,
+           percentile(99.9) / unit, max() / unit, mean() / unit);
+}
+
+
+
+/**
+ * @brief Writes a histogram in the percentile distribution format of HdrHistogram
+ *
+ * One line per non-empty bucket with its value, cumulative percentile, cumulative count and
+ * 1/(1-percentile), followed by the summary lines, so that the HdrHistogram plotters read it.
+ *
+ * @param[in] path Path of the file to write
+ * @param[in] unit Recorded units per written unit
+ * @returns 0 if the file was written, -1 otherwise
+ */
+int Latency_histogram::write(const char *path, double unit) const {
+    FILE *file = fopen(path, "w");
+    uint64_t seen = 0;
+
+    if (!file) {
+        return -1;
+    }
+
+    fprintf(file, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+        if (!counts[i]) {
+            continue;
+        }
+        uint64_t value = highest_equivalent(i);
+        double fraction = (double) (seen += counts[i]) / (double) total;
+        if (seen < total) {
+            fprintf(file, "%12.3f %2.12f %10llu %14.2f\n", value / unit, fraction, (unsigned long long) seen, 1.0 / (1.0 - fraction));
+        } else {
+            fprintf(file, "%12.3f %2.12f %10llu\n", (value < highest ? value : highest) / unit, fraction, (unsigned long long) seen);
+        }
+    }
+    fprintf(file, "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mean() / unit, deviation() / unit);
+    fprintf(file, "#[Max     = %12.3f, Total count    = %12llu]\n", max() / unit, (unsigned long long) total);
+
+    return fclose(file) ? -1 : 0;
+}
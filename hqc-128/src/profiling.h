@@ -1,8 +1,134 @@
 #ifndef PROFILING_H
 #define PROFILING_H
 
+#include <chrono>
 #include <cstdint>
 #include <stdio.h>
+#include <time.h>
+
+// Stages bracketed by Trace_time, one per *_time field, then the sub-stages only seen by
+// the optional counters and stage clocks
+enum Trace_stage {
+  TRACE_SHAKE_PRNG,
+  TRACE_SEEDEXPANDER_INIT,
+  TRACE_VECT_SET_RANDOM_FIXED_WEIGHT,
+  TRACE_VECT_OPERATION,
+  TRACE_PARSING,
+  TRACE_RS_ENCODE,
+  TRACE_RM_ENCODE,
+  TRACE_VECT_SET_RANDOM,
+  TRACE_RS_DECODE,
+  TRACE_RM_DECODE,
+  TRACE_SHAKE256_512_DS,
+  TRACE_COMPUTE_SYNDROMES,
+  TRACE_COMPUTE_ELP,
+  TRACE_COMPUTE_ROOTS,
+  TRACE_COMPUTE_Z_POLY,
+  TRACE_COMPUTE_ERROR_VALUES,
+  TRACE_CORRECT_ERRORS,
+  TRACE_VECT_MUL,
+  TRACE_STAGES
+};
+
+// Hardware events counted around each stage
+enum Perf_event {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_EVENTS
+};
+
+/**
+ * Hardware performance counters of the calling thread (Linux perf_event_open), read around the
+ * stages of a Trace_time. The events are opened as one group and read with a single system call
+ * per bracket. Events the kernel or the CPU refuses are left out; when none can be opened the
+ * object stays unavailable and the brackets only measure time.
+ */
+class Perf_counters {
+  public:
+    Perf_counters();
+    ~Perf_counters();
+    Perf_counters(const Perf_counters&) = delete;
+    Perf_counters& operator=(const Perf_counters&) = delete;
+
+    bool available() const { return leader >= 0; }
+    bool available(Perf_event event) const { return slot[event] >= 0; }
+    const char *error() const { return reason; }
+
+    void begin(Trace_stage stage);
+    void end(Trace_stage stage);
+
+    uint64_t calls(Trace_stage stage) const { return counts[stage]; }
+    uint64_t total(Trace_stage stage, Perf_event event) const { return totals[stage][event]; }
+
+  private:
+    void read_group(uint64_t *values) const;
+
+    int leader = -1;
+    int fds[PERF_EVENTS];
+    int slot[PERF_EVENTS];
+    const char *reason = nullptr;
+    uint64_t started[TRACE_STAGES][PERF_EVENTS] = {};
+    uint64_t totals[TRACE_STAGES][PERF_EVENTS] = {};
+    uint64_t counts[TRACE_STAGES] = {};
+};
+
+/**
+ * HDR-style log-linear latency histogram: values below 2^(LATENCY_SUB_BUCKET_BITS + 1) are
+ * counted exactly, larger ones in 2^LATENCY_SUB_BUCKET_BITS linear sub-buckets per power of two,
+ * so that every recorded value is kept within 1/128 of its true value up to LATENCY_MAX_VALUE.
+ * Recording is a few shifts and an increment, with no allocation.
+ */
+#define LATENCY_SUB_BUCKET_BITS 7
+#define LATENCY_MAX_BITS 40
+#define LATENCY_MAX_VALUE ((UINT64_C(1) << LATENCY_MAX_BITS) - 1)
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) << LATENCY_SUB_BUCKET_BITS)
+
+class Latency_histogram {
+  public:
+    void record(uint64_t value);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? lowest : 0; }
+    uint64_t max() const { return highest; }
+    double mean() const;
+    double deviation() const;
+    uint64_t percentile(double percent) const;
+
+    void print_percentiles(const char *name, double unit) const;
+    int write(const char *path, double unit) const;
+
+  private:
+    static uint32_t index_of(uint64_t value);
+    static uint64_t highest_equivalent(uint32_t index);
+
+    uint64_t counts[LATENCY_BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t lowest = UINT64_MAX;
+    uint64_t highest = 0;
+    double sum = 0;
+    double sum_squares = 0;
+};
+
+/**
+ * Monotonic wall-clock time in nanoseconds
+ */
+inline uint64_t monotonic_ns() {
+  return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Wall-clock nanoseconds spent in each stage of a Trace_time. Each bracket of a stage
+ * adds to elapsed and, if a histogram is attached to the stage, is recorded into it.
+ */
+struct Stage_clock {
+  uint64_t started[TRACE_STAGES] = {};
+  uint64_t elapsed[TRACE_STAGES] = {};
+  Latency_histogram *histograms[TRACE_STAGES] = {};
+};
 
 struct Trace_time {
   uint32_t stack = 0;
@@ -24,10 +150,47 @@ struct Trace_time {
   uint32_t compute_z_poly_time = 0;
   uint32_t compute_error_values_time = 0;
   uint32_t correct_errors_time = 0;
+  //--------- optional hardware counters ---------//
+  Perf_counters *counters = nullptr;
+  //--------- optional wall-clock stage latencies ---------//
+  Stage_clock *stage_clock = nullptr;
 };
 
+/**
+ * Opens a stage of a Trace_time: reads its counters and stage clock, if any, then the clock.
+ */
+inline clock_t trace_start(Trace_time* trace_time, Trace_stage stage) {
+  if (trace_time->counters) {
+    trace_time->counters->begin(stage);
+  }
+  if (trace_time->stage_clock) {
+    trace_time->stage_clock->started[stage] = monotonic_ns();
+  }
+  return clock();
+}
+
+/**
+ * Closes a stage of a Trace_time: reads the clock, then its stage clock and counters, if any.
+ */
+inline clock_t trace_stop(Trace_time* trace_time, Trace_stage stage) {
+  clock_t now = clock();
+  if (trace_time->stage_clock) {
+    Stage_clock *stage_clock = trace_time->stage_clock;
+    uint64_t elapsed = monotonic_ns() - stage_clock->started[stage];
+    stage_clock->elapsed[stage] += elapsed;
+    if (stage_clock->histograms[stage]) {
+      stage_clock->histograms[stage]->record(elapsed);
+    }
+  }
+  if (trace_time->counters) {
+    trace_time->counters->end(stage);
+  }
+  return now;
+}
+
 void time_analysis(Trace_time* trace_time);
 void rs_decode_detail_analysis(const Trace_time* trace_time);
+void perf_analysis(const Trace_time* trace_time);
 
 
 #endif
\ No newline at end of file
@@ -3,31 +3,53 @@
  * @brief Constant time implementation of Reed-Muller code RM(1,7)
  */
 
+#include "cpu_features.h"
 #include "reed_muller.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include <stdint.h>
 #include <string.h>
+#include <immintrin.h>
 
-// number of repeated code words
-#define MULTIPLICITY                   CEIL_DIVIDE(PARAM_N2, 128)
+// number of bits of the vertical counters summing the P::multiplicity repeated code words
+#define COUNTER_BITS(multiplicity)     ((multiplicity) < 2 ? 1 : (multiplicity) < 4 ? 2 : (multiplicity) < 8 ? 3 : 4)
+
+// number of RM(1,7) blocks decoded together by the AVX2 path
+#define BLOCKS                         2
 
 // codeword is 128 bits, seen multiple ways
 typedef union {
     uint8_t u8[16];
+    uint16_t u16[8];
     uint32_t u32[4];
+    uint64_t u64[2];
 } codeword;
 
 // Expanded codeword has a short for every bit, for internal calculations
 typedef int16_t expandedCodeword[128];
 
+// BLOCKS expanded codewords interleaved by rows of 16 entries, for the AVX2 path:
+// entry 16 * row + i of block b is [row][b][i]
+typedef int16_t expandedCodewords[8][BLOCKS][16] __attribute__((aligned(32)));
+
 // copy bit 0 into all bits of a 32 bit value
 #define BIT0MASK(x) (int32_t)(-((x) & 1))
 
 
 void encode(codeword *word, int32_t message);
+HQC_TARGET_AVX2 static inline __m256i encode_avx2(uint8_t message0, uint8_t message1);
 void hadamard(expandedCodeword *src, expandedCodeword *dst);
-void expand_and_sum(expandedCodeword *dest, codeword src[]);
+HQC_TARGET_AVX2 void hadamard_avx2(expandedCodewords *src, expandedCodewords *dst);
+template <class P> void count_copies(codeword *counters, const codeword src[]);
+template <class P> void expand_and_sum(expandedCodeword *dest, codeword src[]);
+template <class P> HQC_TARGET_AVX2 void expand_and_sum_avx2(expandedCodewords *dest, codeword src[]);
 int32_t find_peaks(expandedCodeword *transform);
+HQC_TARGET_AVX2 void find_peaks_avx2(uint8_t *message, expandedCodewords *transform);
+HQC_TARGET_AVX2 static inline void bitmap128(uint64_t *bitmap, const __m256i *masks);
+template <class P, bool ACCUMULATE> static void reed_muller_encode_portable(uint64_t *cdw, const uint64_t *msg);
+template <class P, bool ACCUMULATE> HQC_TARGET_AVX2 static void reed_muller_encode_avx2(uint64_t *cdw, const uint64_t *msg);
+template <class P> static void reed_muller_decode_portable(uint64_t *msg, const uint64_t *cdw);
+template <class P> HQC_TARGET_AVX2 static void reed_muller_decode_avx2(uint64_t *msg, const uint64_t *cdw);
 
 
 
@@ -72,6 +94,42 @@ void encode(codeword *word, int32_t message) {
 
 
 
+/**
+ * @brief Encode two bytes into two codewords using RM(1,7) with AVX2
+ *
+ * Same codewords as encode(): each 128-bit lane of the result is the XOR of the rows
+ * of the encoding matrix selected by the bits of its byte, computed for both lanes at once with byte masks.
+ *
+ * @returns the codeword of message0 in the low 128-bit lane and the codeword of message1 in the high one
+ * @param[in] message0 A message
+ * @param[in] message1 A message
+ */
+HQC_TARGET_AVX2 static inline __m256i encode_avx2(uint8_t message0, uint8_t message1) {
+    // the rows of the encoding matrix, in both 128-bit lanes
+    const __m256i rows[8] = {
+        _mm256_set1_epi64x((int64_t) 0xaaaaaaaaaaaaaaaaULL),
+        _mm256_set1_epi64x((int64_t) 0xccccccccccccccccULL),
+        _mm256_set1_epi64x((int64_t) 0xf0f0f0f0f0f0f0f0ULL),
+        _mm256_set1_epi64x((int64_t) 0xff00ff00ff00ff00ULL),
+        _mm256_set1_epi64x((int64_t) 0xffff0000ffff0000ULL),
+        _mm256_set1_epi64x((int64_t) 0xffffffff00000000ULL),
+        _mm256_setr_epi64x(0, -1, 0, -1),
+        _mm256_set1_epi64x(-1)
+    };
+    // message0 in every byte of the low lane, message1 in every byte of the high lane
+    const __m256i message = _mm256_setr_epi64x((int64_t) (0x0101010101010101ULL * message0), (int64_t) (0x0101010101010101ULL * message0),
+                                               (int64_t) (0x0101010101010101ULL * message1), (int64_t) (0x0101010101010101ULL * message1));
+    __m256i word = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < 8; i++) {
+        const __m256i bit = _mm256_set1_epi8((char) (1 << i));
+        word = _mm256_xor_si256(word, _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(message, bit), bit), rows[i]));
+    }
+    return word;
+}
+
+
+
 /**
  * @brief Hadamard transform
  *
@@ -101,6 +159,70 @@ void hadamard(expandedCodeword *src, expandedCodeword *dst) {
 
 
 
+/**
+ * @brief Hadamard transform with AVX2
+ *
+ * Same transform as hadamard(), applied to the BLOCKS codewords of src whose butterflies are issued together.
+ * The entries stay in registers during the 7 passes.
+ * hadd and hsub work within 128-bit lanes, so the middle 64-bit blocks of each result are swapped back.
+ *
+ * @param[in] src Structure that contain the expanded codewords
+ * @param[out] dst Structure that contain the expanded codewords
+ */
+HQC_TARGET_AVX2 void hadamard_avx2(expandedCodewords *src, expandedCodewords *dst) {
+    __m256i p1[8][BLOCKS], p2[8][BLOCKS];
+
+    for (size_t part = 0; part < 8; part++) {
+        for (size_t block = 0; block < BLOCKS; block++) {
+            p1[part][block] = _mm256_load_si256((const __m256i *) (*src)[part][block]);
+        }
+    }
+
+    for (size_t pass = 0; pass < 7; pass++) {
+        for (size_t part = 0; part < 4; part++) {
+            for (size_t block = 0; block < BLOCKS; block++) {
+                p2[part][block] = _mm256_permute4x64_epi64(_mm256_hadd_epi16(p1[2 * part][block], p1[2 * part + 1][block]), 0xd8);
+                p2[part + 4][block] = _mm256_permute4x64_epi64(_mm256_hsub_epi16(p1[2 * part][block], p1[2 * part + 1][block]), 0xd8);
+            }
+        }
+        memcpy(p1, p2, sizeof(p1));
+    }
+
+    for (size_t part = 0; part < 8; part++) {
+        for (size_t block = 0; block < BLOCKS; block++) {
+            _mm256_store_si256((__m256i *) (*dst)[part][block], p1[part][block]);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Bitsliced sum of the P::multiplicity copies of a codeword
+ *
+ * Bit k of the number of copies having a given bit set is stored at the same position in counters[k].
+ * Each copy goes through a ripple-carry adder on 64-bit words.
+ *
+ * @param[out] counters Array of COUNTER_BITS(P::multiplicity) codewords receiving the vertical counters
+ * @param[in] src Array of P::multiplicity codewords
+ */
+template <class P>
+void count_copies(codeword *counters, const codeword src[]) {
+    memset(counters, 0, COUNTER_BITS(P::multiplicity) * sizeof(codeword));
+    for (size_t copy = 0; copy < P::multiplicity; copy++) {
+        for (int32_t word = 0; word < 2; word++) {
+            uint64_t carry = src[copy].u64[word];
+            for (int32_t k = 0; k < COUNTER_BITS(P::multiplicity); k++) {
+                uint64_t next_carry = counters[k].u64[word] & carry;
+                counters[k].u64[word] ^= carry;
+                carry = next_carry;
+            }
+        }
+    }
+}
+
+
+
 /**
  * @brief Add multiple codewords into expanded codeword
  *
@@ -110,23 +232,60 @@ void hadamard(expandedCodeword *src, expandedCodeword *dst) {
  * The resulting hadamard transform has:
  * all values are halved
  * the first entry is 64 too high
+ * The copies are summed by count_copies() and the counters are unpacked once.
  *
  * @param[out] dest Structure that contain the expanded codeword
  * @param[in] src Structure that contain the codeword
  */
+template <class P>
 void expand_and_sum(expandedCodeword *dest, codeword src[]) {
-    // start with the first copy
+    codeword counters[COUNTER_BITS(P::multiplicity)];
+
+    count_copies<P>(counters, src);
     for (int32_t part = 0; part < 4; part++) {
         for (int32_t bit = 0; bit < 32; bit++) {
-            (*dest)[part * 32 + bit] = src[0].u32[part] >> bit & 1;
+            int16_t sum = 0;
+            for (int32_t k = 0; k < COUNTER_BITS(P::multiplicity); k++) {
+                sum |= (counters[k].u32[part] >> bit & 1) << k;
+            }
+            (*dest)[part * 32 + bit] = sum;
         }
     }
-    // sum the rest of the copies
-    for (int32_t copy = 1; copy < MULTIPLICITY; copy++) {
-        for (int32_t part = 0; part < 4; part++) {
-            for (int32_t bit = 0; bit < 32; bit++) {
-                (*dest)[part * 32 + bit] += src[copy].u32[part] >> bit & 1;
+}
+
+
+
+/**
+ * @brief Add multiple codewords into expanded codewords with AVX2
+ *
+ * Same sums as expand_and_sum(), for BLOCKS consecutive blocks.
+ * The copies are summed by count_copies(), then each 16-bit part of each counter is broadcast
+ * and compared to the lane masks, so that the counters are unpacked with one subtraction per counter bit.
+ *
+ * @param[out] dest Structure that contain the BLOCKS expanded codewords
+ * @param[in] src Array of BLOCKS * P::multiplicity codewords
+ */
+template <class P>
+HQC_TARGET_AVX2 void expand_and_sum_avx2(expandedCodewords *dest, codeword src[]) {
+    // lane i of bits selects bit i of a 16-bit part of a codeword
+    const __m256i bits = _mm256_setr_epi16(0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+                                           0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, (int16_t) 0x8000);
+
+    codeword counters[BLOCKS][COUNTER_BITS(P::multiplicity)];
+
+    for (size_t block = 0; block < BLOCKS; block++) {
+        count_copies<P>(counters[block], &src[block * P::multiplicity]);
+    }
+
+    for (size_t part = 0; part < 8; part++) {
+        for (size_t block = 0; block < BLOCKS; block++) {
+            // sum = sum_k 2^k * bit k, a set bit gives a -1 mask which is subtracted
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t k = COUNTER_BITS(P::multiplicity); k-- > 0;) {
+                __m256i word = _mm256_set1_epi16((int16_t) counters[block][k].u16[part]);
+                sum = _mm256_sub_epi16(_mm256_add_epi16(sum, sum), _mm256_cmpeq_epi16(_mm256_and_si256(word, bits), bits));
             }
+            _mm256_store_si256((__m256i *) (*dest)[part][block], sum);
         }
     }
 }
@@ -163,25 +322,157 @@ int32_t find_peaks(expandedCodeword *transform) {
 
 
 
+/**
+ * @brief Packs 128 16-bit comparison masks into a 128-bit bitmap
+ *
+ * @param[out] bitmap Array of size 2 receiving bit i set if entry i of masks is 0xffff
+ * @param[in] masks Array of 8 registers of 16-bit masks
+ */
+HQC_TARGET_AVX2 static inline void bitmap128(uint64_t *bitmap, const __m256i *masks) {
+    uint64_t bits[4];
+
+    for (size_t i = 0; i < 4; i++) {
+        // packs interleaves the 128-bit lanes of its inputs, permute4x64 restores the order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(masks[2 * i], masks[2 * i + 1]), 0xd8);
+        bits[i] = (uint32_t) _mm256_movemask_epi8(packed);
+    }
+
+    bitmap[0] = bits[0] | bits[1] << 32;
+    bitmap[1] = bits[2] | bits[3] << 32;
+}
+
+
+
+/**
+ * @brief Finding the location of the highest value with AVX2
+ *
+ * Same result as find_peaks() for each of the BLOCKS codewords: the position of the first entry
+ * of highest absolute value, plus 128 if this entry is positive. The maximum is reduced in registers,
+ * the positions of the entries equal to it and of the positive entries are packed into 128-bit bitmaps,
+ * and the first set bit is found with a bit scan. No branch and no memory access depend on the transform.
+ *
+ * @param[out] message Array of size BLOCKS receiving the decoded bytes
+ * @param[in] transform Structure that contain the expanded codewords
+ */
+HQC_TARGET_AVX2 void find_peaks_avx2(uint8_t *message, expandedCodewords *transform) {
+    __m256i rows[BLOCKS][8], abs_rows[BLOCKS][8], max_abs[BLOCKS];
+    __m128i max_abs128;
+    uint64_t peaks[2], positives[2];
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (size_t block = 0; block < BLOCKS; block++) {
+        for (size_t i = 0; i < 8; i++) {
+            rows[block][i] = _mm256_load_si256((const __m256i *) (*transform)[i][block]);
+            abs_rows[block][i] = _mm256_abs_epi16(rows[block][i]);
+        }
+        max_abs[block] = abs_rows[block][0];
+    }
+
+    for (size_t i = 1; i < 8; i++) {
+        for (size_t block = 0; block < BLOCKS; block++) {
+            max_abs[block] = _mm256_max_epi16(max_abs[block], abs_rows[block][i]);
+        }
+    }
+
+    for (size_t block = 0; block < BLOCKS; block++) {
+        // absolute values are nonnegative, so the maximum is the complement of the unsigned minimum of the complements
+        max_abs128 = _mm_max_epi16(_mm256_castsi256_si128(max_abs[block]), _mm256_extracti128_si256(max_abs[block], 1));
+        max_abs128 = _mm_minpos_epu16(_mm_xor_si128(max_abs128, _mm_set1_epi32(-1)));
+        max_abs[block] = _mm256_set1_epi16((int16_t) ~_mm_extract_epi16(max_abs128, 0));
+
+        for (size_t i = 0; i < 8; i++) {
+            abs_rows[block][i] = _mm256_cmpeq_epi16(abs_rows[block][i], max_abs[block]);
+            rows[block][i] = _mm256_cmpgt_epi16(rows[block][i], zero);
+        }
+        bitmap128(peaks, abs_rows[block]);
+        bitmap128(positives, rows[block]);
+
+        // the maximum is reached, so one of the two words is nonzero
+        uint64_t in_high = -(uint64_t) (peaks[0] == 0);
+        uint64_t peak_bits = (peaks[0] & ~in_high) | (peaks[1] & in_high);
+        uint64_t positive_bits = (positives[0] & ~in_high) | (positives[1] & in_high);
+        int32_t peak_pos = __builtin_ctzll(peak_bits);
+
+        // set bit 7
+        peak_pos |= (int32_t) ((positive_bits >> peak_pos) & 1) << 7;
+        peak_pos += (int32_t) (in_high & 64);
+        message[block] = (uint8_t) peak_pos;
+    }
+}
+
+
+
 /**
  * @brief Encodes the received word
  *
- * The message consists of N1 bytes each byte is encoded into PARAM_N2 bits,
- * or MULTIPLICITY repeats of 128 bits
+ * The message consists of N1 bytes each byte is encoded into P::n2 bits,
+ * or P::multiplicity repeats of 128 bits. <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same codeword.
  *
- * @param[out] cdw Array of size VEC_N1N2_SIZE_64 receiving the encoded message
- * @param[in] msg Array of size VEC_N1_SIZE_64 storing the message
+ * @param[out] cdw Array of size P::vec_n1n2_size_64 receiving the encoded message
+ * @param[in] msg Array of size P::vec_n1_size_64 storing the message
  */
+template <class P>
 void reed_muller_encode(uint64_t *cdw, const uint64_t *msg) {
+    if (cpu_supports_avx2()) {
+        reed_muller_encode_avx2<P, false>(cdw, msg);
+        return;
+    }
+
+    reed_muller_encode_portable<P, false>(cdw, msg);
+}
+
+
+
+/**
+ * @brief Adds the encoding of the message to the received word
+ *
+ * Same codeword as reed_muller_encode(), XORed into cdw instead of overwriting it,
+ * so that the encryption can add m.G directly to s.r2 + e without an intermediate codeword.
+ *
+ * @param[in,out] cdw Array of size P::vec_n1n2_size_64 to which the encoded message is added
+ * @param[in] msg Array of size P::vec_n1_size_64 storing the message
+ */
+template <class P>
+void reed_muller_encode_xor(uint64_t *cdw, const uint64_t *msg) {
+    if (cpu_supports_avx2()) {
+        reed_muller_encode_avx2<P, true>(cdw, msg);
+        return;
+    }
+
+    reed_muller_encode_portable<P, true>(cdw, msg);
+}
+
+
+
+/**
+ * @brief Encodes the received word
+ *
+ * @tparam ACCUMULATE If true, the encoded message is XORed into cdw instead of overwriting it
+ * @param[out] cdw Array of size P::vec_n1n2_size_64 receiving the encoded message
+ * @param[in] msg Array of size P::vec_n1_size_64 storing the message
+ */
+template <class P, bool ACCUMULATE>
+static void reed_muller_encode_portable(uint64_t *cdw, const uint64_t *msg) {
     uint8_t *message_array = (uint8_t *) msg;
     codeword *codeArray = (codeword *) cdw;
-    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i++) {
-        // fill entries i * MULTIPLICITY to (i+1) * MULTIPLICITY
-        int32_t pos = i * MULTIPLICITY;
+    for (size_t i = 0; i < P::vec_n1_size_bytes; i++) {
+        // fill entries i * P::multiplicity to (i+1) * P::multiplicity
+        int32_t pos = i * P::multiplicity;
+        if (ACCUMULATE) {
+            codeword word;
+            encode(&word, message_array[i]);
+            for (size_t copy = 0; copy < P::multiplicity; copy++) {
+                codeArray[pos + copy].u64[0] ^= word.u64[0];
+                codeArray[pos + copy].u64[1] ^= word.u64[1];
+            }
+            continue;
+        }
         // encode first word
         encode(&codeArray[pos], message_array[i]);
         // copy to other identical codewords
-        for (size_t copy = 1; copy < MULTIPLICITY; copy++) {
+        for (size_t copy = 1; copy < P::multiplicity; copy++) {
             memcpy(&codeArray[pos + copy], &codeArray[pos], sizeof(codeword));
         }
     }
@@ -190,28 +481,126 @@ void reed_muller_encode(uint64_t *cdw, const uint64_t *msg) {
 
 
 
+/**
+ * @brief Encodes the received word with AVX2
+ *
+ * Bytes are encoded two at a time by encode_avx2(), codewords A and B in the two lanes of a register,
+ * and the 2 * P::multiplicity copies are written with P::multiplicity 256-bit stores
+ * of [A, A], [A, B] or [B, B] (for P::multiplicity = 3: [A, A], [A, B], [B, B]).
+ * P::vec_n1_size_bytes is even since it is a multiple of BLOCKS.
+ *
+ * @tparam ACCUMULATE If true, the encoded message is XORed into cdw instead of overwriting it
+ * @param[out] cdw Array of size P::vec_n1n2_size_64 receiving the encoded message
+ * @param[in] msg Array of size P::vec_n1_size_64 storing the message
+ */
+template <class P, bool ACCUMULATE>
+HQC_TARGET_AVX2 static void reed_muller_encode_avx2(uint64_t *cdw, const uint64_t *msg) {
+    static_assert(P::vec_n1_size_bytes % BLOCKS == 0, "the message must be made of whole groups of BLOCKS bytes");
+
+    const uint8_t *message_array = (const uint8_t *) msg;
+    __m256i *codeArray = (__m256i *) cdw;
+    for (size_t i = 0; i < P::vec_n1_size_bytes; i += 2) {
+        __m256i words = encode_avx2(message_array[i], message_array[i + 1]);
+        __m256i words_aa = _mm256_permute2x128_si256(words, words, 0x00);
+        __m256i words_bb = _mm256_permute2x128_si256(words, words, 0x11);
+        // fill entries i * P::multiplicity to (i+2) * P::multiplicity
+        for (size_t k = 0; k < P::multiplicity; k++) {
+            __m256i copies = (2 * k + 1 < P::multiplicity) ? words_aa : (2 * k >= P::multiplicity) ? words_bb : words;
+            if (ACCUMULATE) {
+                copies = _mm256_xor_si256(copies, _mm256_loadu_si256(&codeArray[i / 2 * P::multiplicity + k]));
+            }
+            _mm256_storeu_si256(&codeArray[i / 2 * P::multiplicity + k], copies);
+        }
+    }
+}
+
+
+
 /**
  * @brief Decodes the received word
  *
  * Decoding uses fast hadamard transform, for a more complete picture on Reed-Muller decoding, see MacWilliams, Florence Jessie, and Neil James Alexander Sloane.
- * The theory of error-correcting codes codes @cite macwilliams1977theory
+ * The theory of error-correcting codes codes @cite macwilliams1977theory <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same message.
  *
- * @param[out] msg Array of size VEC_N1_SIZE_64 receiving the decoded message
- * @param[in] cdw Array of size VEC_N1N2_SIZE_64 storing the received word
+ * @param[out] msg Array of size P::vec_n1_size_64 receiving the decoded message
+ * @param[in] cdw Array of size P::vec_n1n2_size_64 storing the received word
  */
+template <class P>
 void reed_muller_decode(uint64_t *msg, const uint64_t *cdw) {
+    if (cpu_supports_avx2()) {
+        reed_muller_decode_avx2<P>(msg, cdw);
+        return;
+    }
+
+    reed_muller_decode_portable<P>(msg, cdw);
+}
+
+
+
+/**
+ * @brief Decodes the received word
+ *
+ * @param[out] msg Array of size P::vec_n1_size_64 receiving the decoded message
+ * @param[in] cdw Array of size P::vec_n1n2_size_64 storing the received word
+ */
+template <class P>
+static void reed_muller_decode_portable(uint64_t *msg, const uint64_t *cdw) {
     uint8_t *message_array = (uint8_t *) msg;
     codeword *codeArray = (codeword *) cdw;
     expandedCodeword expanded;
-    for (size_t i = 0; i < VEC_N1_SIZE_BYTES; i++) {
+    for (size_t i = 0; i < P::vec_n1_size_bytes; i++) {
         // collect the codewords
-        expand_and_sum(&expanded, &codeArray[i * MULTIPLICITY]);
+        expand_and_sum<P>(&expanded, &codeArray[i * P::multiplicity]);
         // apply hadamard transform
         expandedCodeword transform;
         hadamard(&expanded, &transform);
         // fix the first entry to get the half Hadamard transform
-        transform[0] -= 64 * MULTIPLICITY;
+        transform[0] -= 64 * P::multiplicity;
         // finish the decoding
         message_array[i] = find_peaks(&transform);
     }
 }
+
+
+
+/**
+ * @brief Decodes the received word with AVX2
+ *
+ * Same steps as reed_muller_decode_portable(), on BLOCKS consecutive blocks at a time
+ * whose rows are interleaved so that their independent butterflies and peak searches are issued side by side.
+ *
+ * @param[out] msg Array of size P::vec_n1_size_64 receiving the decoded message
+ * @param[in] cdw Array of size P::vec_n1n2_size_64 storing the received word
+ */
+template <class P>
+HQC_TARGET_AVX2 static void reed_muller_decode_avx2(uint64_t *msg, const uint64_t *cdw) {
+    static_assert(P::vec_n1_size_bytes % BLOCKS == 0, "the message must be made of whole groups of BLOCKS bytes");
+
+    uint8_t *message_array = (uint8_t *) msg;
+    codeword *codeArray = (codeword *) cdw;
+    expandedCodewords expanded;
+    for (size_t i = 0; i < P::vec_n1_size_bytes; i += BLOCKS) {
+        // collect the codewords of BLOCKS consecutive blocks
+        expand_and_sum_avx2<P>(&expanded, &codeArray[i * P::multiplicity]);
+        // apply hadamard transform
+        expandedCodewords transform;
+        hadamard_avx2(&expanded, &transform);
+        // fix the first entries to get the half Hadamard transforms
+        for (size_t block = 0; block < BLOCKS; block++) {
+            transform[0][block][0] -= 64 * P::multiplicity;
+        }
+        // finish the decoding
+        find_peaks_avx2(&message_array[i], &transform);
+    }
+}
+
+
+
+#define INSTANTIATE_REED_MULLER(P) \
+    template void reed_muller_encode<P>(uint64_t *, const uint64_t *); \
+    template void reed_muller_encode_xor<P>(uint64_t *, const uint64_t *); \
+    template void reed_muller_decode<P>(uint64_t *, const uint64_t *);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_REED_MULLER)
@@ -6,11 +6,13 @@
  * @brief Header file of reed_muller.cpp
  */
 
+#include "parameter_set.h"
 #include "parameters.h"
 #include <stddef.h>
 #include <stdint.h>
 
-void reed_muller_encode(uint64_t* cdw, const uint64_t* msg);
-void reed_muller_decode(uint64_t* msg, const uint64_t* cdw);
+template <class P> void reed_muller_encode(uint64_t* cdw, const uint64_t* msg);
+template <class P> void reed_muller_encode_xor(uint64_t* cdw, const uint64_t* msg);
+template <class P> void reed_muller_decode(uint64_t* msg, const uint64_t* cdw);
 
 #endif
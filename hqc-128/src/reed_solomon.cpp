@@ -3,9 +3,11 @@
  * @brief Constant time implementation of Reed-Solomon codes
  */
 
+#include "cpu_features.h"
 #include "fft.h"
 #include "gf.h"
 #include "reed_solomon.h"
+#include "parameter_set.h"
 #include "parameters.h"
 #include <stdint.h>
 #include <string.h>
@@ -16,64 +18,59 @@
 #include <stdio.h>
 #endif
 
-static uint16_t mod(uint16_t i, uint16_t modulus);
-static void compute_syndromes(uint16_t *syndromes, uint8_t *cdw);
-static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes);
-static void compute_roots(uint8_t *error, uint16_t *sigma);
-static void compute_z_poly(uint16_t *z, const uint16_t *sigma, const uint16_t degree, const uint16_t *syndromes);
-static void compute_error_values(uint16_t *error_values, const uint16_t *z, const uint8_t *error);
-static void correct_errors(uint8_t *cdw, const uint16_t *error_values);
+template <class Code> static void reed_solomon_encode_portable(uint64_t *cdw, const uint64_t *msg);
+template <class Code> HQC_TARGET_AVX2 static void reed_solomon_encode_avx2(uint64_t *cdw, const uint64_t *msg);
+template <class Code> static void compute_syndromes(uint16_t *syndromes, uint8_t *cdw);
+template <class Code> static void compute_syndromes_portable(uint16_t *syndromes, uint8_t *cdw);
+template <class Code> HQC_TARGET_AVX2 static void compute_syndromes_avx2(uint16_t *syndromes, uint8_t *cdw);
+template <class P> static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes);
+template <class P> static uint16_t compute_elp_portable(uint16_t *sigma, const uint16_t *syndromes);
+template <class P> HQC_TARGET_AVX2 static uint16_t compute_elp_avx2(uint16_t *sigma, const uint16_t *syndromes);
+template <class P> static void compute_roots(uint8_t *error, uint16_t *sigma);
+template <class P> static void compute_z_poly(uint16_t *z, const uint16_t *sigma, const uint16_t degree, const uint16_t *syndromes);
+template <class P> static void compute_error_values(uint16_t *error_values, const uint16_t *z, const uint8_t *error);
+template <class P> static void compute_error_values_portable(uint16_t *error_values, const uint16_t *z, const uint8_t *error);
+template <class P> HQC_TARGET_AVX2 static void compute_error_values_avx2(uint16_t *error_values, const uint16_t *z, const uint8_t *error);
+template <class P> static void correct_errors(uint8_t *cdw, const uint16_t *error_values);
 
 
 /**
- * Returns i modulo the given modulus.
- * i must be less than 2*modulus.
- * Therefore, the return value is either i or i-modulus.
- * @returns i mod (modulus)
- * @param[in] i The integer whose modulo is taken
- * @param[in] modulus The modulus
+ * @brief Computes the generator polynomial of the primitive Reed-Solomon code with given parameters.
+ *
+ * The polynomial is evaluated at compile time by P::rs_code::generate_poly(),
+ * this function only copies it out.
+ *
+ * @param[out] poly Array of size (2*P::delta + 1) receiving the coefficients of the generator polynomial
  */
-static uint16_t mod(uint16_t i, uint16_t modulus) {
-    uint16_t tmp = i - modulus;
-
-    // mask = 0xffff if(i < PARAM_GF_MUL_ORDER)
-    int16_t mask = -(tmp >> 15);
+template <class P>
+void compute_generator_poly(uint16_t* poly) {
+    static constexpr std::array<uint16_t, P::g> rs_poly = P::rs_code::generate_poly();
 
-    return tmp + (mask & modulus);
+    memcpy(poly, rs_poly.data(), sizeof(rs_poly));
 }
 
 
 
 /**
- * @brief Computes the generator polynomial of the primitive Reed-Solomon code with given parameters.
+ * @brief Encodes a message message of PARAM_K bits to a Reed-Solomon codeword codeword of PARAM_N1 bytes
  *
- * Code length is 2^m-1. <br>
- * PARAM_DELTA is the targeted correction capacity of the code
- * and receives the real correction capacity (which is at least equal to the target). <br>
- * gf_exp and gf_log are arrays giving antilog and log of GF(2^m) elements.
+ * Following @cite lin1983error (Chapter 4 - Cyclic Codes),
+ * We perform a systematic encoding using a linear (PARAM_N1 - PARAM_K)-stage shift register
+ * with feedback connections based on the generator polynomial PARAM_RS_POLY of the Reed-Solomon code. <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same codeword.
  *
- * @param[out] poly Array of size (2*PARAM_DELTA + 1) receiving the coefficients of the generator polynomial
+ * @param[out] cdw Array of size P::vec_n1_size_64 receiving the encoded message
+ * @param[in] msg Array of size P::vec_k_size_64 storing the message
  */
-void compute_generator_poly(uint16_t* poly) {
-    poly[0] = 1;
-    int tmp_degree = 0;
-
-    for (uint16_t i = 1; i < (2 * PARAM_DELTA + 1); ++i) {
-
-        for(size_t j = tmp_degree; j; --j) {
-            poly[j] = gf_exp[mod(gf_log[poly[j]] + i, PARAM_GF_MUL_ORDER)] ^ poly[j - 1];
-        }
-
-        poly[0] = gf_exp[mod(gf_log[poly[0]] + i, PARAM_GF_MUL_ORDER)];
-        poly[++tmp_degree] = 1;
-
+template <class P>
+void reed_solomon_encode(uint64_t *cdw, const uint64_t *msg) {
+    if (cpu_supports_avx2()) {
+        reed_solomon_encode_avx2<typename P::rs_code>(cdw, msg);
+        return;
     }
 
-    printf("\n");
-    for (int i = 0; i < (PARAM_G); ++i) {
-        printf("%d, ", poly[i]);
-    }
-    printf("\n");
+    reed_solomon_encode_portable<typename P::rs_code>(cdw, msg);
 }
 
 
@@ -88,34 +85,102 @@ void compute_generator_poly(uint16_t* poly) {
  * @param[out] cdw Array of size VEC_N1_SIZE_64 receiving the encoded message
  * @param[in] msg Array of size VEC_K_SIZE_64 storing the message
  */
-void reed_solomon_encode(uint64_t *cdw, const uint64_t *msg) {
+template <class Code>
+static void reed_solomon_encode_portable(uint64_t *cdw, const uint64_t *msg) {
+    static constexpr std::array<uint16_t, Code::g> PARAM_RS_POLY = Code::generate_poly();
     size_t i, j, k;
     uint8_t gate_value = 0;
 
-    uint16_t tmp[PARAM_G] = {0};
-    uint16_t PARAM_RS_POLY [] = {RS_POLY_COEFS};
+    uint16_t tmp[Code::g] = {0};
 
-    uint8_t msg_bytes[PARAM_K] = {0};
-    uint8_t cdw_bytes[PARAM_N1] = {0};
+    uint8_t msg_bytes[Code::k] = {0};
+    uint8_t cdw_bytes[Code::n1] = {0};
 
-    memcpy(msg_bytes, msg, PARAM_K);
+    memcpy(msg_bytes, msg, Code::k);
 
-    for (i = 0; i < PARAM_K; ++i) {
-        gate_value = msg_bytes[PARAM_K - 1 - i] ^ cdw_bytes[PARAM_N1 - PARAM_K - 1];
+    for (i = 0; i < Code::k; ++i) {
+        gate_value = msg_bytes[Code::k - 1 - i] ^ cdw_bytes[Code::n1 - Code::k - 1];
 
-        for (j = 0; j < PARAM_G; ++j) {
+        for (j = 0; j < Code::g; ++j) {
             tmp[j] = gf_mul(gate_value, PARAM_RS_POLY[j]);
         }
 
-        for(k = PARAM_N1 - PARAM_K - 1; k; --k) {
+        for(k = Code::n1 - Code::k - 1; k; --k) {
             cdw_bytes[k] = cdw_bytes[k - 1] ^ tmp[k];
         }
 
         cdw_bytes[0] = tmp[0];
     }
 
-    memcpy(cdw_bytes + PARAM_N1 - PARAM_K, msg_bytes, PARAM_K);
-    memcpy(cdw, cdw_bytes, PARAM_N1);
+    memcpy(cdw_bytes + Code::n1 - Code::k, msg_bytes, Code::k);
+    memcpy(cdw, cdw_bytes, Code::n1);
+}
+
+
+
+/**
+ * @brief Encodes a message message of PARAM_K bits to a Reed-Solomon codeword codeword of PARAM_N1 bytes with AVX2
+ *
+ * Same shift register as reed_solomon_encode_portable(), kept in the 16-bit lanes of REGS 256-bit registers
+ * (stages 16 * r to 16 * r + 15 in register r). Each message byte costs REGS gf_mul_vect
+ * by the broadcast gate value and a one-lane shift across the registers.
+ *
+ * @param[out] cdw Array of size VEC_N1_SIZE_64 receiving the encoded message
+ * @param[in] msg Array of size VEC_K_SIZE_64 storing the message
+ */
+template <class Code>
+HQC_TARGET_AVX2 static void reed_solomon_encode_avx2(uint64_t *cdw, const uint64_t *msg) {
+    static constexpr size_t REGS = CEIL_DIVIDE(Code::n1 - Code::k, 16);
+    static constexpr size_t GATE = Code::n1 - Code::k - 1;
+    static_assert(REGS > 1, "the shift register must span at least two 256-bit registers");
+
+    // Generator polynomial padded with zeros to REGS registers, its leading coefficient is dropped if it does not fit
+    static constexpr std::array<uint16_t, 16 * REGS> PARAM_RS_POLY = [] {
+        constexpr std::array<uint16_t, Code::g> poly = Code::generate_poly();
+        std::array<uint16_t, 16 * REGS> padded = {};
+        for (size_t i = 0; i < Code::g && i < 16 * REGS; ++i) {
+            padded[i] = poly[i];
+        }
+        return padded;
+    }();
+
+    uint8_t msg_bytes[Code::k] = {0};
+    uint8_t cdw_bytes[32 * CEIL_DIVIDE(REGS, 2)] = {0};
+    uint16_t gate_value;
+
+    __m256i poly256[REGS];
+    __m256i cdw256[REGS];
+    __m256i gate256;
+
+    for (size_t r = 0; r < REGS; ++r) {
+        poly256[r] = _mm256_loadu_si256((const __m256i *) (PARAM_RS_POLY.data() + 16 * r));
+        cdw256[r] = _mm256_setzero_si256();
+    }
+
+    memcpy(msg_bytes, msg, Code::k);
+
+    for (size_t i = 0; i < Code::k; ++i) {
+        gate_value = msg_bytes[Code::k - 1 - i] ^ (uint16_t) _mm256_extract_epi16(cdw256[GATE / 16], GATE % 16);
+        gate256 = _mm256_set1_epi16(gate_value);
+
+        // cdw[k] = cdw[k - 1] ^ tmp[k], lanes above Code::n1 - Code::k - 1 are never read
+        for (size_t r = REGS - 1; r > 0; --r) {
+            cdw256[r] = _mm256_alignr_epi8(cdw256[r], _mm256_permute2x128_si256(cdw256[r - 1], cdw256[r], 0x21), 14);
+        }
+        cdw256[0] = _mm256_alignr_epi8(cdw256[0], _mm256_permute2x128_si256(cdw256[0], cdw256[0], 0x08), 14);
+        for (size_t r = 0; r < REGS; ++r) {
+            cdw256[r] = _mm256_xor_si256(cdw256[r], gf_mul_vect(gate256, poly256[r]));
+        }
+    }
+
+    // Pack the 16-bit lanes back to bytes, in order, two registers at a time
+    for (size_t r = 0; r < REGS; r += 2) {
+        __m256i next = (r + 1 < REGS) ? cdw256[r + 1] : _mm256_setzero_si256();
+        _mm256_storeu_si256((__m256i *) (cdw_bytes + 16 * r), _mm256_permute4x64_epi64(_mm256_packus_epi16(cdw256[r], next), 0xd8));
+    }
+
+    memcpy(cdw, cdw_bytes, Code::n1 - Code::k);
+    memcpy((uint8_t *) cdw + Code::n1 - Code::k, msg_bytes, Code::k);
 }
 
 
@@ -123,12 +188,36 @@ void reed_solomon_encode(uint64_t *cdw, const uint64_t *msg) {
 /**
  * @brief Computes 2 * PARAM_DELTA syndromes
  *
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same syndromes.
+ *
  * @param[out] syndromes Array of size 2 * PARAM_DELTA receiving the computed syndromes
  * @param[in] cdw Array of size PARAM_N1 storing the received vector
  */
-void compute_syndromes(uint16_t *syndromes, uint8_t *cdw) {	
-    for (size_t i = 0; i < 2 * PARAM_DELTA; ++i) {
-        for (size_t j = 1; j < PARAM_N1; ++j) {
+template <class Code>
+static void compute_syndromes(uint16_t *syndromes, uint8_t *cdw) {
+    if (cpu_supports_avx2()) {
+        compute_syndromes_avx2<Code>(syndromes, cdw);
+        return;
+    }
+
+    compute_syndromes_portable<Code>(syndromes, cdw);
+}
+
+
+
+/**
+ * @brief Computes 2 * PARAM_DELTA syndromes
+ *
+ * @param[out] syndromes Array of size 2 * PARAM_DELTA, initialized to zero, receiving the computed syndromes
+ * @param[in] cdw Array of size PARAM_N1 storing the received vector
+ */
+template <class Code>
+static void compute_syndromes_portable(uint16_t *syndromes, uint8_t *cdw) {
+    static constexpr auto alpha_ij_pow = Code::generate_alpha_ij_pow();
+
+    for (size_t i = 0; i < 2 * Code::delta; ++i) {
+        for (size_t j = 1; j < Code::n1; ++j) {
             syndromes[i] ^= gf_mul(cdw[j], alpha_ij_pow[i][j-1]);
         }
         syndromes[i] ^= cdw[0];
@@ -137,6 +226,115 @@ void compute_syndromes(uint16_t *syndromes, uint8_t *cdw) {
 
 
 
+/**
+ * @brief Computes 2 * PARAM_DELTA syndromes with AVX2
+ *
+ * The syndromes are the product of the syndrome matrix alpha_ij_pow by the received vector.
+ * For each column j, the products cdw[j] * c, 0 <= c < 16 and cdw[j] * (c << 4), 0 <= c < 16
+ * are built in two registers from the multiples cdw[j] * X^b, then looked up with PSHUFB
+ * at the public nibbles of column j. The 2 * PARAM_DELTA byte syndromes accumulate in REGS pairs of registers
+ * and no memory access depends on the received vector.
+ * GF2P8AFFINEQB could multiply by the constants of the matrix as 8x8 bit matrices, whatever the
+ * field polynomial, but it needs GFNI; the PSHUFB lookups only need AVX2.
+ *
+ * @param[out] syndromes Array of size 2 * PARAM_DELTA receiving the computed syndromes
+ * @param[in] cdw Array of size PARAM_N1 storing the received vector
+ */
+template <class Code>
+HQC_TARGET_AVX2 static void compute_syndromes_avx2(uint16_t *syndromes, uint8_t *cdw) {
+    static constexpr size_t REGS = CEIL_DIVIDE(2 * Code::delta, 32);
+    static_assert(Code::field::m == 8, "the syndromes must fit in the bytes of a 256-bit register");
+
+    // alpha_nibbles[j - 1][r][0] (resp. [1]) holds the low (resp. high) nibbles of rows 32 * r to 32 * r + 31
+    // of column j of alpha_ij_pow, padded with zeros
+    alignas(32) static constexpr std::array<std::array<std::array<std::array<uint8_t, 32>, 2>, REGS>, Code::n1 - 1> alpha_nibbles = [] {
+        constexpr auto alpha_ij_pow = Code::generate_alpha_ij_pow();
+        std::array<std::array<std::array<std::array<uint8_t, 32>, 2>, REGS>, Code::n1 - 1> nibbles = {};
+        for (size_t j = 0; j < Code::n1 - 1; ++j) {
+            for (size_t i = 0; i < 2 * Code::delta; ++i) {
+                nibbles[j][i / 32][0][i % 32] = alpha_ij_pow[i][j] & 0xf;
+                nibbles[j][i / 32][1][i % 32] = alpha_ij_pow[i][j] >> 4;
+            }
+        }
+        return nibbles;
+    }();
+
+    const __m256i nibbles = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                             0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i gf_poly = _mm256_set1_epi8((char) (Code::field::poly & 0xff));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i nibble_bits[4];
+    __m256i acc_lo[REGS];
+    __m256i acc_hi[REGS];
+    __m256i x, table_lo, table_hi, acc;
+    alignas(32) uint16_t syndromes_tmp[32 * REGS];
+
+    // nibble_bits[b] byte c is 0xff if bit b of c is set
+    for (size_t b = 0; b < 4; ++b) {
+        const __m256i bit = _mm256_set1_epi8((char) (1 << b));
+        nibble_bits[b] = _mm256_cmpeq_epi8(_mm256_and_si256(nibbles, bit), bit);
+    }
+
+    for (size_t r = 0; r < REGS; ++r) {
+        acc_lo[r] = zero;
+        acc_hi[r] = zero;
+    }
+
+    for (size_t j = 1; j < Code::n1; ++j) {
+        x = _mm256_set1_epi8((char) cdw[j]);
+
+        // table_lo[c] = cdw[j] * c, table_hi[c] = cdw[j] * (c << 4)
+        table_lo = zero;
+        for (size_t b = 0; b < 4; ++b) {
+            table_lo = _mm256_xor_si256(table_lo, _mm256_and_si256(nibble_bits[b], x));
+            x = _mm256_xor_si256(_mm256_add_epi8(x, x), _mm256_and_si256(_mm256_cmpgt_epi8(zero, x), gf_poly));
+        }
+
+        table_hi = zero;
+        for (size_t b = 0; b < 4; ++b) {
+            table_hi = _mm256_xor_si256(table_hi, _mm256_and_si256(nibble_bits[b], x));
+            x = _mm256_xor_si256(_mm256_add_epi8(x, x), _mm256_and_si256(_mm256_cmpgt_epi8(zero, x), gf_poly));
+        }
+
+        for (size_t r = 0; r < REGS; ++r) {
+            acc_lo[r] = _mm256_xor_si256(acc_lo[r], _mm256_shuffle_epi8(table_lo, _mm256_load_si256((const __m256i *) alpha_nibbles[j - 1][r][0].data())));
+            acc_hi[r] = _mm256_xor_si256(acc_hi[r], _mm256_shuffle_epi8(table_hi, _mm256_load_si256((const __m256i *) alpha_nibbles[j - 1][r][1].data())));
+        }
+    }
+
+    for (size_t r = 0; r < REGS; ++r) {
+        // The first column of the syndrome matrix is all ones
+        acc = _mm256_xor_si256(_mm256_xor_si256(acc_lo[r], acc_hi[r]), _mm256_set1_epi8((char) cdw[0]));
+
+        _mm256_store_si256((__m256i *) (syndromes_tmp + 32 * r), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(acc)));
+        _mm256_store_si256((__m256i *) (syndromes_tmp + 32 * r + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(acc, 1)));
+    }
+    memcpy(syndromes, syndromes_tmp, 2 * Code::delta * sizeof(uint16_t));
+}
+
+
+
+/**
+ * @brief Computes the error locator polynomial (ELP) sigma
+ *
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same result.
+ *
+ * @returns the degree of the ELP sigma
+ * @param[out] sigma Array of size 2^P::fft receiving the ELP
+ * @param[in] syndromes Array of size (at least) 2*P::delta storing the syndromes
+ */
+template <class P>
+static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
+    if (cpu_supports_avx2()) {
+        return compute_elp_avx2<P>(sigma, syndromes);
+    }
+
+    return compute_elp_portable<P>(sigma, syndromes);
+}
+
+
+
 /**
  * @brief Computes the error locator polynomial (ELP) sigma
  *
@@ -145,20 +343,21 @@ void compute_syndromes(uint16_t *syndromes, uint8_t *cdw) {
  * The array X_sigma_p represents the polynomial X^(mu-rho)*sigma_p(X). <br>
  * Instead of maintaining a list of sigmas, we update in place both sigma and X_sigma_p. <br>
  * sigma_copy serves as a temporary save of sigma in case X_sigma_p needs to be updated. <br>
- * We can properly correct only if the degree of sigma does not exceed PARAM_DELTA.
- * This means only the first PARAM_DELTA + 1 coefficients of sigma are of value
- * and we only need to save its first PARAM_DELTA - 1 coefficients.
+ * We can properly correct only if the degree of sigma does not exceed P::delta.
+ * This means only the first P::delta + 1 coefficients of sigma are of value
+ * and we only need to save its first P::delta - 1 coefficients.
  *
  * @returns the degree of the ELP sigma
- * @param[out] sigma Array of size (at least) PARAM_DELTA receiving the ELP
- * @param[in] syndromes Array of size (at least) 2*PARAM_DELTA storing the syndromes
+ * @param[out] sigma Array of size (at least) P::delta receiving the ELP
+ * @param[in] syndromes Array of size (at least) 2*P::delta storing the syndromes
  */
-static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
+template <class P>
+static uint16_t compute_elp_portable(uint16_t *sigma, const uint16_t *syndromes) {
     uint16_t deg_sigma = 0;
     uint16_t deg_sigma_p = 0;
     uint16_t deg_sigma_copy = 0;
-    uint16_t sigma_copy[PARAM_DELTA + 1] = {0};
-    uint16_t X_sigma_p[PARAM_DELTA + 1] = {0,1};
+    uint16_t sigma_copy[P::delta + 1] = {0};
+    uint16_t X_sigma_p[P::delta + 1] = {0,1};
     uint16_t pp = (uint16_t) -1; // 2*rho
     uint16_t d_p = 1;
     uint16_t d = syndromes[0];
@@ -171,14 +370,14 @@ static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
     uint16_t i;
 
     sigma[0] = 1;
-    for (mu = 0; (mu < (2 * PARAM_DELTA)); ++mu) {
+    for (mu = 0; (mu < (2 * P::delta)); ++mu) {
         // Save sigma in case we need it to update X_sigma_p
-        memcpy(sigma_copy, sigma, 2 * (PARAM_DELTA));
+        memcpy(sigma_copy, sigma, 2 * (P::delta));
         deg_sigma_copy = deg_sigma;
 
         dd = gf_mul(d, gf_inverse(d_p));
 
-        for (i = 1; (i <= mu + 1) && (i <= PARAM_DELTA); ++i) {
+        for (i = 1; (i <= mu + 1) && (i <= P::delta); ++i) {
             sigma[i] ^= gf_mul(dd, X_sigma_p[i]);
         }
 
@@ -195,20 +394,20 @@ static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
         mask12 = mask1 & mask2;
         deg_sigma ^= mask12 & (deg_X_sigma_p ^ deg_sigma);
 
-        if (mu == (2 * PARAM_DELTA - 1)) {
+        if (mu == (2 * P::delta - 1)) {
             break;
         }
 
         pp ^= mask12 & (mu ^ pp);
         d_p ^= mask12 & (d ^ d_p);
-        for (i = PARAM_DELTA; i ;--i) {
+        for (i = P::delta; i ;--i) {
             X_sigma_p[i] = (mask12 & sigma_copy[i - 1]) ^ (~mask12 & X_sigma_p[i - 1]);
         }
 
         deg_sigma_p ^= mask12 & (deg_sigma_copy ^ deg_sigma_p);
         d = syndromes[mu + 1];
 
-        for (i = 1; (i <= mu+1) && (i <= PARAM_DELTA); ++i) {
+        for (i = 1; (i <= mu+1) && (i <= P::delta); ++i) {
             d ^= gf_mul(sigma[i], syndromes[mu + 1 - i]);
         }
     }
@@ -218,19 +417,143 @@ static uint16_t compute_elp(uint16_t *sigma, const uint16_t *syndromes) {
 
 
 
+/**
+ * @brief Computes the error locator polynomial (ELP) sigma with AVX2
+ *
+ * Same algorithm as compute_elp_portable() where sigma, sigma_copy and X_sigma_p
+ * each hold their P::delta + 1 coefficients in REGS 256-bit registers. <br>
+ * Each iteration updates the whole polynomial sigma with REGS gf_mul_vect by the broadcast discrepancy dd.
+ * The next discrepancy is the dot product of sigma with a window of the syndromes in reverse order,
+ * loaded from a zero-padded copy so that the coefficients above mu + 1 vanish.
+ *
+ * @returns the degree of the ELP sigma
+ * @param[out] sigma Array of size 2^P::fft receiving the ELP
+ * @param[in] syndromes Array of size (at least) 2*P::delta storing the syndromes
+ */
+template <class P>
+HQC_TARGET_AVX2 static uint16_t compute_elp_avx2(uint16_t *sigma, const uint16_t *syndromes) {
+    static constexpr size_t REGS = CEIL_DIVIDE(P::delta + 1, 16);
+    static_assert(16 * REGS <= ((size_t) 1 << P::fft), "the registers of sigma must fit in the FFT input");
+
+    uint16_t deg_sigma = 0;
+    uint16_t deg_sigma_p = 0;
+    uint16_t deg_sigma_copy = 0;
+    uint16_t syndromes_rev[2 * P::delta + 16 * REGS] = {0};
+    uint16_t pp = (uint16_t) -1; // 2*rho
+    uint16_t d_p = 1;
+    uint16_t d = syndromes[0];
+
+    uint16_t mask1, mask2, mask12;
+    uint16_t deg_X, deg_X_sigma_p;
+    uint16_t dd;
+    uint16_t mu;
+
+    // Lanes of the last register holding coefficients of degree at most P::delta
+    const __m256i top_lanes = _mm256_cmpgt_epi16(_mm256_set1_epi16((int16_t) (P::delta + 1 - 16 * (REGS - 1))),
+                                                 _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    __m256i sigma256[REGS];
+    __m256i X_sigma_p256[REGS];
+    __m256i sigma_copy256[REGS];
+    __m256i shifted256[REGS];
+    __m256i mask256, dd256, prod256;
+    __m128i d128;
+
+    for (size_t r = 0; r < REGS; ++r) {
+        sigma256[r] = _mm256_setzero_si256();
+        X_sigma_p256[r] = _mm256_setzero_si256();
+    }
+    sigma256[0] = _mm256_setr_epi16(1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    X_sigma_p256[0] = _mm256_setr_epi16(0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    // syndromes_rev[2 * P::delta - 1 - i] = syndromes[i], followed by zeros
+    for (size_t i = 0; i < 2 * P::delta; ++i) {
+        syndromes_rev[2 * P::delta - 1 - i] = syndromes[i];
+    }
+
+    for (mu = 0; (mu < (2 * P::delta)); ++mu) {
+        // Save sigma in case we need it to update X_sigma_p
+        for (size_t r = 0; r < REGS; ++r) {
+            sigma_copy256[r] = sigma256[r];
+        }
+        deg_sigma_copy = deg_sigma;
+
+        // X_sigma_p has degree at most mu + 1 and no constant term
+        dd = gf_mul(d, gf_inverse(d_p));
+        dd256 = _mm256_set1_epi16(dd);
+        for (size_t r = 0; r < REGS; ++r) {
+            sigma256[r] = _mm256_xor_si256(sigma256[r], gf_mul_vect(dd256, X_sigma_p256[r]));
+        }
+
+        deg_X = mu - pp;
+        deg_X_sigma_p = deg_X + deg_sigma_p;
+
+        // mask1 = 0xffff if(d != 0) and 0 otherwise
+        mask1 = -((uint16_t) - d >> 15);
+
+        // mask2 = 0xffff if(deg_X_sigma_p > deg_sigma) and 0 otherwise
+        mask2 = -((uint16_t) (deg_sigma - deg_X_sigma_p) >> 15);
+
+        // mask12 = 0xffff if the deg_sigma increased and 0 otherwise
+        mask12 = mask1 & mask2;
+        deg_sigma ^= mask12 & (deg_X_sigma_p ^ deg_sigma);
+
+        if (mu == (2 * P::delta - 1)) {
+            break;
+        }
+
+        pp ^= mask12 & (mu ^ pp);
+        d_p ^= mask12 & (d ^ d_p);
+
+        // X_sigma_p = X * (mask12 ? sigma_copy : X_sigma_p), truncated to P::delta + 1 coefficients
+        mask256 = _mm256_set1_epi16(mask12);
+        for (size_t r = 0; r < REGS; ++r) {
+            shifted256[r] = _mm256_blendv_epi8(X_sigma_p256[r], sigma_copy256[r], mask256);
+        }
+        for (size_t r = REGS - 1; r > 0; --r) {
+            X_sigma_p256[r] = _mm256_alignr_epi8(shifted256[r], _mm256_permute2x128_si256(shifted256[r - 1], shifted256[r], 0x21), 14);
+        }
+        X_sigma_p256[0] = _mm256_alignr_epi8(shifted256[0], _mm256_permute2x128_si256(shifted256[0], shifted256[0], 0x08), 14);
+        if (16 * REGS > P::delta + 1) {
+            X_sigma_p256[REGS - 1] = _mm256_and_si256(X_sigma_p256[REGS - 1], top_lanes);
+        }
+
+        deg_sigma_p ^= mask12 & (deg_sigma_copy ^ deg_sigma_p);
+
+        // d = sum_{i=0}^{mu+1} sigma[i] * syndromes[mu + 1 - i], using sigma[0] = 1
+        prod256 = _mm256_setzero_si256();
+        for (size_t r = 0; r < REGS; ++r) {
+            prod256 = _mm256_xor_si256(prod256, gf_mul_vect(sigma256[r], _mm256_loadu_si256((const __m256i *) (syndromes_rev + 2 * P::delta - 2 - mu + 16 * r))));
+        }
+        d128 = _mm_xor_si128(_mm256_castsi256_si128(prod256), _mm256_extracti128_si256(prod256, 1));
+        d128 = _mm_xor_si128(d128, _mm_srli_si128(d128, 8));
+        d128 = _mm_xor_si128(d128, _mm_srli_si128(d128, 4));
+        d128 = _mm_xor_si128(d128, _mm_srli_si128(d128, 2));
+        d = (uint16_t) _mm_extract_epi16(d128, 0);
+    }
+
+    for (size_t r = 0; r < REGS; ++r) {
+        _mm256_storeu_si256((__m256i *) (sigma + 16 * r), sigma256[r]);
+    }
+
+    return deg_sigma;
+}
+
+
+
 /**
  * @brief Computes the error polynomial error from the error locator polynomial sigma
  *
  * See function fft for more details.
  *
  * @param[out] error Array of 2^PARAM_M elements receiving the error polynomial
- * @param[out] error_compact Array of PARAM_DELTA + PARAM_N1 elements receiving a compact representation of the vector error
- * @param[in] sigma Array of 2^PARAM_FFT elements storing the error locator polynomial
+ * @param[out] error_compact Array of P::delta + P::n1 elements receiving a compact representation of the vector error
+ * @param[in] sigma Array of 2^P::fft elements storing the error locator polynomial
  */
+template <class P>
 static void compute_roots(uint8_t *error, uint16_t *sigma) {
     uint16_t w[1 << PARAM_M] = {0};
 
-    fft(w, sigma, PARAM_DELTA + 1);
+    fft<P>(w, sigma, P::delta + 1);
     fft_retrieve_error_poly(error, w);
 }
 
@@ -241,25 +564,26 @@ static void compute_roots(uint8_t *error, uint16_t *sigma) {
  *
  * See @cite lin1983error (Chapter 6 - BCH Codes) for more details.
  *
- * @param[out] z Array of PARAM_DELTA + 1 elements receiving the polynomial z(x)
- * @param[in] sigma Array of 2^PARAM_FFT elements storing the error locator polynomial
+ * @param[out] z Array of P::delta + 1 elements receiving the polynomial z(x)
+ * @param[in] sigma Array of 2^P::fft elements storing the error locator polynomial
  * @param[in] degree Integer that is the degree of polynomial sigma
- * @param[in] syndromes Array of 2 * PARAM_DELTA storing the syndromes
+ * @param[in] syndromes Array of 2 * P::delta storing the syndromes
  */
+template <class P>
 static void compute_z_poly(uint16_t *z, const uint16_t *sigma, const uint16_t degree, const uint16_t *syndromes) {
     size_t i, j;
     uint16_t mask;
 
     z[0] = 1;
 
-    for (i = 1; i < PARAM_DELTA + 1; ++i) {
+    for (i = 1; i < P::delta + 1; ++i) {
         mask = -((uint16_t) (i - degree - 1) >> 15);
         z[i] = mask & sigma[i];
     }
 
     z[1] ^= syndromes[0];
 
-    for (i = 2; i <= PARAM_DELTA; ++i) {
+    for (i = 2; i <= P::delta; ++i) {
         mask = -((uint16_t) (i - degree - 1) >> 15);
         z[i] ^= mask & syndromes[i - 1];
 
@@ -274,16 +598,44 @@ static void compute_z_poly(uint16_t *z, const uint16_t *sigma, const uint16_t de
 /**
  * @brief Computes the error values
  *
- * See @cite lin1983error (Chapter 6 - BCH Codes) for more details.
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same result.
  *
- * @param[out] error_values Array of PARAM_DELTA elements receiving the error values
- * @param[in] z Array of PARAM_DELTA + 1 elements storing the polynomial z(x)
- * @param[in] z_degree Integer that is the degree of polynomial z(x)
- * @param[in] error_compact Array of PARAM_DELTA + PARAM_N1 storing compact representation of the error
+ * @param[out] error_values Array of P::n1 elements receiving the error values
+ * @param[in] z Array of P::delta + 1 elements storing the polynomial z(x)
+ * @param[in] error Array of P::n1 elements, error[i] != 0 if i is an error position
  */
+template <class P>
 static void compute_error_values(uint16_t *error_values, const uint16_t *z, const uint8_t *error) {
-    uint16_t beta_j[PARAM_DELTA] = {0};
-    uint16_t e_j[PARAM_DELTA] = {0};
+    if (cpu_supports_avx2()) {
+        compute_error_values_avx2<P>(error_values, z, error);
+        return;
+    }
+
+    compute_error_values_portable<P>(error_values, z, error);
+}
+
+
+
+/**
+ * @brief Computes the error values
+ *
+ * See @cite lin1983error (Chapter 6 - BCH Codes) for more details. <br>
+ * The inverses of the beta_{j_i} and of the denominators of the e_{j_i}
+ * are each computed with a single simultaneous inversion (see gf_batch_inverse).
+ *
+ * @param[out] error_values Array of P::n1 elements receiving the error values
+ * @param[in] z Array of P::delta + 1 elements storing the polynomial z(x)
+ * @param[in] error Array of P::n1 elements, error[i] != 0 if i is an error position
+ */
+template <class P>
+static void compute_error_values_portable(uint16_t *error_values, const uint16_t *z, const uint8_t *error) {
+    uint16_t beta_j[P::delta] = {0};
+    uint16_t inverse[P::delta] = {0};
+    uint16_t numerator[P::delta] = {0};
+    uint16_t denominator[P::delta] = {0};
+    uint16_t denominator_inverse[P::delta] = {0};
+    uint16_t e_j[P::delta] = {0};
 
     uint16_t delta_counter;
     uint16_t delta_real_value;
@@ -292,15 +644,14 @@ static void compute_error_values(uint16_t *error_values, const uint16_t *z, cons
     uint16_t mask2;
     uint16_t tmp1;
     uint16_t tmp2;
-    uint16_t inverse;
     uint16_t inverse_power_j;
 
     // Compute the beta_{j_i} page 31 of the documentation
     delta_counter = 0;
-    for (size_t i = 0; i < PARAM_N1; i++) {
+    for (size_t i = 0; i < P::n1; i++) {
         found = 0;
         mask1 = (uint16_t) (-((int32_t)error[i]) >> 31); // error[i] != 0
-        for (size_t j = 0; j < PARAM_DELTA; j++) {
+        for (size_t j = 0; j < P::delta; j++) {
             mask2 = ~((uint16_t) (-((int32_t) j ^ delta_counter) >> 31)); // j == delta_counter
             beta_j[j] += mask1 & mask2 & gf_exp[i];
             found += mask1 & mask2 & 1;
@@ -310,29 +661,37 @@ static void compute_error_values(uint16_t *error_values, const uint16_t *z, cons
     delta_real_value = delta_counter;
 
     // Compute the e_{j_i} page 31 of the documentation
-    for (size_t i = 0; i < PARAM_DELTA; ++i) {
+    gf_batch_inverse(inverse, beta_j, P::delta);
+
+    for (size_t i = 0; i < P::delta; ++i) {
         tmp1 = 1;
         tmp2 = 1;
-        inverse = gf_inverse(beta_j[i]);
         inverse_power_j = 1;
 
-        for (size_t j = 1; j <= PARAM_DELTA; ++j) {
-            inverse_power_j = gf_mul(inverse_power_j, inverse);
+        for (size_t j = 1; j <= P::delta; ++j) {
+            inverse_power_j = gf_mul(inverse_power_j, inverse[i]);
             tmp1 ^= gf_mul(inverse_power_j, z[j]);
         }
-        for (size_t k = 1; k < PARAM_DELTA; ++k) {
-            tmp2 = gf_mul(tmp2, (1 ^ gf_mul(inverse, beta_j[(i + k) % PARAM_DELTA])));
+        for (size_t k = 1; k < P::delta; ++k) {
+            tmp2 = gf_mul(tmp2, (1 ^ gf_mul(inverse[i], beta_j[(i + k) % P::delta])));
         }
+        numerator[i] = tmp1;
+        denominator[i] = tmp2;
+    }
+
+    gf_batch_inverse(denominator_inverse, denominator, P::delta);
+
+    for (size_t i = 0; i < P::delta; ++i) {
         mask1 = (uint16_t) (((int16_t) i - delta_real_value) >> 15); // i < delta_real_value
-        e_j[i] = mask1 & gf_mul(tmp1, gf_inverse(tmp2));
+        e_j[i] = mask1 & gf_mul(numerator[i], denominator_inverse[i]);
     }
 
     // Place the delta e_{j_i} values at the right coordinates of the output vector
     delta_counter = 0;
-    for (size_t i = 0; i < PARAM_N1; ++i) {
+    for (size_t i = 0; i < P::n1; ++i) {
         found = 0;
         mask1 = (uint16_t) (-((int32_t)error[i]) >> 31); // error[i] != 0
-        for (size_t j = 0; j < PARAM_DELTA; j++) {
+        for (size_t j = 0; j < P::delta; j++) {
             mask2 = ~((uint16_t) (-((int32_t) j ^ delta_counter) >> 31)); // j == delta_counter
             error_values[i] += mask1 & mask2 & e_j[j];
             found += mask1 & mask2 & 1;
@@ -343,15 +702,140 @@ static void compute_error_values(uint16_t *error_values, const uint16_t *z, cons
 
 
 
+/**
+ * @brief Computes the error values with AVX2
+ *
+ * Same algorithm as compute_error_values_portable() where the P::delta slots
+ * of beta_{j_i} and e_{j_i} live in the 16-bit lanes of REGS 256-bit registers. <br>
+ * Selecting the slot of each error position is a lane comparison with the broadcast counter,
+ * and the numerators and denominators of all the e_{j_i} are computed together with gf_mul_vect.
+ *
+ * @param[out] error_values Array of P::n1 elements receiving the error values
+ * @param[in] z Array of P::delta + 1 elements storing the polynomial z(x)
+ * @param[in] error Array of P::n1 elements, error[i] != 0 if i is an error position
+ */
+template <class P>
+HQC_TARGET_AVX2 static void compute_error_values_avx2(uint16_t *error_values, const uint16_t *z, const uint8_t *error) {
+    static constexpr size_t REGS = CEIL_DIVIDE(P::delta, 16);
+
+    // Slot indexes, the extra lanes never match a counter value
+    alignas(32) static constexpr std::array<int16_t, 16 * REGS> SLOTS = [] {
+        std::array<int16_t, 16 * REGS> slots = {};
+        for (size_t i = 0; i < 16 * REGS; ++i) {
+            slots[i] = (i < P::delta) ? (int16_t) i : -1;
+        }
+        return slots;
+    }();
+
+    uint16_t beta_j[16 * REGS] = {0};
+    uint16_t inverse[16 * REGS] = {0};
+    uint16_t denominator[16 * REGS] = {0};
+    uint16_t denominator_inverse[16 * REGS] = {0};
+
+    uint16_t delta_counter;
+    uint16_t mask1;
+
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i slots[REGS];
+    __m256i beta256[REGS];
+    __m256i inverse256[REGS];
+    __m256i power256[REGS];
+    __m256i numerator256[REGS];
+    __m256i denominator256[REGS];
+    __m256i e256[REGS];
+    __m256i factor256, slot256, counter256, value256;
+    __m128i e128;
+
+    for (size_t r = 0; r < REGS; ++r) {
+        slots[r] = _mm256_load_si256((const __m256i *) (SLOTS.data() + 16 * r));
+    }
+
+    // Compute the beta_{j_i} page 31 of the documentation
+    for (size_t r = 0; r < REGS; ++r) {
+        beta256[r] = _mm256_setzero_si256();
+    }
+    delta_counter = 0;
+    for (size_t i = 0; i < P::n1; i++) {
+        mask1 = (uint16_t) (-((int32_t)error[i]) >> 31); // error[i] != 0
+        counter256 = _mm256_set1_epi16(delta_counter);
+        value256 = _mm256_and_si256(_mm256_set1_epi16(mask1), _mm256_set1_epi16(gf_exp[i]));
+        for (size_t r = 0; r < REGS; ++r) {
+            slot256 = _mm256_cmpeq_epi16(slots[r], counter256);
+            beta256[r] = _mm256_xor_si256(beta256[r], _mm256_and_si256(slot256, value256));
+        }
+        delta_counter += mask1 & 1 & ((uint16_t) (delta_counter - P::delta) >> 15); // delta_counter < P::delta
+    }
+
+    // Compute the e_{j_i} page 31 of the documentation
+    for (size_t r = 0; r < REGS; ++r) {
+        _mm256_storeu_si256((__m256i *) (beta_j + 16 * r), beta256[r]);
+    }
+    gf_batch_inverse(inverse, beta_j, P::delta);
+    for (size_t r = 0; r < REGS; ++r) {
+        inverse256[r] = _mm256_loadu_si256((const __m256i *) (inverse + 16 * r));
+        numerator256[r] = one;
+        power256[r] = inverse256[r];
+        denominator256[r] = one;
+    }
+
+    for (size_t j = 1; j <= P::delta; ++j) {
+        for (size_t r = 0; r < REGS; ++r) {
+            numerator256[r] = _mm256_xor_si256(numerator256[r], gf_mul_vect(power256[r], _mm256_set1_epi16(z[j])));
+            power256[r] = gf_mul_vect(power256[r], inverse256[r]);
+        }
+    }
+
+    for (size_t k = 0; k < P::delta; ++k) {
+        // Slot k contributes to every denominator but its own
+        for (size_t r = 0; r < REGS; ++r) {
+            factor256 = _mm256_xor_si256(one, gf_mul_vect(inverse256[r], _mm256_set1_epi16(beta_j[k])));
+            factor256 = _mm256_blendv_epi8(factor256, one, _mm256_cmpeq_epi16(slots[r], _mm256_set1_epi16((int16_t) k)));
+            denominator256[r] = gf_mul_vect(denominator256[r], factor256);
+        }
+    }
+
+    for (size_t r = 0; r < REGS; ++r) {
+        _mm256_storeu_si256((__m256i *) (denominator + 16 * r), denominator256[r]);
+    }
+    gf_batch_inverse(denominator_inverse, denominator, P::delta);
+
+    // Keep the slots below the number of errors found
+    for (size_t r = 0; r < REGS; ++r) {
+        e256[r] = gf_mul_vect(numerator256[r], _mm256_loadu_si256((const __m256i *) (denominator_inverse + 16 * r)));
+        e256[r] = _mm256_and_si256(e256[r], _mm256_cmpgt_epi16(_mm256_set1_epi16(delta_counter), slots[r]));
+    }
+
+    // Place the delta e_{j_i} values at the right coordinates of the output vector
+    delta_counter = 0;
+    for (size_t i = 0; i < P::n1; ++i) {
+        mask1 = (uint16_t) (-((int32_t)error[i]) >> 31); // error[i] != 0
+        counter256 = _mm256_set1_epi16(delta_counter);
+        slot256 = _mm256_setzero_si256();
+        for (size_t r = 0; r < REGS; ++r) {
+            slot256 = _mm256_xor_si256(slot256, _mm256_and_si256(_mm256_cmpeq_epi16(slots[r], counter256), e256[r]));
+        }
+        slot256 = _mm256_and_si256(slot256, _mm256_set1_epi16(mask1));
+        e128 = _mm_xor_si128(_mm256_castsi256_si128(slot256), _mm256_extracti128_si256(slot256, 1));
+        e128 = _mm_xor_si128(e128, _mm_srli_si128(e128, 8));
+        e128 = _mm_xor_si128(e128, _mm_srli_si128(e128, 4));
+        e128 = _mm_xor_si128(e128, _mm_srli_si128(e128, 2));
+        error_values[i] = (uint16_t) _mm_extract_epi16(e128, 0);
+        delta_counter += mask1 & 1 & ((uint16_t) (delta_counter - P::delta) >> 15); // delta_counter < P::delta
+    }
+}
+
+
+
 /**
  * @brief Correct the errors
  *
- * @param[out] cdw Array of PARAM_N1 elements receiving the corrected vector
+ * @param[out] cdw Array of P::n1 elements receiving the corrected vector
  * @param[in] error Array of the error vector
- * @param[in] error_values Array of PARAM_DELTA elements storing the error values
+ * @param[in] error_values Array of P::delta elements storing the error values
  */
+template <class P>
 static void correct_errors(uint8_t *cdw, const uint16_t *error_values) {
-    for (size_t i = 0; i < PARAM_N1; ++i) {
+    for (size_t i = 0; i < P::n1; ++i) {
         cdw[i] ^= error_values[i];
     }
 }
@@ -363,7 +847,7 @@ static void correct_errors(uint8_t *cdw, const uint16_t *error_values) {
  *
  * This function relies on six steps:
  *    <ol>
- *    <li> The first step, is the computation of the 2*PARAM_DELTA syndromes.
+ *    <li> The first step, is the computation of the 2*P::delta syndromes.
  *    <li> The second step is the computation of the error-locator polynomial sigma.
  *    <li> The third step, done by additive FFT, is finding the error-locator numbers by calculating the roots of the polynomial sigma and takings their inverses.
  *    <li> The fourth step, is the polynomial z(x).
@@ -372,46 +856,47 @@ static void correct_errors(uint8_t *cdw, const uint16_t *error_values) {
  *    </ol>
  * For a more complete picture on Reed-Solomon decoding, see Shu. Lin and Daniel J. Costello in Error Control Coding: Fundamentals and Applications @cite lin1983error
  *
- * @param[out] msg Array of size VEC_K_SIZE_64 receiving the decoded message
- * @param[in] cdw Array of size VEC_N1_SIZE_64 storing the received word
+ * @param[out] msg Array of size P::vec_k_size_64 receiving the decoded message
+ * @param[in] cdw Array of size P::vec_n1_size_64 storing the received word
  */
+template <class P>
 void reed_solomon_decode(uint64_t *msg, uint64_t *cdw) {
-    uint8_t cdw_bytes[PARAM_N1] = {0};
-    uint16_t syndromes[2 * PARAM_DELTA] = {0};
-    uint16_t sigma[1 << PARAM_FFT] = {0};
+    uint8_t cdw_bytes[P::n1] = {0};
+    uint16_t syndromes[2 * P::delta] = {0};
+    uint16_t sigma[1 << P::fft] = {0};
     uint8_t error[1 << PARAM_M] = {0};
-    uint16_t z[PARAM_N1] = {0};
-    uint16_t error_values[PARAM_N1] = {0};
+    uint16_t z[P::n1] = {0};
+    uint16_t error_values[P::n1] = {0};
     uint16_t deg;
 
     // Copy the vector in an array of bytes
-    memcpy(cdw_bytes, cdw, PARAM_N1);
+    memcpy(cdw_bytes, cdw, P::n1);
 
-    // Calculate the 2*PARAM_DELTA syndromes
-    compute_syndromes(syndromes, cdw_bytes);
+    // Calculate the 2*P::delta syndromes
+    compute_syndromes<typename P::rs_code>(syndromes, cdw_bytes);
 
     // Compute the error locator polynomial sigma
-    // Sigma's degree is at most PARAM_DELTA but the FFT requires the extra room
-    deg = compute_elp(sigma, syndromes);
+    // Sigma's degree is at most P::delta but the FFT requires the extra room
+    deg = compute_elp<P>(sigma, syndromes);
 
     // Compute the error polynomial error
-    compute_roots(error, sigma);
+    compute_roots<P>(error, sigma);
 
     // Compute the polynomial z(x)
-    compute_z_poly(z, sigma, deg, syndromes);
+    compute_z_poly<P>(z, sigma, deg, syndromes);
 
     // Compute the error values
-    compute_error_values(error_values, z, error);
+    compute_error_values<P>(error_values, z, error);
 
     // Correct the errors
-    correct_errors(cdw_bytes, error_values);
+    correct_errors<P>(cdw_bytes, error_values);
 
     // Retrieve the message from the decoded codeword
-    memcpy(msg, cdw_bytes + (PARAM_G - 1) , PARAM_K);
+    memcpy(msg, cdw_bytes + (P::g - 1) , P::k);
 
     #ifdef VERBOSE
         printf("\n\nThe syndromes: ");
-        for (size_t i = 0 ; i < 2*PARAM_DELTA ; ++i) {
+        for (size_t i = 0 ; i < 2*P::delta ; ++i) {
             printf("%u ", syndromes[i]);
         }
         printf("\n\nThe error locator polynomial: sigma(x) = ");
@@ -420,7 +905,7 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw) {
             printf("%u", sigma[0]);
             first_coeff = false;
         }
-        for (size_t i = 1 ; i < (1 << PARAM_FFT) ; ++i) {
+        for (size_t i = 1 ; i < (1 << P::fft) ; ++i) {
             if (sigma[i] == 0)
                 continue;
             if (!first_coeff)
@@ -442,7 +927,7 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw) {
             printf("%u", z[0]);
             first_coeff_1 = false;
         }
-        for (size_t i = 1 ; i < (PARAM_DELTA + 1) ; ++i) {
+        for (size_t i = 1 ; i < (P::delta + 1) ; ++i) {
             if (z[i] == 0)
                 continue;
             if (!first_coeff_1)
@@ -460,7 +945,7 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw) {
 
         printf("\n\nThe pairs of (error locator numbers, error values): ");
         size_t j = 0;
-        for (size_t i = 0 ; i < PARAM_N1 ; ++i) {
+        for (size_t i = 0 ; i < P::n1 ; ++i) {
             if(error[i]){
                 printf("(%zu, %d) ", i, error_values[j]);
                 j++;
@@ -470,62 +955,63 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw) {
     #endif
 }
 
+template <class P>
 void reed_solomon_decode(uint64_t *msg, uint64_t *cdw, Trace_time* common_time) {
-    uint8_t cdw_bytes[PARAM_N1] = {0};
-    uint16_t syndromes[2 * PARAM_DELTA] = {0};
-    uint16_t sigma[1 << PARAM_FFT] = {0};
+    uint8_t cdw_bytes[P::n1] = {0};
+    uint16_t syndromes[2 * P::delta] = {0};
+    uint16_t sigma[1 << P::fft] = {0};
     uint8_t error[1 << PARAM_M] = {0};
-    uint16_t z[PARAM_N1] = {0};
-    uint16_t error_values[PARAM_N1] = {0};
+    uint16_t z[P::n1] = {0};
+    uint16_t error_values[P::n1] = {0};
     uint16_t deg;
     clock_t start, end;
 
     // Copy the vector in an array of bytes
-    memcpy(cdw_bytes, cdw, PARAM_N1);
+    memcpy(cdw_bytes, cdw, P::n1);
 
-    // Calculate the 2*PARAM_DELTA syndromes
-    start = clock();
-    compute_syndromes(syndromes, cdw_bytes);
-    end = clock();
+    // Calculate the 2*P::delta syndromes
+    start = trace_start(common_time, TRACE_COMPUTE_SYNDROMES);
+    compute_syndromes<typename P::rs_code>(syndromes, cdw_bytes);
+    end = trace_stop(common_time, TRACE_COMPUTE_SYNDROMES);
     common_time->compute_syndromes_time += ((uint32_t)(end - start));
 
     // Compute the error locator polynomial sigma
-    // Sigma's degree is at most PARAM_DELTA but the FFT requires the extra room
-    start = clock();
-    deg = compute_elp(sigma, syndromes);
-    end = clock();
+    // Sigma's degree is at most P::delta but the FFT requires the extra room
+    start = trace_start(common_time, TRACE_COMPUTE_ELP);
+    deg = compute_elp<P>(sigma, syndromes);
+    end = trace_stop(common_time, TRACE_COMPUTE_ELP);
     common_time->compute_elp_time += ((uint32_t)(end-start));
     
     // Compute the error polynomial error
-    start = clock();
-    compute_roots(error, sigma);
-    end = clock();
+    start = trace_start(common_time, TRACE_COMPUTE_ROOTS);
+    compute_roots<P>(error, sigma);
+    end = trace_stop(common_time, TRACE_COMPUTE_ROOTS);
     common_time->compute_roots_time += ((uint32_t)(end - start));
 
     // Compute the polynomial z(x)
-    start = clock();
-    compute_z_poly(z, sigma, deg, syndromes);
-    end = clock();
+    start = trace_start(common_time, TRACE_COMPUTE_Z_POLY);
+    compute_z_poly<P>(z, sigma, deg, syndromes);
+    end = trace_stop(common_time, TRACE_COMPUTE_Z_POLY);
     common_time->compute_z_poly_time += ((uint32_t)(end - start));
 
     // Compute the error values
-    start = clock();
-    compute_error_values(error_values, z, error);
-    end = clock();
+    start = trace_start(common_time, TRACE_COMPUTE_ERROR_VALUES);
+    compute_error_values<P>(error_values, z, error);
+    end = trace_stop(common_time, TRACE_COMPUTE_ERROR_VALUES);
     common_time->compute_error_values_time += ((uint32_t)(end - start));
 
     // Correct the errors
-    start = clock();
-    correct_errors(cdw_bytes, error_values);
-    end = clock();
+    start = trace_start(common_time, TRACE_CORRECT_ERRORS);
+    correct_errors<P>(cdw_bytes, error_values);
+    end = trace_stop(common_time, TRACE_CORRECT_ERRORS);
     common_time->correct_errors_time += ((uint32_t)(end - start));
 
     // Retrieve the message from the decoded codeword
-    memcpy(msg, cdw_bytes + (PARAM_G - 1) , PARAM_K);
+    memcpy(msg, cdw_bytes + (P::g - 1) , P::k);
 
     #ifdef VERBOSE
         printf("\n\nThe syndromes: ");
-        for (size_t i = 0 ; i < 2*PARAM_DELTA ; ++i) {
+        for (size_t i = 0 ; i < 2*P::delta ; ++i) {
             printf("%u ", syndromes[i]);
         }
         printf("\n\nThe error locator polynomial: sigma(x) = ");
@@ -534,7 +1020,7 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw, Trace_time* common_time)
             printf("%u", sigma[0]);
             first_coeff = false;
         }
-        for (size_t i = 1 ; i < (1 << PARAM_FFT) ; ++i) {
+        for (size_t i = 1 ; i < (1 << P::fft) ; ++i) {
             if (sigma[i] == 0)
                 continue;
             if (!first_coeff)
@@ -556,7 +1042,7 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw, Trace_time* common_time)
             printf("%u", z[0]);
             first_coeff_1 = false;
         }
-        for (size_t i = 1 ; i < (PARAM_DELTA + 1) ; ++i) {
+        for (size_t i = 1 ; i < (P::delta + 1) ; ++i) {
             if (z[i] == 0)
                 continue;
             if (!first_coeff_1)
@@ -574,7 +1060,7 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw, Trace_time* common_time)
 
         printf("\n\nThe pairs of (error locator numbers, error values): ");
         size_t j = 0;
-        for (size_t i = 0 ; i < PARAM_N1 ; ++i) {
+        for (size_t i = 0 ; i < P::n1 ; ++i) {
             if(error[i]){
                 printf("(%zu, %d) ", i, error_values[j]);
                 j++;
@@ -583,3 +1069,13 @@ void reed_solomon_decode(uint64_t *msg, uint64_t *cdw, Trace_time* common_time)
         printf("\n");
     #endif
 }
+
+
+
+#define INSTANTIATE_REED_SOLOMON(P) \
+    template void compute_generator_poly<P>(uint16_t *); \
+    template void reed_solomon_encode<P>(uint64_t *, const uint64_t *); \
+    template void reed_solomon_decode<P>(uint64_t *, uint64_t *); \
+    template void reed_solomon_decode<P>(uint64_t *, uint64_t *, Trace_time *);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_REED_SOLOMON)
@@ -5,8 +5,19 @@
  */
 
 #include "shake_prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-shake256incctx shake_prng_state;
+// Bytes of OS entropy seeding the PRNG of a thread that did not call shake_prng_init
+#define PRNG_OS_SEED_BYTES 48
+
+// One PRNG per thread so that concurrent keygen/encaps calls do not share a sponge.
+// A thread that draws from its state without seeding it first is seeded from the OS.
+thread_local shake256incctx shake_prng_state;
+static thread_local bool shake_prng_seeded = false;
+
+static void shake_prng_seed_from_os(void);
 
 
 /**
@@ -26,6 +37,33 @@ void shake_prng_init(uint8_t *entropy_input, uint8_t *personalization_string, ui
     shake256_inc_absorb(&shake_prng_state, personalization_string, perlen);
     shake256_inc_absorb(&shake_prng_state, &domain, 1);
     shake256_inc_finalize(&shake_prng_state);
+    shake_prng_seeded = true;
+}
+
+
+
+/**
+ * @brief Seeds the PRNG of the calling thread with entropy read from /dev/urandom
+ *
+ * Aborts the process if the entropy cannot be read, rather than squeezing from an unseeded state.
+ */
+static void shake_prng_seed_from_os(void) {
+    uint8_t entropy[PRNG_OS_SEED_BYTES];
+    FILE *urandom = fopen("/dev/urandom", "rb");
+
+    if (urandom == NULL) {
+        fprintf(stderr, "shake_prng: cannot open /dev/urandom to seed the PRNG\n");
+        abort();
+    }
+    setvbuf(urandom, NULL, _IONBF, 0);
+    if (fread(entropy, 1, PRNG_OS_SEED_BYTES, urandom) != PRNG_OS_SEED_BYTES) {
+        fprintf(stderr, "shake_prng: cannot read /dev/urandom to seed the PRNG\n");
+        abort();
+    }
+    fclose(urandom);
+
+    shake_prng_init(entropy, NULL, PRNG_OS_SEED_BYTES, 0);
+    memset(entropy, 0, PRNG_OS_SEED_BYTES);
 }
 
 
@@ -34,11 +72,15 @@ void shake_prng_init(uint8_t *entropy_input, uint8_t *personalization_string, ui
  * @brief A SHAKE-256 based PRNG
  *
  * Derived from function SHAKE_256 in fips202.cpp
+ * The first call of a thread that never called shake_prng_init seeds its state from /dev/urandom.
  *
  * @param[out] output Pointer to output
  * @param[in] outlen length of output in bytes
  */
 void shake_prng(uint8_t *output, uint32_t outlen) {
+    if (!shake_prng_seeded) {
+        shake_prng_seed_from_os();
+    }
     shake256_inc_squeeze(output, outlen, &shake_prng_state);
 }
 
@@ -0,0 +1,129 @@
+/**
+ * @file staged_dec.cpp
+ * @brief Implementation of staged_dec.h
+ */
+
+#include "staged_dec.h"
+#include "code.h"
+#include "gf2x.h"
+#include "hqc.h"
+#include "parameters.h"
+#include "parsing.h"
+#include "shake_ds.h"
+#include "vector.h"
+#include <stdint.h>
+#include <string.h>
+
+
+/**
+ * @brief Starts a decapsulation
+ *
+ * @param[out] state Caller-owned state of the decapsulation
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ */
+void hqc_dec_begin(hqc_dec_state *state, const unsigned char *ct, const unsigned char *sk) {
+    memset(state, 0, sizeof(hqc_dec_state));
+    state->stage = HQC_DEC_PARSE;
+    state->ct = ct;
+    state->sk = sk;
+}
+
+
+
+/**
+ * @brief Runs the next stage of a decapsulation
+ *
+ * The stages are the ones of crypto_kem_dec, in the same order and with the same result.
+ *
+ * @param[in,out] state State of the decapsulation
+ * @returns The stage the next call will run, HQC_DEC_DONE once the shared secret is ready
+ */
+hqc_dec_stage hqc_dec_step(hqc_dec_state *state) {
+    const uint8_t *pk = state->sk + SEED_BYTES + VEC_K_SIZE_BYTES;
+
+    switch (state->stage) {
+        case HQC_DEC_PARSE: {
+            aligned_vect x = {};
+            uint8_t expanded_pk[PUBLIC_KEY_BYTES] = {0};
+
+            hqc_ciphertext_from_string(&state->u, &state->v, state->salt, state->ct);
+            hqc_secret_key_from_string(&x, &state->y, state->sigma, expanded_pk, state->sk);
+            break;
+        }
+
+        case HQC_DEC_DECRYPT: {
+            aligned_vect tmp = {};
+
+            vect_resize(&tmp, PARAM_N, &state->v);
+            vect_mul(&state->w, &state->y, &state->u);
+            vect_add(&state->w, &tmp, &state->w);
+            break;
+        }
+
+        case HQC_DEC_DECODE:
+            code_decode<hqc128_params>(state->m, state->w.words);
+            break;
+
+        case HQC_DEC_G_HASH: {
+            uint8_t tmp[VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES] = {0};
+            shake256incctx shake256state;
+
+            memcpy(tmp, state->m, VEC_K_SIZE_BYTES);
+            memcpy(tmp + VEC_K_SIZE_BYTES, pk, PUBLIC_KEY_BYTES);
+            memcpy(tmp + VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES, state->salt, SALT_SIZE_BYTES);
+            shake256_512_ds(&shake256state, state->theta, tmp, VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES, G_FCT_DOMAIN);
+            break;
+        }
+
+        case HQC_DEC_REENCRYPT:
+            hqc_pke_encrypt(&state->u2, &state->v2, state->m, state->theta, pk);
+            break;
+
+        case HQC_DEC_COMPARE:
+            state->result |= vect_compare(&state->u, &state->u2);
+            state->result |= vect_compare(&state->v, &state->v2);
+            state->result -= 1;
+            break;
+
+        case HQC_DEC_K_HASH: {
+            uint8_t mc[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES] = {0};
+            const uint8_t *m = (const uint8_t *) state->m;
+            shake256incctx shake256state;
+
+            for (size_t i = 0; i < VEC_K_SIZE_BYTES; ++i) {
+                mc[i] = (m[i] & state->result) ^ (state->sigma[i] & ~state->result);
+            }
+            memcpy(mc + VEC_K_SIZE_BYTES, state->u.words, VEC_N_SIZE_BYTES);
+            memcpy(mc + VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES, state->v.words, VEC_N1N2_SIZE_BYTES);
+            shake256_512_ds(&shake256state, state->ss, mc, VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES, K_FCT_DOMAIN);
+            break;
+        }
+
+        case HQC_DEC_DONE:
+            return HQC_DEC_DONE;
+    }
+
+    state->stage = (hqc_dec_stage) (state->stage + 1);
+    return state->stage;
+}
+
+
+
+/**
+ * @brief Completes a decapsulation
+ *
+ * Runs the stages left, if any, then clears the state.
+ *
+ * @param[in,out] state State of the decapsulation
+ * @param[out] ss String containing the shared secret
+ * @returns 0 if decapsulation is successful, -1 otherwise
+ */
+int hqc_dec_finish(hqc_dec_state *state, unsigned char *ss) {
+    while (hqc_dec_step(state) != HQC_DEC_DONE);
+
+    int status = (state->result & 1) - 1;
+    memcpy(ss, state->ss, SHARED_SECRET_BYTES);
+    memset(state, 0, sizeof(hqc_dec_state));
+    return status;
+}
@@ -0,0 +1,123 @@
+#ifndef STAGED_DEC_H
+#define STAGED_DEC_H
+
+/**
+ * @file staged_dec.h
+ * @brief Resumable decapsulation of the HQC_KEM IND_CCA2 scheme for event-loop servers
+ *
+ * hqc_dec_begin prepares a caller-owned state, each hqc_dec_step call runs one stage
+ * of crypto_kem_dec and hqc_dec_finish returns the shared secret. The ciphertext and the
+ * secret key must stay valid until hqc_dec_finish returns.
+ */
+
+#include "parameters.h"
+#include "vector.h"
+#include <stdint.h>
+
+enum hqc_dec_stage {
+    HQC_DEC_PARSE, // Parse the ciphertext and expand the secret key
+    HQC_DEC_DECRYPT, // Compute v - u.y
+    HQC_DEC_DECODE, // Decode m from v - u.y
+    HQC_DEC_G_HASH, // Derive theta from m, pk and the salt
+    HQC_DEC_REENCRYPT, // Encrypt m again with theta
+    HQC_DEC_COMPARE, // Compare both ciphertexts
+    HQC_DEC_K_HASH, // Derive the shared secret
+    HQC_DEC_DONE
+};
+
+struct hqc_dec_state {
+    hqc_dec_stage stage;
+    const unsigned char *ct;
+    const unsigned char *sk;
+    uint8_t result;
+    aligned_vect u;
+    aligned_vect v;
+    uint64_t salt[SALT_SIZE_64];
+    aligned_vect y;
+    aligned_vect w;
+    uint64_t m[VEC_K_SIZE_64];
+    uint8_t sigma[VEC_K_SIZE_BYTES];
+    uint8_t theta[SHAKE256_512_BYTES];
+    aligned_vect u2;
+    aligned_vect v2;
+    uint8_t ss[SHARED_SECRET_BYTES];
+};
+
+void hqc_dec_begin(hqc_dec_state *state, const unsigned char *ct, const unsigned char *sk);
+hqc_dec_stage hqc_dec_step(hqc_dec_state *state);
+int hqc_dec_finish(hqc_dec_state *state, unsigned char *ss);
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+/**
+ * Decides when the coroutine wrapper resumes a decapsulation. The event loop implements it,
+ * for instance by queueing the handles per stage to run all pending re-encryptions in a row.
+ */
+class Dec_scheduler {
+    public:
+        virtual ~Dec_scheduler() = default;
+        virtual void schedule(std::coroutine_handle<> handle, hqc_dec_stage next) = 0;
+};
+
+/**
+ * Handle of a decapsulation coroutine. The coroutine stays suspended at its end
+ * until the task is destroyed, so result() can be read once done() is true.
+ */
+class Dec_task {
+    public:
+        struct promise_type {
+            int status = 0;
+
+            Dec_task get_return_object() { return Dec_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_value(int value) { status = value; }
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        explicit Dec_task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+        Dec_task(Dec_task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        Dec_task(const Dec_task&) = delete;
+        Dec_task& operator=(const Dec_task&) = delete;
+        ~Dec_task() { if (handle) handle.destroy(); }
+
+        bool done() const { return handle.done(); }
+        int result() const { return handle.promise().status; }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+};
+
+struct Dec_stage_awaiter {
+    Dec_scheduler *scheduler;
+    hqc_dec_stage next;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { scheduler->schedule(handle, next); }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Decapsulation coroutine suspending before every stage
+ *
+ * @param[out] ss String containing the shared secret
+ * @param[in] state Caller-owned state, valid until the task is done
+ * @param[in] ct String containing the ciphertext
+ * @param[in] sk String containing the secret key
+ * @param[in] scheduler Scheduler resuming the coroutine
+ */
+inline Dec_task crypto_kem_dec_async(unsigned char *ss, hqc_dec_state *state, const unsigned char *ct, const unsigned char *sk, Dec_scheduler *scheduler) {
+    hqc_dec_begin(state, ct, sk);
+    hqc_dec_stage next = state->stage;
+    while (next != HQC_DEC_DONE) {
+        co_await Dec_stage_awaiter{scheduler, next};
+        next = hqc_dec_step(state);
+    }
+    co_return hqc_dec_finish(state, ss);
+}
+#endif
+
+#endif
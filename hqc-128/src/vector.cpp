@@ -3,14 +3,90 @@
  * @brief Implementation of vectors sampling and some utilities for the HQC scheme
  */
 
+#include "cpu_features.h"
 #include "shake_prng.h"
 #include "parameters.h"
 #include "vector.h"
+#include <array>
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <immintrin.h>
 
+// shift of the multiply-high reduction of barrett_reduce()
+#define SHBIT32 46
+
+// key of a position: (word << 7) | bit, key of the marker of a word: (word << 7) | 64
+#define MARKER_BIT 64
+// bigger than every key, not a marker and in no word of the vector
+#define SENTINEL_KEY (INT32_MAX ^ MARKER_BIT)
+
+template <class P> static constexpr std::array<uint64_t, P::omega_r> generate_barrett_constants();
+template <class P> static inline uint16_t barrett_reduce(uint32_t a, uint16_t i);
 static inline uint32_t compare_u32(const uint32_t v1, const uint32_t v2);
+static void remove_duplicates(uint32_t *support, uint16_t weight);
+static void remove_duplicates_portable(uint32_t *support, uint16_t weight);
+HQC_TARGET_AVX2 static void remove_duplicates_avx2(uint32_t *support, uint16_t weight);
+static inline void compare_exchange(int32_t *a, int32_t *b);
+static void half_cleaners(int32_t *keys, size_t n, size_t j);
+HQC_TARGET_AVX2 static inline void minmax_epi32(__m256i *a, __m256i *b);
+HQC_TARGET_AVX2 static inline __m256i reverse_epi32(__m256i x);
+HQC_TARGET_AVX2 static inline __m256i bitonic_merge8(__m256i x);
+HQC_TARGET_AVX2 static inline __m256i bitonic_sort8(__m256i x);
+HQC_TARGET_AVX2 static void bitonic_merge_avx2(__m256i *x, size_t n);
+HQC_TARGET_AVX2 static void bitonic_sort_avx2(__m256i *x, size_t n);
+template <class P> static void scatter_support(uint64_t *v, const uint32_t *support, uint16_t weight, sampling_scratch<P> *scratch);
+template <class P> static void scatter_support_portable(uint64_t *v, const uint32_t *support, uint16_t weight, sampling_scratch<P> *scratch);
+template <class P> HQC_TARGET_AVX2 static void scatter_support_avx2(uint64_t *v, const uint32_t *support, uint16_t weight, sampling_scratch<P> *scratch);
+template <class P> static void vect_add_portable(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> HQC_TARGET_AVX2 static void vect_add_avx2(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> static uint8_t vect_compare_portable(const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> HQC_TARGET_AVX2 static uint8_t vect_compare_avx2(const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> static void vect_resize_portable(padded_vect<P> *o, uint32_t size_o, const padded_vect<P> *v);
+template <class P> HQC_TARGET_AVX2 static void vect_resize_avx2(padded_vect<P> *o, uint32_t size_o, const padded_vect<P> *v);
+
+
+/**
+ * @brief Constants of the Barrett reduction modulo P::n - i
+ *
+ * @returns the array v_val such that v_val[i] = floor(2^SHBIT32 / (P::n - i)) for 0 <= i < P::omega_r
+ */
+template <class P>
+static constexpr std::array<uint64_t, P::omega_r> generate_barrett_constants() {
+    std::array<uint64_t, P::omega_r> v_val = {};
+    for (size_t i = 0; i < P::omega_r; ++i) {
+        v_val[i] = ((uint64_t) 1 << SHBIT32) / (P::n - i);
+    }
+    return v_val;
+}
+
+template <class P> static constexpr std::array<uint64_t, P::omega_r> v_val = generate_barrett_constants<P>();
+
+
+
+/**
+ * @brief Constant-time Barrett reduction
+ *
+ * Replaces the division by P::n - i with a multiplication by a precomputed constant,
+ * so that its latency does not depend on the operands. <br>
+ * The estimated quotient is either the quotient or one less (for a few multiples of P::n - i
+ * close to 2^32), so P::n - i is subtracted once more when the remainder is not reduced.
+ *
+ * @param[in] a An integer to be reduced
+ * @param[in] i An array index
+ * @return an integer equal to a % (P::n - i)
+ */
+template <class P>
+static inline uint16_t barrett_reduce(uint32_t a, uint16_t i) {
+    uint32_t d = P::n - i;
+    uint32_t t, r, mask;
+
+    t = (uint32_t) ((v_val<P>[i] * a + v_val<P>[i]) >> SHBIT32);
+    r = a - t * d - d;
+    mask = (uint32_t) -(r >> 31);
+    return (uint16_t) (r + (d & mask));
+}
+
 
 
 /**
@@ -29,26 +105,34 @@ static inline uint32_t compare_u32(const uint32_t v1, const uint32_t v2) {
 
 
 /**
- * @brief Generates a vector of a given Hamming weight
+ * @brief Replaces the duplicated positions of a support
  *
- * Implementation of Algorithm 5 in https://eprint.iacr.org/2021/1631.pdf
+ * Going down from the end of the support, a position equal to one of the following positions
+ * is replaced by its index i, which cannot appear after it. <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same support.
  *
- * @param[in] ctx Pointer to the context of the seed expander
- * @param[in] v Pointer to an array
+ * @param[in,out] support Array of weight positions below n, with room for 7 more entries
  * @param[in] weight Integer that is the Hamming weight
  */
-void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t weight) {
-    uint32_t rand_u32[PARAM_OMEGA_R] = {0};
-    uint32_t support[PARAM_OMEGA_R] = {0};
-    uint32_t index_tab [PARAM_OMEGA_R] = {0};
-    uint64_t bit_tab [PARAM_OMEGA_R] = {0};
+static void remove_duplicates(uint32_t *support, uint16_t weight) {
+    if (cpu_supports_avx2()) {
+        remove_duplicates_avx2(support, weight);
+        return;
+    }
+
+    remove_duplicates_portable(support, weight);
+}
 
-    seedexpander(ctx, (uint8_t *)&rand_u32, 4 * weight);
 
-    for (size_t i = 0; i < weight; ++i) {
-        support[i] = i + rand_u32[i] % (PARAM_N - i);
-    }
 
+/**
+ * @brief Replaces the duplicated positions of a support
+ *
+ * @param[in,out] support Array of weight positions below n
+ * @param[in] weight Integer that is the Hamming weight
+ */
+static void remove_duplicates_portable(uint32_t *support, uint16_t weight) {
     for (int32_t i = (weight - 1); i -- > 0;) {
         uint32_t found = 0;
 
@@ -59,44 +143,453 @@ void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t
         uint32_t mask = -found;
         support[i] = (mask & i) ^ (~mask & support[i]);
     }
+}
+
+
+
+/**
+ * @brief Replaces the duplicated positions of a support with AVX2
+ *
+ * Each position is compared with 8 of the following positions per instruction and the comparisons are ORed.
+ * The following positions are read by blocks of 8 entries, so the support is padded with 7 sentinels
+ * that no position can equal. The number of loads only depends on the weight.
+ *
+ * @param[in,out] support Array of weight positions below n, with room for 7 more entries
+ * @param[in] weight Integer that is the Hamming weight
+ */
+HQC_TARGET_AVX2 static void remove_duplicates_avx2(uint32_t *support, uint16_t weight) {
+    for (size_t i = weight; i < weight + 7U; ++i) {
+        support[i] = UINT32_MAX;
+    }
 
-    for (size_t i = 0; i < weight; i++) {
-        index_tab[i] = support[i] >> 6;
-        int32_t pos = support[i] & 0x3f;
-        bit_tab[i]  = ((uint64_t) 1) << pos;
+    for (int32_t i = (weight - 1); i -- > 0;) {
+        const __m256i position = _mm256_set1_epi32((int32_t) support[i]);
+        __m256i found256 = _mm256_setzero_si256();
+
+        for (size_t j = i + 1; j < weight; j += 8) {
+            const __m256i next = _mm256_loadu_si256((const __m256i *) &support[j]);
+            found256 = _mm256_or_si256(found256, _mm256_cmpeq_epi32(next, position));
+        }
+
+        uint32_t mask = -(uint32_t) (1 ^ _mm256_testz_si256(found256, found256));
+        support[i] = (mask & i) ^ (~mask & support[i]);
     }
+}
+
+
+
+/**
+ * @brief Sorts two keys in constant time
+ *
+ * @param[in,out] a Receives the smallest key
+ * @param[in,out] b Receives the largest key
+ */
+static inline void compare_exchange(int32_t *a, int32_t *b) {
+    // keys are nonnegative, so b - a does not overflow
+    int32_t mask = (*b - *a) >> 31;
+    int32_t diff = (*a ^ *b) & mask;
+    *a ^= diff;
+    *b ^= diff;
+}
+
+
 
-    uint64_t val = 0;
-    for (uint32_t i = 0; i < VEC_N_SIZE_64; i++) {
-        val = 0;
-        for (uint32_t j = 0 ; j < weight ; j++) {
-            uint32_t tmp = i - index_tab[j];
-            int val1 = 1 ^ ((tmp | -tmp) >> 31);
-            uint64_t mask = -val1;
-            val |= (bit_tab[j] & mask);
+/**
+ * @brief Half-cleaners of distance j over the blocks of 2 * j keys
+ *
+ * @param[in,out] keys Array of n keys
+ * @param[in] n Number of keys, a multiple of 2 * j
+ * @param[in] j Distance of the compared keys
+ */
+static void half_cleaners(int32_t *keys, size_t n, size_t j) {
+    for (size_t i = 0; i < n; i += 2 * j) {
+        for (size_t t = 0; t < j; t++) {
+            compare_exchange(&keys[i + t], &keys[i + t + j]);
         }
-        v[i] |= val;
     }
 }
 
 
 
 /**
- * @brief Generates a random vector of dimension <b>PARAM_N</b>
+ * @brief Sorts the 32-bit lanes of two registers
  *
- * This function generates a random binary vector of dimension <b>PARAM_N</b>. It generates a random
- * array of bytes using the seedexpander function, and drop the extra bits using a mask.
+ * @param[in,out] a Register receiving the lane-wise minimum
+ * @param[in,out] b Register receiving the lane-wise maximum
+ */
+HQC_TARGET_AVX2 static inline void minmax_epi32(__m256i *a, __m256i *b) {
+    __m256i min = _mm256_min_epi32(*a, *b);
+    *b = _mm256_max_epi32(*a, *b);
+    *a = min;
+}
+
+
+
+/**
+ * @brief Reverses the order of the 32-bit lanes of a register
+ *
+ * @returns the register whose lane i is lane 7 - i of x
+ * @param[in] x A register
+ */
+HQC_TARGET_AVX2 static inline __m256i reverse_epi32(__m256i x) {
+    return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+
+
+/**
+ * @brief Sorts a bitonic register
+ *
+ * Half-cleaners of distance 4, 2 and 1 between the 32-bit lanes.
+ *
+ * @returns the 8 lanes of x in increasing order
+ * @param[in] x A register whose lanes form a bitonic sequence
+ */
+HQC_TARGET_AVX2 static inline __m256i bitonic_merge8(__m256i x) {
+    __m256i y;
+
+    y = _mm256_permute2x128_si256(x, x, 0x01);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xF0);
+    y = _mm256_shuffle_epi32(x, 0x4E);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+    return x;
+}
+
+
+
+/**
+ * @brief Sorts a register
+ *
+ * Same network as scatter_support_portable(): the first stage of each merge compares lane i with its mirror,
+ * so that all the following half-cleaners sort in increasing order.
+ *
+ * @returns the 8 lanes of x in increasing order
+ * @param[in] x A register
+ */
+HQC_TARGET_AVX2 static inline __m256i bitonic_sort8(__m256i x) {
+    __m256i y;
+
+    // blocks of 2: i and i ^ 1
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+
+    // blocks of 4: i and i ^ 3, then distance 1
+    y = _mm256_shuffle_epi32(x, 0x1B);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+
+    // blocks of 8: i and i ^ 7, then distances 2 and 1
+    y = reverse_epi32(x);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xF0);
+    y = _mm256_shuffle_epi32(x, 0x4E);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, 0xB1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+    return x;
+}
+
+
+
+/**
+ * @brief Sorts a bitonic sequence of n registers
+ *
+ * @param[in,out] x Array of n registers whose 8 * n lanes form a bitonic sequence
+ * @param[in] n Number of registers, a power of 2
+ */
+HQC_TARGET_AVX2 static void bitonic_merge_avx2(__m256i *x, size_t n) {
+    for (size_t j = n >> 1; j > 0; j >>= 1) {
+        for (size_t i = 0; i < n; i += 2 * j) {
+            for (size_t t = 0; t < j; t++) {
+                minmax_epi32(&x[i + t], &x[i + t + j]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        x[i] = bitonic_merge8(x[i]);
+    }
+}
+
+
+
+/**
+ * @brief Sorts n registers
+ *
+ * Same network as bitonic_sort8(), on registers: each merge of two sorted blocks
+ * compares lane i with its mirror then sorts both bitonic halves.
+ *
+ * @param[in,out] x Array of n registers whose 8 * n lanes are sorted in increasing order
+ * @param[in] n Number of registers, a power of 2
+ */
+HQC_TARGET_AVX2 static void bitonic_sort_avx2(__m256i *x, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = bitonic_sort8(x[i]);
+    }
+
+    for (size_t k = 2; k <= n; k <<= 1) {
+        for (size_t i = 0; i < n; i += k) {
+            for (size_t t = 0; t < k / 2; t++) {
+                __m256i mirror = reverse_epi32(x[i + k - 1 - t]);
+                minmax_epi32(&x[i + t], &mirror);
+                x[i + k - 1 - t] = reverse_epi32(mirror);
+            }
+            bitonic_merge_avx2(&x[i], k / 2);
+            bitonic_merge_avx2(&x[i + k / 2], k / 2);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Adds to v the vector of support
+ *
+ * Constant-time scatter whose cost grows with (P::vec_n_size_64 + weight) log(P::vec_n_size_64 + weight)
+ * instead of P::vec_n_size_64 * weight, without any secret-dependent address:
+ *  - the positions are sorted as keys (word << 7) | bit,
+ *  - they are merged with one marker (word << 7) | 64 per word, so that each marker follows the positions of its word,
+ *  - a segmented OR scan gives to each marker the word made of the positions before it,
+ *  - the markers are compacted in place: the marker of word i, with c positions before it,
+ *    moves down by c in one pass per bit of c (no two markers collide since c does not decrease with i). <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise. Both return the same vector.
+ *
+ * @param[in,out] v Vector of P::vec_n_size_64 words to which the positions are added
+ * @param[in] support Array of weight distinct positions below n
+ * @param[in] weight Integer that is the Hamming weight
+ */
+template <class P>
+static void scatter_support(uint64_t *v, const uint32_t *support, uint16_t weight, sampling_scratch<P> *scratch) {
+    if (cpu_supports_avx2()) {
+        scatter_support_avx2<P>(v, support, weight, scratch);
+        return;
+    }
+
+    scatter_support_portable<P>(v, support, weight, scratch);
+}
+
+
+
+/**
+ * @brief Adds to v the vector of support
  *
+ * @param[in,out] v Vector of P::vec_n_size_64 words to which the positions are added
+ * @param[in] support Array of weight distinct positions below n
+ * @param[in] weight Integer that is the Hamming weight
+ */
+template <class P>
+static void scatter_support_portable(uint64_t *v, const uint32_t *support, uint16_t weight, sampling_scratch<P> *scratch) {
+    constexpr size_t sort_size = sampling_scratch<P>::sort_size;
+    constexpr size_t merge_size = sampling_scratch<P>::merge_size;
+    constexpr size_t scan_size = sampling_scratch<P>::scan_size;
+    int32_t *keys = scratch->keys;
+    uint64_t *words = scratch->words;
+    uint64_t *shifts = scratch->shifts;
+    uint64_t carry = 0;
+
+    for (size_t i = 0; i < sort_size; i++) {
+        keys[i] = (i < weight) ? (int32_t) (support[i] + (support[i] & ~0x3fU)) : SENTINEL_KEY;
+    }
+
+    // bitonic sort, the first stage of each merge compares key i with its mirror
+    for (size_t k = 2; k <= sort_size; k <<= 1) {
+        for (size_t i = 0; i < sort_size; i += k) {
+            for (size_t t = 0; t < k / 2; t++) {
+                compare_exchange(&keys[i + t], &keys[i + k - 1 - t]);
+            }
+        }
+        for (size_t j = k >> 2; j > 0; j >>= 1) {
+            half_cleaners(keys, sort_size, j);
+        }
+    }
+
+    // markers in decreasing order after the sorted positions form a bitonic sequence
+    for (size_t i = sort_size; i < merge_size; i++) {
+        size_t word = merge_size - 1 - i;
+        keys[i] = (word < P::vec_n_size_64) ? (int32_t) ((word << 7) | MARKER_BIT) : SENTINEL_KEY;
+    }
+    for (size_t j = merge_size >> 1; j > 0; j >>= 1) {
+        half_cleaners(keys, merge_size, j);
+    }
+
+    // segmented OR scan: a marker ends a segment
+    for (size_t k = 0; k < scan_size; k++) {
+        uint64_t marker = -(uint64_t) ((keys[k] >> 6) & 1);
+        words[k] = carry | (~marker & ((uint64_t) 1 << (keys[k] & 0x3f)));
+        carry = words[k] & ~marker;
+        shifts[k] = (uint64_t) (k - (size_t) (keys[k] >> 7)) & marker;
+    }
+
+    // compaction, k receives k + b when the remaining shift of k + b has the bit b
+    for (uint32_t log_b = 0; (1U << log_b) <= weight; log_b++) {
+        const uint32_t b = 1U << log_b;
+        for (size_t k = 0; k + b < scan_size; k++) {
+            uint64_t move_in = -((shifts[k + b] >> log_b) & 1);
+            uint64_t move_out = -((shifts[k] >> log_b) & 1);
+
+            words[k] = (words[k + b] & move_in) | (words[k] & ~move_in);
+            shifts[k] = ((shifts[k + b] ^ b) & move_in) | (shifts[k] & ~(move_in | move_out));
+        }
+    }
+
+    for (size_t i = 0; i < P::vec_n_size_64; i++) {
+        v[i] |= words[i];
+    }
+}
+
+
+
+/**
+ * @brief Adds to v the vector of support with AVX2
+ *
+ * The sort and the merge run on 8 keys per register, the scan and the compaction on 4 words per register.
+ *
+ * @param[in,out] v Vector of P::vec_n_size_64 words to which the positions are added
+ * @param[in] support Array of weight distinct positions below n
+ * @param[in] weight Integer that is the Hamming weight
+ */
+template <class P>
+HQC_TARGET_AVX2 static void scatter_support_avx2(uint64_t *v, const uint32_t *support, uint16_t weight, sampling_scratch<P> *scratch) {
+    constexpr size_t sort_size = sampling_scratch<P>::sort_size;
+    constexpr size_t merge_size = sampling_scratch<P>::merge_size;
+    constexpr size_t scan_size = sampling_scratch<P>::scan_size;
+    // the network sorts the keys in place, 8 per register
+    int32_t *keys = scratch->keys;
+    __m256i *keys256 = (__m256i *) scratch->keys;
+    uint64_t *words = scratch->words;
+    uint64_t *shifts = scratch->shifts;
+    __m256i word_index = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i carry = _mm256_setzero_si256();
+    __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i marker_bit = _mm256_set1_epi64x(MARKER_BIT);
+
+    for (size_t i = 0; i < sort_size; i++) {
+        keys[i] = (i < weight) ? (int32_t) (support[i] + (support[i] & ~0x3fU)) : SENTINEL_KEY;
+    }
+    bitonic_sort_avx2(keys256, sort_size / 8);
+
+    // markers in decreasing order after the sorted positions form a bitonic sequence
+    for (size_t i = merge_size / 8; i-- > sort_size / 8;) {
+        __m256i marker = _mm256_or_si256(_mm256_slli_epi32(word_index, 7), _mm256_set1_epi32(MARKER_BIT));
+        __m256i in_vector = _mm256_cmpgt_epi32(_mm256_set1_epi32(P::vec_n_size_64), word_index);
+        keys256[i] = _mm256_blendv_epi8(_mm256_set1_epi32(SENTINEL_KEY), marker, in_vector);
+        word_index = _mm256_add_epi32(word_index, _mm256_set1_epi32(8));
+    }
+    bitonic_merge_avx2(keys256, merge_size / 8);
+
+    // segmented OR scan, 4 keys at a time: a marker ends a segment
+    for (size_t k = 0; k < scan_size; k += 4) {
+        __m256i key = _mm256_cvtepi32_epi64(_mm_load_si128((const __m128i *) &keys[k]));
+        __m256i marker = _mm256_cmpeq_epi64(_mm256_and_si256(key, marker_bit), marker_bit);
+        __m256i bit = _mm256_and_si256(key, _mm256_set1_epi64x(0x3f));
+        __m256i word = _mm256_andnot_si256(marker, _mm256_sllv_epi64(_mm256_set1_epi64x(1), bit));
+        // markers among the previous 1 then 2 keys of the register
+        __m256i cut = _mm256_blend_epi32(_mm256_permute4x64_epi64(marker, 0x90), zero, 0x03);
+
+        word = _mm256_or_si256(word, _mm256_andnot_si256(cut, _mm256_blend_epi32(_mm256_permute4x64_epi64(word, 0x90), zero, 0x03)));
+        cut = _mm256_or_si256(cut, _mm256_blend_epi32(_mm256_permute4x64_epi64(cut, 0x90), zero, 0x03));
+        word = _mm256_or_si256(word, _mm256_andnot_si256(cut, _mm256_permute2x128_si256(word, word, 0x08)));
+        cut = _mm256_or_si256(cut, _mm256_permute2x128_si256(cut, cut, 0x08));
+        word = _mm256_or_si256(word, _mm256_andnot_si256(cut, carry));
+
+        _mm256_store_si256((__m256i *) &words[k], word);
+        _mm256_store_si256((__m256i *) &shifts[k], _mm256_and_si256(marker, _mm256_sub_epi64(index, _mm256_srli_epi64(key, 7))));
+        carry = _mm256_permute4x64_epi64(_mm256_andnot_si256(marker, word), 0xFF);
+        index = _mm256_add_epi64(index, _mm256_set1_epi64x(4));
+    }
+
+    // the compaction reads up to weight keys past scan_size
+    for (size_t k = scan_size; k < scan_size + sort_size; k++) {
+        words[k] = 0;
+        shifts[k] = 0;
+    }
+
+    // compaction, k receives k + b when the remaining shift of k + b has the bit b
+    for (uint64_t b = 1; b <= weight; b <<= 1) {
+        const __m256i b256 = _mm256_set1_epi64x((int64_t) b);
+        for (size_t k = 0; k < scan_size; k += 4) {
+            __m256i shift_in = _mm256_loadu_si256((const __m256i *) &shifts[k + b]);
+            __m256i shift_own = _mm256_load_si256((const __m256i *) &shifts[k]);
+            __m256i word_in = _mm256_loadu_si256((const __m256i *) &words[k + b]);
+            __m256i word_own = _mm256_load_si256((const __m256i *) &words[k]);
+            __m256i move_in = _mm256_cmpeq_epi64(_mm256_and_si256(shift_in, b256), b256);
+            __m256i move_out = _mm256_cmpeq_epi64(_mm256_and_si256(shift_own, b256), b256);
+            __m256i word = _mm256_or_si256(_mm256_and_si256(move_in, word_in), _mm256_andnot_si256(move_in, word_own));
+            __m256i shift = _mm256_or_si256(_mm256_and_si256(move_in, _mm256_xor_si256(shift_in, b256)),
+                                            _mm256_andnot_si256(_mm256_or_si256(move_in, move_out), shift_own));
+
+            _mm256_store_si256((__m256i *) &words[k], word);
+            _mm256_store_si256((__m256i *) &shifts[k], shift);
+        }
+    }
+
+    for (size_t i = 0; i < P::vec_n_size_64; i++) {
+        v[i] |= words[i];
+    }
+}
+
+
+
+/**
+ * @brief Generates a vector of a given Hamming weight
+ *
+ * Implementation of Algorithm 5 in https://eprint.iacr.org/2021/1631.pdf
+ *
+ * @param[in] ctx Pointer to the context of the seed expander
  * @param[in] v Pointer to an array
+ * @param[in] weight Integer that is the Hamming weight
+ */
+template <class P>
+void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t weight) {
+    sampling_scratch<P> scratch;
+    vect_set_random_fixed_weight(ctx, v, weight, &scratch);
+}
+
+
+
+/**
+ * @brief Generates a vector of a given Hamming weight, using the caller scratch
+ *
  * @param[in] ctx Pointer to the context of the seed expander
+ * @param[in] v Pointer to an array
+ * @param[in] weight Integer that is the Hamming weight
+ * @param[in] scratch Scratch memory of the sampling
  */
-void vect_set_random(seedexpander_state *ctx, uint64_t *v) {
-    uint8_t rand_bytes[VEC_N_SIZE_BYTES] = {0};
+template <class P>
+void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t weight, sampling_scratch<P> *scratch) {
+    uint32_t rand_u32[P::omega_r] = {0};
+    uint32_t support[P::omega_r + 7] = {0};
 
-    seedexpander(ctx, rand_bytes, VEC_N_SIZE_BYTES);
+    seedexpander(ctx, (uint8_t *)&rand_u32, 4 * weight);
 
-    memcpy(v, rand_bytes, VEC_N_SIZE_BYTES);
-    v[VEC_N_SIZE_64 - 1] &= BITMASK(PARAM_N, 64);
+    for (size_t i = 0; i < weight; ++i) {
+        support[i] = i + barrett_reduce<P>(rand_u32[i], i);
+    }
+
+    remove_duplicates(support, weight);
+
+    scatter_support(v, support, weight, scratch);
+}
+
+
+
+/**
+ * @brief Generates a random vector of dimension <b>P::n</b>
+ *
+ * This function generates a random binary vector of dimension <b>P::n</b>. It generates a random
+ * array of bytes using the seedexpander function, and drop the extra bits using a mask.
+ *
+ * @param[in] v Pointer to an array
+ * @param[in] ctx Pointer to the context of the seed expander
+ */
+template <class P>
+void vect_set_random(seedexpander_state *ctx, uint64_t *v) {
+    seedexpander(ctx, (uint8_t *) v, P::vec_n_size_bytes);
+    v[P::vec_n_size_64 - 1] &= P::red_mask;
 }
 
 
@@ -163,19 +656,13 @@ uint8_t vect_compare(const uint8_t *v1, const uint8_t *v2, uint32_t size) {
  * @param[in] v Pointer to the input vector
  * @param[in] size_v Integer that is the size of the input vector in bits
  */
+template <class P>
 void vect_resize(uint64_t *o, uint32_t size_o, const uint64_t *v, uint32_t size_v) {
-    uint64_t mask = 0x7FFFFFFFFFFFFFFF;
-    int8_t val = 0;
     if (size_o < size_v) {
+        memcpy(o, v, P::vec_n1n2_size_bytes);
 
         if (size_o % 64) {
-            val = 64 - (size_o % 64);
-        }
-
-        memcpy(o, v, VEC_N1N2_SIZE_BYTES);
-
-        for (int8_t i = 0 ; i < val ; ++i) {
-            o[VEC_N1N2_SIZE_64 - 1] &= (mask >> i);
+            o[P::vec_n1n2_size_64 - 1] &= BITMASK(size_o, 64);
         }
     } else {
         memcpy(o, v, CEIL_DIVIDE(size_v, 8));
@@ -184,35 +671,252 @@ void vect_resize(uint64_t *o, uint32_t size_o, const uint64_t *v, uint32_t size_
 
 
 
+/**
+ * @brief Clears the padding of a vector
+ *
+ * @param[in,out] v Padded vector
+ * @param[in] size Integer that is the size of the vector in bytes, the bytes after it are set to zero
+ */
+template <class P>
+void vect_clear_padding(padded_vect<P> *v, uint32_t size) {
+    memset((uint8_t *) v->words + size, 0, sizeof(v->words) - size);
+}
+
+
+
+/**
+ * @brief Generates a random padded vector of dimension <b>P::n</b>
+ *
+ * Same vector as vect_set_random<P>(ctx, v->words), with the padding of v cleared.
+ *
+ * @param[in] ctx Pointer to the context of the seed expander
+ * @param[out] v Padded vector
+ */
+template <class P>
+void vect_set_random(seedexpander_state *ctx, padded_vect<P> *v) {
+    vect_set_random<P>(ctx, v->words);
+    vect_clear_padding(v, P::vec_n_size_64 * sizeof(uint64_t));
+}
+
+
+
+/**
+ * @brief Adds two padded vectors
+ *
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise.
+ *
+ * @param[out] o Padded vector that is the result
+ * @param[in] v1 Padded vector that is the first vector
+ * @param[in] v2 Padded vector that is the second vector
+ */
+template <class P>
+void vect_add(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2) {
+    if (cpu_supports_avx2()) {
+        vect_add_avx2(o, v1, v2);
+        return;
+    }
+
+    vect_add_portable(o, v1, v2);
+}
+
+
+
+/**
+ * @brief Adds two padded vectors
+ *
+ * @param[out] o Padded vector that is the result
+ * @param[in] v1 Padded vector that is the first vector
+ * @param[in] v2 Padded vector that is the second vector
+ */
+template <class P>
+static void vect_add_portable(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2) {
+    for (size_t i = 0; i < padded_vect<P>::size_64; ++i) {
+        o->words[i] = v1->words[i] ^ v2->words[i];
+    }
+}
+
+
+
+/**
+ * @brief Adds two padded vectors with AVX2 aligned loads and stores
+ *
+ * @param[out] o Padded vector that is the result
+ * @param[in] v1 Padded vector that is the first vector
+ * @param[in] v2 Padded vector that is the second vector
+ */
+template <class P>
+HQC_TARGET_AVX2 static void vect_add_avx2(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2) {
+    for (size_t i = 0; i < padded_vect<P>::size_64; i += 4) {
+        __m256i a = _mm256_load_si256((const __m256i *) &v1->words[i]);
+        __m256i b = _mm256_load_si256((const __m256i *) &v2->words[i]);
+        _mm256_store_si256((__m256i *) &o->words[i], _mm256_xor_si256(a, b));
+    }
+}
+
+
+
+/**
+ * @brief Compares two padded vectors in constant time
+ *
+ * Same result as comparing the bytes of the vectors, since their paddings are zero. <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise.
+ *
+ * @param[in] v1 Padded vector that is the first vector
+ * @param[in] v2 Padded vector that is the second vector
+ * @returns 0 if the vectors are equal and 1 otherwise
+ */
+template <class P>
+uint8_t vect_compare(const padded_vect<P> *v1, const padded_vect<P> *v2) {
+    if (cpu_supports_avx2()) {
+        return vect_compare_avx2<P>(v1, v2);
+    }
+
+    return vect_compare_portable<P>(v1, v2);
+}
+
+
+
+/**
+ * @brief Compares two padded vectors in constant time
+ *
+ * @param[in] v1 Padded vector that is the first vector
+ * @param[in] v2 Padded vector that is the second vector
+ * @returns 0 if the vectors are equal and 1 otherwise
+ */
+template <class P>
+static uint8_t vect_compare_portable(const padded_vect<P> *v1, const padded_vect<P> *v2) {
+    uint64_t r = 0;
+
+    for (size_t i = 0; i < padded_vect<P>::size_64; ++i) {
+        r |= v1->words[i] ^ v2->words[i];
+    }
+
+    return (uint8_t) ((r | (~r + 1)) >> 63);
+}
+
+
+
+/**
+ * @brief Compares two padded vectors in constant time with AVX2 aligned loads
+ *
+ * @param[in] v1 Padded vector that is the first vector
+ * @param[in] v2 Padded vector that is the second vector
+ * @returns 0 if the vectors are equal and 1 otherwise
+ */
+template <class P>
+HQC_TARGET_AVX2 static uint8_t vect_compare_avx2(const padded_vect<P> *v1, const padded_vect<P> *v2) {
+    __m256i r = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < padded_vect<P>::size_64; i += 4) {
+        __m256i a = _mm256_load_si256((const __m256i *) &v1->words[i]);
+        __m256i b = _mm256_load_si256((const __m256i *) &v2->words[i]);
+        r = _mm256_or_si256(r, _mm256_xor_si256(a, b));
+    }
+
+    return (uint8_t) (1 ^ _mm256_testz_si256(r, r));
+}
+
+
+
+/**
+ * @brief Resizes a padded vector so that it contains <b>size_o</b> bits
+ *
+ * The bits of v past its size are zero, so truncating keeps the words below bit size_o
+ * and enlarging copies v. Each word is ANDed with its mask, the padding included. <br>
+ * Dispatches to the AVX2 implementation when the CPU supports it
+ * and to the portable implementation otherwise.
+ *
+ * @param[out] o Padded output vector
+ * @param[in] size_o Integer that is the size of the output vector in bits
+ * @param[in] v Padded input vector
+ */
+template <class P>
+void vect_resize(padded_vect<P> *o, uint32_t size_o, const padded_vect<P> *v) {
+    if (cpu_supports_avx2()) {
+        vect_resize_avx2(o, size_o, v);
+        return;
+    }
+
+    vect_resize_portable(o, size_o, v);
+}
+
+
+
+/**
+ * @brief Resizes a padded vector so that it contains <b>size_o</b> bits
+ *
+ * @param[out] o Padded output vector
+ * @param[in] size_o Integer that is the size of the output vector in bits
+ * @param[in] v Padded input vector
+ */
+template <class P>
+static void vect_resize_portable(padded_vect<P> *o, uint32_t size_o, const padded_vect<P> *v) {
+    const size_t last = size_o / 64;
+
+    for (size_t i = 0; i < padded_vect<P>::size_64; ++i) {
+        uint64_t mask = -(uint64_t) (i < last) | (-(uint64_t) (i == last) & BITMASK(size_o, 64));
+        o->words[i] = v->words[i] & mask;
+    }
+}
+
+
+
+/**
+ * @brief Resizes a padded vector so that it contains <b>size_o</b> bits with AVX2 aligned loads and stores
+ *
+ * @param[out] o Padded output vector
+ * @param[in] size_o Integer that is the size of the output vector in bits
+ * @param[in] v Padded input vector
+ */
+template <class P>
+HQC_TARGET_AVX2 static void vect_resize_avx2(padded_vect<P> *o, uint32_t size_o, const padded_vect<P> *v) {
+    const __m256i last = _mm256_set1_epi64x(size_o / 64);
+    const __m256i partial = _mm256_set1_epi64x(BITMASK(size_o, 64));
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+
+    for (size_t i = 0; i < padded_vect<P>::size_64; i += 4) {
+        __m256i mask = _mm256_or_si256(_mm256_cmpgt_epi64(last, index), _mm256_and_si256(_mm256_cmpeq_epi64(last, index), partial));
+        __m256i word = _mm256_load_si256((const __m256i *) &v->words[i]);
+        _mm256_store_si256((__m256i *) &o->words[i], _mm256_and_si256(word, mask));
+        index = _mm256_add_epi64(index, step);
+    }
+}
+
+
+
 /**
  * @brief Prints a given number of bytes
  *
  * @param[in] v Pointer to an array of bytes
  * @param[in] size Integer that is number of bytes to be displayed
  */
+template <class P>
 void vect_print(const uint64_t *v, const uint32_t size) {
-    if(size == VEC_K_SIZE_BYTES) {
-        uint8_t tmp [VEC_K_SIZE_BYTES] = {0};
-        memcpy(tmp, v, VEC_K_SIZE_BYTES);
-        for (uint32_t i = 0; i < VEC_K_SIZE_BYTES; ++i) {
+    if(size == P::vec_k_size_bytes) {
+        uint8_t tmp [P::vec_k_size_bytes] = {0};
+        memcpy(tmp, v, P::vec_k_size_bytes);
+        for (uint32_t i = 0; i < P::vec_k_size_bytes; ++i) {
             printf("%02x", tmp[i]);
         }
-    } else if (size == VEC_N_SIZE_BYTES) {
-        uint8_t tmp [VEC_N_SIZE_BYTES] = {0};
-        memcpy(tmp, v, VEC_N_SIZE_BYTES);
-        for (uint32_t i = 0; i < VEC_N_SIZE_BYTES; ++i) {
+    } else if (size == P::vec_n_size_bytes) {
+        uint8_t tmp [P::vec_n_size_bytes] = {0};
+        memcpy(tmp, v, P::vec_n_size_bytes);
+        for (uint32_t i = 0; i < P::vec_n_size_bytes; ++i) {
             printf("%02x", tmp[i]);
         }
-    } else if (size == VEC_N1N2_SIZE_BYTES) {
-        uint8_t tmp [VEC_N1N2_SIZE_BYTES] = {0};
-        memcpy(tmp, v, VEC_N1N2_SIZE_BYTES);
-        for (uint32_t i = 0; i < VEC_N1N2_SIZE_BYTES; ++i) {
+    } else if (size == P::vec_n1n2_size_bytes) {
+        uint8_t tmp [P::vec_n1n2_size_bytes] = {0};
+        memcpy(tmp, v, P::vec_n1n2_size_bytes);
+        for (uint32_t i = 0; i < P::vec_n1n2_size_bytes; ++i) {
             printf("%02x", tmp[i]);
         }
-    }  else if (size == VEC_N1_SIZE_BYTES) {
-        uint8_t tmp [VEC_N1_SIZE_BYTES] = {0};
-        memcpy(tmp, v, VEC_N1_SIZE_BYTES);
-        for (uint32_t i = 0; i < VEC_N1_SIZE_BYTES; ++i) {
+    }  else if (size == P::vec_n1_size_bytes) {
+        uint8_t tmp [P::vec_n1_size_bytes] = {0};
+        memcpy(tmp, v, P::vec_n1_size_bytes);
+        for (uint32_t i = 0; i < P::vec_n1_size_bytes; ++i) {
             printf("%02x", tmp[i]);
         }
     }
@@ -232,3 +936,19 @@ void vect_print_sparse(const uint32_t *v, const uint16_t weight) {
     }
     printf("%d", v[weight - 1]);
 }
+
+
+
+#define INSTANTIATE_VECTOR(P) \
+    template void vect_set_random_fixed_weight<P>(seedexpander_state *, uint64_t *, uint16_t); \
+    template void vect_set_random_fixed_weight<P>(seedexpander_state *, uint64_t *, uint16_t, sampling_scratch<P> *); \
+    template void vect_set_random<P>(seedexpander_state *, uint64_t *); \
+    template void vect_resize<P>(uint64_t *, uint32_t, const uint64_t *, uint32_t); \
+    template void vect_clear_padding<P>(padded_vect<P> *, uint32_t); \
+    template void vect_set_random<P>(seedexpander_state *, padded_vect<P> *); \
+    template void vect_add<P>(padded_vect<P> *, const padded_vect<P> *, const padded_vect<P> *); \
+    template uint8_t vect_compare<P>(const padded_vect<P> *, const padded_vect<P> *); \
+    template void vect_resize<P>(padded_vect<P> *, uint32_t, const padded_vect<P> *); \
+    template void vect_print<P>(const uint64_t *, const uint32_t);
+
+HQC_INSTANTIATE_PARAMETER_SETS(INSTANTIATE_VECTOR)
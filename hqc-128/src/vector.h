@@ -6,18 +6,71 @@
  * @brief Header file for vector.cpp
  */
 
+#include "parameter_set.h"
+#include "parameters.h"
 #include "shake_prng.h"
+#include <stddef.h>
 #include <stdint.h>
 
-void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t weight);
-void vect_set_random(seedexpander_state *ctx, uint64_t *v);
+/**
+ * @brief Smallest power of 2 greater than or equal to n
+ */
+constexpr size_t next_power_of_2(size_t n) {
+    return (n <= 1) ? 1 : 2 * next_power_of_2((n + 1) / 2);
+}
+
+/**
+ * Scratch memory of the fixed-weight sampling of a parameter set.
+ * The support is sorted padded to sort_size keys, then merged with the vec_n_size_64 word markers
+ * padded to merge_size - sort_size keys. The compaction of the AVX2 path reads up to sort_size words past scan_size.
+ */
+template <class P>
+struct sampling_scratch {
+    static constexpr size_t sort_size = next_power_of_2(P::omega_r);
+    static constexpr size_t merge_size = next_power_of_2(sort_size + P::vec_n_size_64);
+    static constexpr size_t scan_size = CEIL_DIVIDE(P::vec_n_size_64 + P::omega_r, 4) * 4;
+    static_assert(scan_size <= merge_size, "the scan must stay within the merged keys");
+
+    alignas(32) int32_t keys[merge_size];
+    alignas(32) uint64_t words[scan_size + sort_size];
+    alignas(32) uint64_t shifts[scan_size + sort_size];
+};
+
+typedef sampling_scratch<hqc128_params> vect_sampling_scratch;
+
+// Vectors of n and n1n2 bits are stored in whole cache lines
+#define VEC_ALIGNMENT 64
+
+/**
+ * Vector of n or n1n2 bits of a parameter set aligned on a cache line and zero-padded to size_64 words.
+ * The functions taking padded_vect pointers write every word of their outputs, padding included,
+ * so their SIMD kernels use aligned loads over whole registers and need no fix-up of the tail.
+ */
+template <class P>
+struct alignas(VEC_ALIGNMENT) padded_vect {
+    static constexpr size_t size_64 = CEIL_DIVIDE(P::vec_n_size_64, VEC_ALIGNMENT / 8) * (VEC_ALIGNMENT / 8);
+
+    uint64_t words[size_64];
+};
+
+typedef padded_vect<hqc128_params> aligned_vect;
+
+template <class P> void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t weight);
+template <class P> void vect_set_random_fixed_weight(seedexpander_state *ctx, uint64_t *v, uint16_t weight, sampling_scratch<P> *scratch);
+template <class P> void vect_set_random(seedexpander_state *ctx, uint64_t *v);
 void vect_set_random_from_prng(uint64_t *v, uint32_t size_v);
 
 void vect_add(uint64_t *o, const uint64_t *v1, const uint64_t *v2, uint32_t size);
 uint8_t vect_compare(const uint8_t *v1, const uint8_t *v2, uint32_t size);
-void vect_resize(uint64_t *o, uint32_t size_o, const uint64_t *v, uint32_t size_v);
+template <class P> void vect_resize(uint64_t *o, uint32_t size_o, const uint64_t *v, uint32_t size_v);
+
+template <class P> void vect_clear_padding(padded_vect<P> *v, uint32_t size);
+template <class P> void vect_set_random(seedexpander_state *ctx, padded_vect<P> *v);
+template <class P> void vect_add(padded_vect<P> *o, const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> uint8_t vect_compare(const padded_vect<P> *v1, const padded_vect<P> *v2);
+template <class P> void vect_resize(padded_vect<P> *o, uint32_t size_o, const padded_vect<P> *v);
 
-void vect_print(const uint64_t *v, const uint32_t size);
+template <class P> void vect_print(const uint64_t *v, const uint32_t size);
 void vect_print_sparse(const uint32_t *v, const uint16_t weight);
 
 #endif
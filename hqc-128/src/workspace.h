@@ -0,0 +1,74 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+/**
+ * @file workspace.h
+ * @brief Caller-provided memory of the heap-free, small-stack KEM and PKE calls
+ *
+ * The overloads taking a hqc_workspace keep every vector of the scheme in it and multiply
+ * with the Karatsuba vect_mul instead of NTL, so they never allocate and only use a few KB
+ * of stack (the decoders and the hash states). They return the same results as the other calls.
+ * A workspace is HQC_WORKSPACE_BYTES bytes aligned on HQC_WORKSPACE_ALIGNMENT bytes,
+ * needs no initialisation and can be reused, but not by two calls at the same time.
+ * The KEM calls clear the secret members of the workspace before returning, so only
+ * public values are left in it. Zeroizing it is still up to the caller of the PKE calls.
+ */
+
+#include "gf2x.h"
+#include "parameters.h"
+#include "vector.h"
+#include <stdint.h>
+
+#define HQC_WORKSPACE_ALIGNMENT 64
+
+struct alignas(HQC_WORKSPACE_ALIGNMENT) hqc_workspace {
+    // crypto_kem_enc and crypto_kem_dec
+    aligned_vect u;
+    aligned_vect v;
+    aligned_vect u2;
+    aligned_vect v2;
+    uint64_t m[VEC_K_SIZE_64];
+    uint64_t salt[SALT_SIZE_64];
+    uint8_t sigma[VEC_K_SIZE_BYTES];
+    uint8_t theta[SHAKE256_512_BYTES];
+    uint8_t hash_input[VEC_K_SIZE_BYTES + VEC_N_SIZE_BYTES + VEC_N1N2_SIZE_BYTES]; // Input of the G and K functions
+
+    // hqc_pke_keygen, hqc_pke_encrypt and hqc_pke_decrypt
+    aligned_vect x;
+    aligned_vect y;
+    aligned_vect h;
+    aligned_vect s;
+    aligned_vect r1;
+    aligned_vect r2;
+    aligned_vect e;
+    aligned_vect tmp1;
+    aligned_vect tmp2;
+    uint8_t pk[PUBLIC_KEY_BYTES];
+
+    // Kernels
+    uint64_t mul[VECT_MUL_SCRATCH_64];
+    vect_sampling_scratch sampling;
+};
+
+#define HQC_WORKSPACE_BYTES sizeof(hqc_workspace)
+
+/**
+ * Vectors expanded from a secret key by hqc_expand_secret_key. Decapsulating with it
+ * skips the sampling of y and the expansion of the public key stored in the secret key.
+ */
+struct alignas(HQC_WORKSPACE_ALIGNMENT) hqc_expanded_sk {
+    aligned_vect y;
+    aligned_vect h;
+    aligned_vect s;
+    uint8_t sigma[VEC_K_SIZE_BYTES];
+};
+
+static_assert(VEC_K_SIZE_BYTES + PUBLIC_KEY_BYTES + SALT_SIZE_BYTES <= sizeof(((hqc_workspace *) 0)->hash_input), "hash_input is too small for the G function");
+
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk, hqc_workspace *workspace);
+int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, hqc_workspace *workspace);
+int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, hqc_workspace *workspace);
+void hqc_expand_secret_key(hqc_expanded_sk *expanded, const unsigned char *sk, hqc_workspace *workspace);
+int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, const hqc_expanded_sk *expanded, hqc_workspace *workspace);
+
+#endif